@@ -3,29 +3,145 @@
 #include <unistd.h>
 #include <sys/wait.h>
 #include <string.h>
+#include <time.h>
 #include "MT25024_Part_B_Workers.h"
+#include "MT25024_Part_B_Options.h"
+#include "MT25024_Part_B_Steal.h"
+#include "MT25024_Part_B_Strong.h"
+#include "MT25024_Part_B_Account.h"
+#include "MT25024_Part_B_Pin.h"
 
-int main(int argc, char *argv[]) {
-    // 1. Check if the user provided the worker type (cpu, mem, or io)
-    if (argc < 2) {
-        fprintf(stderr, "Usage: %s <cpu|mem|io> [num_processes]\n", argv[0]);
+static int g_failed = 0;    // a child exited non-zero (e.g. --cpus pinning failed): exit status 1
+
+// Wait for every child and note whether any of them failed
+static void wait_children(const pid_t *pids, int n) {
+    for (int i = 0; i < n; i++) {
+        int status;
+        if (waitpid(pids[i], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) g_failed = 1;
+    }
+}
+
+// After the reports: 0, or 1 with a message if a child failed
+static int exit_status(void) {
+    if (g_failed) fprintf(stderr, "Program A: a child process failed (see above)\n");
+    return g_failed;
+}
+
+// One round of the task runtime: every child runs steal_worker() on the shared deques
+static double run_round(steal_rt_t *rt, int num_processes, int steal) {
+    pid_t pids[num_processes];
+
+    steal_reset(rt, steal);
+    fflush(stdout);     // children must not inherit (and print again) buffered lines
+    account_run_begin();
+    for (int i = 0; i < num_processes; i++) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("Fork failed");
+            exit(1);
+        } else if (pid == 0) {
+            // unpinned it still runs its share (the others wait for it at the
+            // start barrier), but the exit status marks the run as failed
+            int pin = pin_worker(i);
+            account_begin(i);
+            int rc = steal_worker(rt, i);
+            account_end(i);
+            exit(rc == 0 && pin == 0 ? 0 : 1);
+        }
+        pids[i] = pid;
+    }
+    wait_children(pids, num_processes);
+    return steal_report(rt, "Program A");
+}
+
+static int run_sched(const run_opts_t *o) {
+    steal_rt_t *rt = steal_create(o->workers, o->kind, o->loops);
+    if (!rt) {
+        fprintf(stderr, "Program A: cannot set up the task runtime\n");
         return 1;
     }
 
-    char *worker_type = argv[1];
-    int num_processes = 2; // Default to 2 child processes as per Part A
+    printf("Starting Program A: %d child processes, %zu '%s' tasks each, task runtime...\n",
+           o->workers, o->loops, o->work);
 
-    // Allow changing number of processes for Part D (Scaling)
-    if (argc > 2) {
-        num_processes = atoi(argv[2]);
+    if (o->sched == SCHED_COMPARE) {
+        double t_static = run_round(rt, o->workers, 0);
+        double t_steal = run_round(rt, o->workers, 1);
+        printf("Program A: makespan static=%.3f s steal=%.3f s (static/steal = %.2f)\n",
+               t_static, t_steal, t_steal > 0 ? t_static / t_steal : 0.0);
+    } else {
+        run_round(rt, o->workers, o->sched == SCHED_STEAL);
     }
 
+    steal_destroy(rt);
+    mem_pattern_report("Program A");
+    membuf_report("Program A");
+    io_engine_report("Program A");
+    group_commit_report("Program A");
+    read_work_report("Program A");
+    account_report("Program A", "program_a", o->work);
+    printf("Program A: All children finished.\n");
+    return exit_status();
+}
+
+// Strong scaling: n children each run their share of the one workload
+static double strong_run(int n) {
+    pid_t pids[n];
+    struct timespec t0, t1;
+
+    fflush(stdout);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 0; i < n; i++) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("Fork failed");
+            exit(1);
+        } else if (pid == 0) {
+            int pin = pin_worker(i);
+            exit(strong_worker(i, n) == 0 && pin == 0 ? 0 : 1);
+        }
+        pids[i] = pid;
+    }
+    wait_children(pids, n);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    return (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9;
+}
+
+int main(int argc, char *argv[]) {
+    run_opts_t opts;
+
+    // 1. Check if the user provided the worker type (cpu, mem, or io)
+    // Default to 2 child processes as per Part A; the count can change for Part D (Scaling)
+    if (run_opts_parse(argc, argv, 2, &opts) != 0) {
+        run_opts_usage(argv[0], "num_processes");
+        return 1;
+    }
+    if (opts.membuf.shared) {
+        fprintf(stderr, "--mem-shared is for Program B (threads share one mapping)\n");
+        return 1;
+    }
+    if (opts.sched != SCHED_NONE) {
+        return run_sched(&opts);
+    }
+    if (opts.strong) {
+        if (strong_setup(opts.kind, opts.loops) != 0) return 1;
+        strong_sweep("Program A", opts.workers, strong_run);
+        strong_cleanup();
+        return exit_status();
+    }
+
+    const char *worker_type = opts.work;
+    int num_processes = opts.workers;
+
     // Store child PIDs
     pid_t pids[num_processes];
 
     printf("Starting Program A: Creating %d child processes for '%s' task...\n",
            num_processes, worker_type);
 
+    fflush(stdout);     // children must not inherit (and print again) buffered lines
+    account_run_begin();
+
     // 2. Create exactly num_processes children
     for (int i = 0; i < num_processes; i++) {
         pid_t pid = fork();
@@ -35,19 +151,22 @@ int main(int argc, char *argv[]) {
             exit(1);
         } else if (pid == 0) {
             // --- CHILD PROCESS ---
+            int pin = pin_worker(i);
+            account_begin(i);
             if (strcmp(worker_type, "cpu") == 0) {
-                cpu(LOOP_COUNT);
+                cpu(opts.loops);
             } else if (strcmp(worker_type, "mem") == 0) {
-                mem(LOOP_COUNT);
+                mem(opts.loops);
             } else if (strcmp(worker_type, "io") == 0) {
-                io(LOOP_COUNT);
+                io(opts.loops);
             } else {
                 fprintf(stderr, "Unknown worker type: %s\n", worker_type);
                 exit(1);
             }
+            account_end(i);
 
             // Child must exit to avoid re-forking
-            exit(0);
+            exit(pin == 0 ? 0 : 1);
         } else {
             // --- PARENT PROCESS ---
             pids[i] = pid;  // store child PID
@@ -55,10 +174,14 @@ int main(int argc, char *argv[]) {
     }
 
     // 3. Parent waits for each specific child
-    for (int i = 0; i < num_processes; i++) {
-        waitpid(pids[i], NULL, 0);
-    }
+    wait_children(pids, num_processes);
 
+    mem_pattern_report("Program A");
+    membuf_report("Program A");
+    io_engine_report("Program A");
+    group_commit_report("Program A");
+    read_work_report("Program A");
+    account_report("Program A", "program_a", worker_type);
     printf("Program A: All children finished.\n");
-    return 0;
+    return exit_status();
 }
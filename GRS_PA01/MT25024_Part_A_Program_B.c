@@ -2,46 +2,192 @@
 #include <stdlib.h>
 #include <pthread.h> 
 #include <string.h>
+#include <time.h>
 #include "MT25024_Part_B_Workers.h"
+#include "MT25024_Part_B_Options.h"
+#include "MT25024_Part_B_Steal.h"
+#include "MT25024_Part_B_Strong.h"
+#include "MT25024_Part_B_Account.h"
+#include "MT25024_Part_B_Pin.h"
+
+static size_t g_loops = LOOP_COUNT;    // iterations per thread (--loops)
+static int g_pin_failed = 0;           // a thread could not be pinned (--cpus): exit status 1
+
+// Pin the calling thread for worker id. Unpinned it still runs its share (the task
+// runtime's start barrier waits for every thread), but the run exits with status 1.
+static void pin_thread(int id) {
+    if (pin_worker(id) != 0) __atomic_store_n(&g_pin_failed, 1, __ATOMIC_RELAXED);
+}
+
+// After the reports: 0, or 1 with a message if a thread could not be pinned
+static int exit_status(void) {
+    if (g_pin_failed) fprintf(stderr, "Program B: a worker thread could not be pinned (see above)\n");
+    return g_pin_failed;
+}
+
+typedef struct {
+    const char *work;
+    int id;             // --cpus placement and --csv accounting slot
+} thread_arg_t;
 
 // Thread wrapper function
 void *thread_wrapper(void *arg) {
-    char *worker_type = (char *)arg;
+    thread_arg_t *a = (thread_arg_t *)arg;
+    const char *worker_type = a->work;
 
+    pin_thread(a->id);
+    account_begin(a->id);
     if (strcmp(worker_type, "cpu") == 0) {
-        cpu(LOOP_COUNT);
+        cpu(g_loops);
     } else if (strcmp(worker_type, "mem") == 0) {
-        mem(LOOP_COUNT);
+        mem(g_loops);
     } else if (strcmp(worker_type, "io") == 0) {
-        io(LOOP_COUNT);
+        io(g_loops);
     } else {
         // Handle invalid input safely (important for demo/viva)
         fprintf(stderr, "Unknown worker type: %s\n", worker_type);
         pthread_exit(NULL);
     }
+    account_end(a->id);
 
     pthread_exit(NULL);
 }
 
-int main(int argc, char *argv[]) {
-    if (argc < 2) {
-        fprintf(stderr, "Usage: %s <cpu|mem|io> [num_threads]\n", argv[0]);
+// Task runtime: thread i is worker i of the shared deques
+typedef struct {
+    steal_rt_t *rt;
+    int id;
+} steal_arg_t;
+
+static void *steal_wrapper(void *arg) {
+    steal_arg_t *a = (steal_arg_t *)arg;
+    pin_thread(a->id);
+    account_begin(a->id);
+    steal_worker(a->rt, a->id);
+    account_end(a->id);
+    return NULL;
+}
+
+static double run_round(steal_rt_t *rt, int num_threads, int steal) {
+    pthread_t threads[num_threads];
+    steal_arg_t args[num_threads];
+
+    steal_reset(rt, steal);
+    membuf_shared_rewind();
+    account_run_begin();
+    for (int i = 0; i < num_threads; i++) {
+        args[i].rt = rt;
+        args[i].id = i;
+        if (pthread_create(&threads[i], NULL, steal_wrapper, &args[i]) != 0) {
+            perror("Thread creation failed");
+            exit(1);
+        }
+    }
+    for (int i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    return steal_report(rt, "Program B");
+}
+
+static int run_sched(const run_opts_t *o) {
+    steal_rt_t *rt = steal_create(o->workers, o->kind, o->loops);
+    if (!rt) {
+        fprintf(stderr, "Program B: cannot set up the task runtime\n");
         return 1;
     }
 
-    char *worker_type = argv[1];
-    int num_threads = 2; // Default to 2 threads 
+    printf("Starting Program B: %d threads, %zu '%s' tasks each, task runtime...\n",
+           o->workers, o->loops, o->work);
 
-    if (argc > 2) {
-        num_threads = atoi(argv[2]);
+    if (o->sched == SCHED_COMPARE) {
+        double t_static = run_round(rt, o->workers, 0);
+        double t_steal = run_round(rt, o->workers, 1);
+        printf("Program B: makespan static=%.3f s steal=%.3f s (static/steal = %.2f)\n",
+               t_static, t_steal, t_steal > 0 ? t_static / t_steal : 0.0);
+    } else {
+        run_round(rt, o->workers, o->sched == SCHED_STEAL);
     }
 
+    steal_destroy(rt);
+    mem_pattern_report("Program B");
+    membuf_report("Program B");
+    io_engine_report("Program B");
+    group_commit_report("Program B");
+    read_work_report("Program B");
+    account_report("Program B", "program_b", o->work);
+    printf("Program B: All threads finished.\n");
+    return exit_status();
+}
+
+// Strong scaling: n threads each run their share of the one workload
+static void *strong_wrapper(void *arg) {
+    int *ids = (int *)arg;     // { i, n }
+    pin_thread(ids[0]);
+    strong_worker(ids[0], ids[1]);
+    return NULL;
+}
+
+static double strong_run(int n) {
+    pthread_t threads[n];
+    int ids[n][2];
+    struct timespec t0, t1;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 0; i < n; i++) {
+        ids[i][0] = i;
+        ids[i][1] = n;
+        if (pthread_create(&threads[i], NULL, strong_wrapper, ids[i]) != 0) {
+            perror("Thread creation failed");
+            exit(1);
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    return (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9;
+}
+
+int main(int argc, char *argv[]) {
+    run_opts_t opts;
+
+    // Default to 2 threads
+    if (run_opts_parse(argc, argv, 2, &opts) != 0) {
+        run_opts_usage(argv[0], "num_threads");
+        return 1;
+    }
+    if (opts.strong) {         // its own shared buffer; run_opts_parse() rejects --mem-shared
+        if (strong_setup(opts.kind, opts.loops) != 0) return 1;
+        strong_sweep("Program B", opts.workers, strong_run);
+        strong_cleanup();
+        return exit_status();
+    }
+    if (opts.membuf.shared) {
+        // one slice per thread, sized for the buffer mem() will ask for
+        const mem_pattern_cfg_t *pat = mem_pattern_get();
+        size_t slice = pat ? (pat->wss + 63) & ~(size_t)63 : MEM_SIZE;
+        if (membuf_shared_setup(opts.workers, slice) != 0) return 1;
+    }
+    if (opts.sched != SCHED_NONE) {
+        int rc = run_sched(&opts);
+        membuf_shared_free();
+        return rc;
+    }
+
+    char *worker_type = (char *)opts.work;
+    int num_threads = opts.workers;
+    g_loops = opts.loops;
+
     printf("Starting Program B: Creating %d threads for '%s' task...\n", num_threads, worker_type);
 
     pthread_t threads[num_threads]; 
+    thread_arg_t args[num_threads];
 
+    account_run_begin();
     for (int i = 0; i < num_threads; i++) {
-        int result = pthread_create(&threads[i], NULL, thread_wrapper, (void *)worker_type);
+        args[i].work = worker_type;
+        args[i].id = i;
+        int result = pthread_create(&threads[i], NULL, thread_wrapper, &args[i]);
         if (result != 0) {
             perror("Thread creation failed");
             exit(1);
@@ -52,6 +198,13 @@ int main(int argc, char *argv[]) {
         pthread_join(threads[i], NULL);
     }
 
+    membuf_shared_free();
+    mem_pattern_report("Program B");
+    membuf_report("Program B");
+    io_engine_report("Program B");
+    group_commit_report("Program B");
+    read_work_report("Program B");
+    account_report("Program B", "program_b", worker_type);
     printf("Program B: All threads finished.\n");
-    return 0;
+    return exit_status();
 }
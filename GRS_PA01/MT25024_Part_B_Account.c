@@ -0,0 +1,168 @@
+#define _GNU_SOURCE     // RUSAGE_THREAD
+#include "MT25024_Part_B_Account.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+
+typedef struct {
+    uint64_t run_start;
+    int workers;
+    acct_worker_t w[];
+} acct_shared_t;
+
+static acct_shared_t *g_acct = NULL;
+static const char *g_csv = NULL;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+int account_set(const char *csv, int workers) {
+    g_csv = csv;
+    if (!csv || g_acct) return 0;
+
+    size_t len = sizeof(acct_shared_t) + (size_t)workers * sizeof(acct_worker_t);
+    void *p = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+        perror("mmap failed in account_set()");
+        return -1;
+    }
+    g_acct = (acct_shared_t *)p;
+    g_acct->workers = workers;
+    return 0;
+}
+
+int account_active(void) {
+    return g_acct != NULL;
+}
+
+void account_run_begin(void) {
+    if (g_acct) g_acct->run_start = now_ns();
+}
+
+// Counters of the calling thread; 0 where /proc/thread-self/io is not readable
+static void sample(acct_worker_t *s) {
+    struct rusage ru;
+    memset(s, 0, sizeof(*s));
+    if (getrusage(RUSAGE_THREAD, &ru) == 0) {
+        s->utime_us = (uint64_t)ru.ru_utime.tv_sec * 1000000ULL + (uint64_t)ru.ru_utime.tv_usec;
+        s->stime_us = (uint64_t)ru.ru_stime.tv_sec * 1000000ULL + (uint64_t)ru.ru_stime.tv_usec;
+        s->maxrss_kb = (uint64_t)ru.ru_maxrss;
+        s->minflt = (uint64_t)ru.ru_minflt;
+        s->majflt = (uint64_t)ru.ru_majflt;
+        s->nvcsw = (uint64_t)ru.ru_nvcsw;
+        s->nivcsw = (uint64_t)ru.ru_nivcsw;
+    }
+
+    FILE *fp = fopen("/proc/thread-self/io", "r");
+    if (!fp) return;
+    char key[32];
+    unsigned long long v;
+    while (fscanf(fp, "%31[^:]: %llu\n", key, &v) == 2) {
+        if (strcmp(key, "read_bytes") == 0) s->read_bytes = v;
+        else if (strcmp(key, "write_bytes") == 0) s->write_bytes = v;
+    }
+    fclose(fp);
+}
+
+void account_begin(int id) {
+    if (!g_acct || id < 0 || id >= g_acct->workers) return;
+    acct_worker_t *w = &g_acct->w[id];
+    sample(w);                  // baseline, replaced by the deltas in account_end()
+    w->pid = (int)getpid();
+    w->t_start = now_ns();
+}
+
+void account_end(int id) {
+    if (!g_acct || id < 0 || id >= g_acct->workers) return;
+    uint64_t t = now_ns();
+    acct_worker_t *w = &g_acct->w[id], e;
+    sample(&e);
+    w->utime_us = e.utime_us - w->utime_us;
+    w->stime_us = e.stime_us - w->stime_us;
+    w->maxrss_kb = e.maxrss_kb;
+    w->minflt = e.minflt - w->minflt;
+    w->majflt = e.majflt - w->majflt;
+    w->nvcsw = e.nvcsw - w->nvcsw;
+    w->nivcsw = e.nivcsw - w->nivcsw;
+    w->read_bytes = e.read_bytes - w->read_bytes;
+    w->write_bytes = e.write_bytes - w->write_bytes;
+    w->t_end = t;
+    w->done = 1;
+}
+
+int account_report(const char *prog, const char *csv_prog, const char *work) {
+    if (!g_acct) return 0;
+    double wall = (double)(now_ns() - g_acct->run_start) / 1e9;
+
+    acct_worker_t sum;
+    memset(&sum, 0, sizeof(sum));
+    int n = 0, slowest = -1, self = (int)getpid();
+    double w_min = 0, w_max = 0, w_sum = 0;
+    uint64_t end_min = 0, end_max = 0;
+    for (int i = 0; i < g_acct->workers; i++) {
+        const acct_worker_t *w = &g_acct->w[i];
+        if (!w->done) continue;
+        double secs = (double)(w->t_end - w->t_start) / 1e9;
+        if (n == 0 || secs < w_min) w_min = secs;
+        if (n == 0 || secs > w_max) w_max = secs;
+        if (n == 0 || w->t_end < end_min) end_min = w->t_end;
+        if (n == 0 || w->t_end > end_max) {
+            end_max = w->t_end;
+            slowest = i;
+        }
+        w_sum += secs;
+        n++;
+
+        sum.utime_us += w->utime_us;
+        sum.stime_us += w->stime_us;
+        if (w->pid != self) sum.maxrss_kb += w->maxrss_kb;
+        else if (w->maxrss_kb > sum.maxrss_kb) sum.maxrss_kb = w->maxrss_kb;
+        sum.minflt += w->minflt;
+        sum.majflt += w->majflt;
+        sum.nvcsw += w->nvcsw;
+        sum.nivcsw += w->nivcsw;
+        sum.read_bytes += w->read_bytes;
+        sum.write_bytes += w->write_bytes;
+    }
+    if (n == 0) {
+        fprintf(stderr, "%s: no worker accounting recorded\n", prog);
+        return -1;
+    }
+
+    double user = (double)sum.utime_us / 1e6, sys = (double)sum.stime_us / 1e6;
+    double cpu_pct = wall > 0 ? (user + sys) / wall * 100.0 : 0.0;
+    double w_mean = w_sum / n, spread = (double)(end_max - end_min) / 1e9;
+
+    printf("%s accounting: wall=%.3f s CPU%%=%.1f user=%.3f s sys=%.3f s peakRSS=%llu KB read=%llu KB write=%llu KB\n",
+           prog, wall, cpu_pct, user, sys, (unsigned long long)sum.maxrss_kb,
+           (unsigned long long)(sum.read_bytes / 1024), (unsigned long long)(sum.write_bytes / 1024));
+    printf("  workers=%d wall min/mean/max=%.3f/%.3f/%.3f s done spread=%.3f s (last: worker %d)\n",
+           n, w_min, w_mean, w_max, spread, slowest);
+    printf("  faults minor=%llu major=%llu ctx switches voluntary=%llu involuntary=%llu\n",
+           (unsigned long long)sum.minflt, (unsigned long long)sum.majflt,
+           (unsigned long long)sum.nvcsw, (unsigned long long)sum.nivcsw);
+
+    FILE *fp = fopen(g_csv, "a");
+    if (!fp) {
+        perror("fopen failed for --csv");
+        return -1;
+    }
+    fseek(fp, 0, SEEK_END);
+    if (ftell(fp) == 0) {
+        fprintf(fp, "Program,Workload,Count,CPU%%,PeakRSS(KB),Read(KB),Write(KB),Time_real(s),User(s),Sys(s),"
+                    "MinFlt,MajFlt,VolCS,InvolCS,Worker_min(s),Worker_mean(s),Worker_max(s),Done_spread(s)\n");
+    }
+    fprintf(fp, "%s,%s,%d,%.1f,%llu,%llu,%llu,%.3f,%.3f,%.3f,%llu,%llu,%llu,%llu,%.3f,%.3f,%.3f,%.3f\n",
+            csv_prog, work, n, cpu_pct, (unsigned long long)sum.maxrss_kb,
+            (unsigned long long)(sum.read_bytes / 1024), (unsigned long long)(sum.write_bytes / 1024),
+            wall, user, sys, (unsigned long long)sum.minflt, (unsigned long long)sum.majflt,
+            (unsigned long long)sum.nvcsw, (unsigned long long)sum.nivcsw, w_min, w_mean, w_max, spread);
+    fclose(fp);
+    return 0;
+}
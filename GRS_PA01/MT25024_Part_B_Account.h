@@ -0,0 +1,39 @@
+#ifndef ACCOUNT_H
+#define ACCOUNT_H
+
+#include <stdint.h>
+
+// In-process resource accounting (--csv=FILE), instead of sampling top/iostat from
+// outside. Every worker (child process or thread) measures itself from its first to
+// its last iteration: wall time, getrusage(RUSAGE_THREAD) and /proc/thread-self/io.
+// The records live in a MAP_SHARED array set up before fork, one slot per worker, so
+// Program A's children report through it as well. After join the parent prints a
+// summary and appends one CSV row (header first if the file is new or empty).
+//
+// Peak RSS: for a thread ru_maxrss is the whole process, so workers that ran in the
+// parent's process (Program B) count once; children (Program A) are summed.
+typedef struct {
+    uint64_t t_start, t_end;            // CLOCK_MONOTONIC ns
+    uint64_t utime_us, stime_us;
+    uint64_t maxrss_kb, minflt, majflt, nvcsw, nivcsw;
+    uint64_t read_bytes, write_bytes;   // storage I/O (page cache hits read 0)
+    int pid;
+    int done;
+} acct_worker_t;
+
+// Shared slots for workers 0..workers-1; call before forking. 0, or -1 with a message.
+int account_set(const char *csv, int workers);
+int account_active(void);
+
+// Parent: right before the first worker is started
+void account_run_begin(void);
+
+// Worker id: around its share of the work
+void account_begin(int id);
+void account_end(int id);
+
+// Parent, after join: summary lines under prog ("Program A") plus the CSV row with
+// csv_prog ("program_a", as in the Part C/D CSVs). 0, or -1 if the CSV cannot be written.
+int account_report(const char *prog, const char *csv_prog, const char *work);
+
+#endif
@@ -0,0 +1,73 @@
+// cpu_bench: checks the cpu() kernels against the libm reference and times them.
+//
+// Usage: ./cpu_bench [seconds_per_isa]
+// For every ISA the CPU supports: largest |term - libm term| over the 1000 terms of
+// one cpu() iteration (must be <= SIMD_TOL), error of the iteration's sum, then
+// cpu() iterations per second, ns per sin*cos term and speedup over scalar.
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include "MT25024_Part_B_Simd.h"
+
+#define TERMS 1000      // one cpu() iteration
+
+static volatile double g_sink;
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[]) {
+    double secs = 1.0;
+    if (argc > 1) {
+        secs = atof(argv[1]);
+        if (secs <= 0) {
+            fprintf(stderr, "Usage: %s [seconds_per_isa]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    double ref[TERMS], got[TERMS];
+    double ref_sum = isa_kernel(ISA_SCALAR)(TERMS, ref);
+    double scalar_rate = 0;
+    int failed = 0;
+
+    printf("cpu_bench: %d terms per iteration, tolerance %.0e, best ISA %s\n",
+           TERMS, SIMD_TOL, isa_name(isa_best()));
+    printf("%-7s %12s %12s %14s %10s %8s\n", "isa", "max_err", "sum_err", "iterations/s", "ns/term", "speedup");
+
+    for (int isa = 0; isa < ISA_COUNT; isa++) {
+        sincos_kernel_t k = isa_kernel(isa);
+        if (!k) {
+            printf("%-7s not supported by this CPU\n", isa_name(isa));
+            continue;
+        }
+
+        double sum = k(TERMS, got), max_err = 0;
+        for (int j = 0; j < TERMS; j++) {
+            double e = fabs(got[j] - ref[j]);
+            if (e > max_err) max_err = e;
+        }
+        int ok = max_err <= SIMD_TOL;
+        if (!ok) failed = 1;
+
+        // Batches of 64 iterations between clock reads
+        long iters = 0;
+        double t0 = now_s(), t;
+        do {
+            for (int i = 0; i < 64; i++) g_sink = k(TERMS, NULL);
+            iters += 64;
+            t = now_s() - t0;
+        } while (t < secs);
+
+        double rate = (double)iters / t;
+        if (isa == ISA_SCALAR) scalar_rate = rate;
+        printf("%-7s %12.3e %12.3e %14.0f %10.2f %7.2fx%s\n", isa_name(isa), max_err, fabs(sum - ref_sum),
+               rate, 1e9 / (rate * TERMS), scalar_rate > 0 ? rate / scalar_rate : 0.0,
+               ok ? "" : "  FAILED tolerance");
+    }
+    return failed;
+}
@@ -0,0 +1,307 @@
+#define _GNU_SOURCE     // sync_file_range
+#include "MT25024_Part_B_GroupCommit.h"
+#include "MT25024_Part_B_IoEngine.h"
+#include "MT25024_Part_B_Workers.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+static const char *g_mode_name[GC_COUNT] = { "off", "fsync", "group", "range" };
+
+static commit_cfg_t g_cfg;
+
+// Coordinator and totals in a MAP_SHARED block; the mutex and condvar are
+// PTHREAD_PROCESS_SHARED so forked children take part in the same batches.
+// Everything that is not _Atomic is guarded by mu.
+typedef struct {
+    pthread_mutex_t mu;
+    pthread_cond_t cv;
+    int fd;
+    unsigned active;            // workers that joined and have not closed yet
+    uint64_t req_seq;           // commit requests so far (their writes have completed)
+    uint64_t durable_seq;       // every request <= durable_seq is durable
+    uint64_t failed_seq;        // highest request covered by a failed flush (0: none)
+    int flushing;               // a leader owns the next flush
+    uint64_t lo, hi;            // dirty range not yet covered by a flush (hi == 0: none)
+    uint64_t flushes, flush_ns, batch_max;
+    uint64_t batch[GC_BATCH_BUCKETS];
+    _Atomic uint64_t next_slot;
+    _Atomic uint64_t workers, writes, bytes, commits, errors;
+    _Atomic uint64_t t_first, t_last;
+    hist_shared_t dur;
+} gc_shared_t;
+
+static gc_shared_t *g_gc = NULL;
+
+const char *group_commit_name(int m) {
+    return (m >= 0 && m < GC_COUNT) ? g_mode_name[m] : "?";
+}
+
+int group_commit_parse(const char *s) {
+    for (int i = GC_FSYNC; i < GC_COUNT; i++) {
+        if (strcmp(s, g_mode_name[i]) == 0) return i;
+    }
+    return -1;
+}
+
+int group_commit_active(void) {
+    return g_gc != NULL && g_cfg.mode != GC_OFF;
+}
+
+static int log_create(void) {
+    char name[64];
+    snprintf(name, sizeof(name), "io_log_%ld.bin", (long)getpid());
+    int fd = open(name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        perror("open failed in group_commit_set()");
+        return -1;
+    }
+    unlink(name);           // the fd keeps it; nothing is left behind
+
+    // Write the whole log once, like a WAL segment, so later flushes carry data only
+    char *zero = (char *)calloc(1, IO_BUF_SIZE);
+    if (!zero) {
+        perror("calloc failed in group_commit_set()");
+        close(fd);
+        return -1;
+    }
+    for (int i = 0; i < GC_LOG_SLOTS; i++) {
+        if (pwrite(fd, zero, IO_BUF_SIZE, (off_t)i * IO_BUF_SIZE) != (ssize_t)IO_BUF_SIZE) {
+            perror("pwrite failed in group_commit_set()");
+            free(zero);
+            close(fd);
+            return -1;
+        }
+    }
+    free(zero);
+    fsync(fd);
+    return fd;
+}
+
+int group_commit_set(const commit_cfg_t *cfg) {
+    g_cfg = *cfg;
+    if (g_cfg.mode == GC_OFF || g_gc) return 0;
+
+    void *p = mmap(NULL, sizeof(gc_shared_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+        perror("mmap failed in group_commit_set()");
+        return -1;
+    }
+    gc_shared_t *gc = (gc_shared_t *)p;
+
+    pthread_mutexattr_t ma;
+    pthread_mutexattr_init(&ma);
+    pthread_mutexattr_setpshared(&ma, PTHREAD_PROCESS_SHARED);
+    pthread_mutex_init(&gc->mu, &ma);
+    pthread_mutexattr_destroy(&ma);
+
+    pthread_condattr_t ca;
+    pthread_condattr_init(&ca);
+    pthread_condattr_setpshared(&ca, PTHREAD_PROCESS_SHARED);
+    pthread_condattr_setclock(&ca, CLOCK_MONOTONIC);
+    pthread_cond_init(&gc->cv, &ca);
+    pthread_condattr_destroy(&ca);
+
+    gc->fd = log_create();
+    if (gc->fd < 0) {
+        munmap(p, sizeof(gc_shared_t));
+        return -1;
+    }
+    g_gc = gc;
+    return 0;
+}
+
+static void stamp_first(_Atomic uint64_t *dst, uint64_t v) {
+    uint64_t cur = atomic_load(dst);
+    while (v && (cur == 0 || v < cur) && !atomic_compare_exchange_weak(dst, &cur, v)) {
+    }
+}
+
+static void stamp_last(_Atomic uint64_t *dst, uint64_t v) {
+    uint64_t cur = atomic_load(dst);
+    while (v > cur && !atomic_compare_exchange_weak(dst, &cur, v)) {
+    }
+}
+
+// mu held
+static void note_flush(uint64_t batch, uint64_t ns) {
+    unsigned b = 63u - (unsigned)__builtin_clzll(batch);
+    if (b >= GC_BATCH_BUCKETS) b = GC_BATCH_BUCKETS - 1;
+    g_gc->batch[b]++;
+    g_gc->flushes++;
+    g_gc->flush_ns += ns;
+    if (batch > g_gc->batch_max) g_gc->batch_max = batch;
+}
+
+static int flush_log(uint64_t lo, uint64_t hi) {
+    if (g_cfg.mode == GC_RANGE) {
+        if (hi <= lo) return 0;
+        return sync_file_range(g_gc->fd, (off_t)lo, (off_t)(hi - lo),
+                               SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+    }
+    return fdatasync(g_gc->fd);
+}
+
+static void flush_failed(void) {
+    if (atomic_fetch_add(&g_gc->errors, 1) == 0) {
+        perror(g_cfg.mode == GC_RANGE ? "sync_file_range failed in io()" : "fdatasync failed in io()");
+    }
+}
+
+// Return once every write this worker made so far is durable
+static int commit(gc_worker_t *w) {
+    uint64_t t0 = io_now_ns();
+    int rc = 0;
+
+    if (g_cfg.mode == GC_FSYNC) {
+        rc = fdatasync(g_gc->fd);
+        uint64_t t1 = io_now_ns();
+        if (rc != 0) flush_failed();
+        pthread_mutex_lock(&g_gc->mu);
+        note_flush(1, t1 - t0);
+        pthread_mutex_unlock(&g_gc->mu);
+    } else {
+        pthread_mutex_lock(&g_gc->mu);
+        uint64_t my = ++g_gc->req_seq;
+        if (g_gc->hi == 0 || w->lo < g_gc->lo) g_gc->lo = w->lo;
+        if (w->hi > g_gc->hi) g_gc->hi = w->hi;
+        if (g_gc->flushing) pthread_cond_broadcast(&g_gc->cv);     // a leader may be collecting
+
+        while (g_gc->durable_seq < my) {
+            if (g_gc->flushing) {
+                pthread_cond_wait(&g_gc->cv, &g_gc->mu);
+                continue;
+            }
+            // Leader: collect the batch, flush it without the lock, publish
+            g_gc->flushing = 1;
+            if (g_cfg.window_us) {
+                uint64_t deadline = io_now_ns() + (uint64_t)g_cfg.window_us * 1000ULL;
+                struct timespec ts = { (time_t)(deadline / 1000000000ULL), (long)(deadline % 1000000000ULL) };
+                while (g_gc->req_seq - g_gc->durable_seq < g_gc->active) {
+                    if (pthread_cond_timedwait(&g_gc->cv, &g_gc->mu, &ts) == ETIMEDOUT) break;
+                }
+            }
+            uint64_t target = g_gc->req_seq, lo = g_gc->lo, hi = g_gc->hi;
+            g_gc->lo = g_gc->hi = 0;
+            pthread_mutex_unlock(&g_gc->mu);
+
+            uint64_t f0 = io_now_ns();
+            int r = flush_log(lo, hi);
+            uint64_t f1 = io_now_ns();
+            if (r != 0) {
+                flush_failed();
+                rc = -1;
+            }
+
+            pthread_mutex_lock(&g_gc->mu);
+            note_flush(target - g_gc->durable_seq, f1 - f0);
+            if (r != 0) g_gc->failed_seq = target;
+            g_gc->durable_seq = target;
+            g_gc->flushing = 0;
+            pthread_cond_broadcast(&g_gc->cv);
+        }
+        // Followers share the leader's result: a request a failed flush covered is not
+        // durable. A failure published before this follower woke also counts, since a
+        // failed fdatasync may have dropped any of the file's dirty pages.
+        if (my <= g_gc->failed_seq) rc = -1;
+        pthread_mutex_unlock(&g_gc->mu);
+    }
+
+    hist_add(&w->dur, io_now_ns() - t0);
+    w->commits++;
+    w->lo = w->hi = 0;
+    return rc;
+}
+
+int group_commit_iter(gc_worker_t *w, size_t iter) {
+    if (!w->joined) {
+        w->buf = (char *)malloc(IO_BUF_SIZE);
+        if (!w->buf) {
+            perror("malloc failed in io()");
+            return -1;
+        }
+        memset(w->buf, 'A', IO_BUF_SIZE);
+        pthread_mutex_lock(&g_gc->mu);
+        g_gc->active++;
+        pthread_mutex_unlock(&g_gc->mu);
+        w->joined = 1;
+    }
+
+    uint64_t off = (atomic_fetch_add(&g_gc->next_slot, 1) % GC_LOG_SLOTS) * IO_BUF_SIZE;
+    uint64_t t0 = io_now_ns();
+    if (pwrite(g_gc->fd, w->buf, IO_BUF_SIZE, (off_t)off) != (ssize_t)IO_BUF_SIZE) {
+        perror("pwrite failed in io()");
+        atomic_fetch_add(&g_gc->errors, 1);
+        return -1;
+    }
+    if (!w->t_first) w->t_first = t0;
+    w->writes++;
+    w->bytes += IO_BUF_SIZE;
+    if (w->hi == 0 || off < w->lo) w->lo = off;
+    if (off + IO_BUF_SIZE > w->hi) w->hi = off + IO_BUF_SIZE;
+
+    int rc = 0;
+    if ((iter % FSYNC_EVERY) == 0) rc = commit(w);
+    w->t_last = io_now_ns();
+    return rc;
+}
+
+void group_commit_close(gc_worker_t *w) {
+    if (!w->joined) return;
+
+    // One worker fewer to wait for when a leader collects its batch
+    pthread_mutex_lock(&g_gc->mu);
+    g_gc->active--;
+    pthread_cond_broadcast(&g_gc->cv);
+    pthread_mutex_unlock(&g_gc->mu);
+
+    atomic_fetch_add(&g_gc->workers, 1);
+    atomic_fetch_add(&g_gc->writes, w->writes);
+    atomic_fetch_add(&g_gc->bytes, w->bytes);
+    atomic_fetch_add(&g_gc->commits, w->commits);
+    stamp_first(&g_gc->t_first, w->t_first);
+    stamp_last(&g_gc->t_last, w->t_last);
+    hist_merge(&g_gc->dur, &w->dur);
+
+    free(w->buf);
+    memset(w, 0, sizeof(*w));
+}
+
+void group_commit_report(const char *prog) {
+    if (!group_commit_active()) return;
+    uint64_t workers = atomic_load(&g_gc->workers), writes = atomic_load(&g_gc->writes);
+    uint64_t t_span = atomic_load(&g_gc->t_last) - atomic_load(&g_gc->t_first);
+    if (!workers || !writes || !t_span) return;
+
+    // All workers have been joined, so the lock only keeps the reads tidy
+    pthread_mutex_lock(&g_gc->mu);
+    double secs = (double)t_span / 1e9;
+    uint64_t commits = atomic_load(&g_gc->commits), flushes = g_gc->flushes;
+    char lat[128];
+    hist_format(&g_gc->dur, lat, sizeof(lat));
+
+    printf("%s io commit=%s", prog, g_mode_name[g_cfg.mode]);
+    if (g_cfg.mode != GC_FSYNC) printf(" window=%uus", g_cfg.window_us);
+    printf(": workers=%llu writes=%llu MB/s=%.1f commits=%llu commits/s=%.1f\n", (unsigned long long)workers,
+           (unsigned long long)writes, (double)atomic_load(&g_gc->bytes) / 1e6 / secs,
+           (unsigned long long)commits, (double)commits / secs);
+    printf("  flushes=%llu avg batch=%.2f max=%llu avg flush=%.1f us  batches:", (unsigned long long)flushes,
+           flushes ? (double)commits / (double)flushes : 0.0, (unsigned long long)g_gc->batch_max,
+           flushes ? (double)g_gc->flush_ns / 1e3 / (double)flushes : 0.0);
+    for (unsigned b = 0; b < GC_BATCH_BUCKETS; b++) {
+        if (!g_gc->batch[b]) continue;
+        uint64_t lo = 1ULL << b, hi = (2ULL << b) - 1;
+        if (b == GC_BATCH_BUCKETS - 1) printf(" %llu+:%llu", (unsigned long long)lo, (unsigned long long)g_gc->batch[b]);
+        else if (lo == hi) printf(" %llu:%llu", (unsigned long long)lo, (unsigned long long)g_gc->batch[b]);
+        else printf(" %llu-%llu:%llu", (unsigned long long)lo, (unsigned long long)hi, (unsigned long long)g_gc->batch[b]);
+    }
+    printf("\n  durability latency: %s%s\n", lat, atomic_load(&g_gc->errors) ? "  (some flushes failed)" : "");
+    pthread_mutex_unlock(&g_gc->mu);
+}
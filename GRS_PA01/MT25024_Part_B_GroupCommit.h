@@ -0,0 +1,65 @@
+#ifndef GROUPCOMMIT_H
+#define GROUPCOMMIT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "MT25024_Part_B_Hist.h"
+
+// Durability service for io() (--commit). All workers append their 256 KB blocks to
+// one shared log file and, every 10th iteration, ask for their writes to be made
+// durable:
+//
+//   fsync    every worker calls fdatasync on the log itself (the uncoordinated baseline)
+//   group    group commit: the first waiter becomes the leader, waits up to --window
+//            microseconds (or until every active worker has a request in), then one
+//            fdatasync covers the whole batch; requests that arrive during the flush
+//            form the next batch
+//   range    as group, but the leader flushes only the dirty byte range with
+//            sync_file_range (data pages only: no metadata, no device cache flush)
+//
+// The log is GC_LOG_SLOTS * 256 KB, written with zeros and synced once up front so the
+// flushes carry data only, and unlinked right away (the fd keeps it alive). It and the
+// coordinator state are set up before fork, so Program A's children share them.
+#define GC_LOG_SLOTS     64
+#define GC_BATCH_BUCKETS 13     // batch sizes 1, 2-3, 4-7, ... 4096+
+
+typedef enum {
+    GC_OFF = 0,
+    GC_FSYNC,
+    GC_GROUP,
+    GC_RANGE,
+    GC_COUNT
+} gc_mode_t;
+
+typedef struct {
+    gc_mode_t mode;
+    unsigned window_us;     // group/range: how long a leader waits for more requests
+} commit_cfg_t;
+
+// Per-worker state (lives in worker_ctx_t)
+typedef struct {
+    int joined;
+    char *buf;
+    uint64_t lo, hi;        // bytes written since the last commit request
+    uint64_t writes, bytes, commits;
+    uint64_t t_first, t_last;
+    hist_t dur;             // request -> durable
+} gc_worker_t;
+
+const char *group_commit_name(int m);
+int group_commit_parse(const char *s);      // -1 if unknown
+
+// Create the shared log and coordinator; call before forking. 0, or -1 with a message.
+int group_commit_set(const commit_cfg_t *cfg);
+int group_commit_active(void);
+
+// One io() iteration: append a 256 KB block, and on every 10th wait until it is durable
+int group_commit_iter(gc_worker_t *w, size_t iter);
+
+// Leave the coordinator and add the counters to the shared totals
+void group_commit_close(gc_worker_t *w);
+
+// Throughput, commit batch sizes and durability latency over all workers
+void group_commit_report(const char *prog);
+
+#endif
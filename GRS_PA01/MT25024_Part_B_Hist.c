@@ -0,0 +1,56 @@
+#include "MT25024_Part_B_Hist.h"
+#include <stdio.h>
+
+static unsigned bucket_of(uint64_t v) {
+    if (v < 16) return (unsigned)v;
+    unsigned e = 63u - (unsigned)__builtin_clzll(v);        // 4 .. 63
+    unsigned sub = (unsigned)(v >> (e - 3)) & 7u;
+    return 16u + (e - 4u) * 8u + sub;
+}
+
+// Middle of the bucket's range
+static uint64_t bucket_value(unsigned b) {
+    if (b < 16) return b;
+    unsigned e = (b - 16u) / 8u + 4u, sub = (b - 16u) % 8u;
+    uint64_t lo = (8ULL + sub) << (e - 3);
+    return lo + (1ULL << (e - 3)) / 2;
+}
+
+void hist_add(hist_t *h, uint64_t ns) {
+    h->n[bucket_of(ns)]++;
+    h->count++;
+    if (ns > h->max) h->max = ns;
+}
+
+void hist_merge(hist_shared_t *dst, const hist_t *src) {
+    if (!src->count) return;
+    for (unsigned b = 0; b < HIST_BUCKETS; b++) {
+        if (src->n[b]) atomic_fetch_add(&dst->n[b], src->n[b]);
+    }
+    atomic_fetch_add(&dst->count, src->count);
+    uint64_t cur = atomic_load(&dst->max);
+    while (src->max > cur && !atomic_compare_exchange_weak(&dst->max, &cur, src->max)) {
+    }
+}
+
+uint64_t hist_pct(const hist_shared_t *h, double p) {
+    uint64_t count = atomic_load(&h->count);
+    if (!count) return 0;
+    uint64_t rank = (uint64_t)((p / 100.0) * (double)count);
+    if (rank >= count) rank = count - 1;
+    uint64_t seen = 0;
+    for (unsigned b = 0; b < HIST_BUCKETS; b++) {
+        seen += atomic_load(&h->n[b]);
+        if (seen > rank) {
+            uint64_t v = bucket_value(b), max = atomic_load(&h->max);
+            return v < max ? v : max;
+        }
+    }
+    return atomic_load(&h->max);
+}
+
+void hist_format(const hist_shared_t *h, char *buf, size_t len) {
+    snprintf(buf, len, "p50=%.1f p90=%.1f p99=%.1f p99.9=%.1f max=%.1f us",
+             (double)hist_pct(h, 50) / 1e3, (double)hist_pct(h, 90) / 1e3, (double)hist_pct(h, 99) / 1e3,
+             (double)hist_pct(h, 99.9) / 1e3, (double)atomic_load(&h->max) / 1e3);
+}
@@ -0,0 +1,32 @@
+#ifndef HIST_H
+#define HIST_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Latency histogram in ns: exact below 16 ns, then 8 buckets per power of two
+// (<= 12.5% error). Workers fill a private hist_t and merge it once at the end into
+// a hist_shared_t that lives in a MAP_SHARED block, so forked children count too.
+#define HIST_BUCKETS 512
+
+typedef struct {
+    uint64_t n[HIST_BUCKETS];
+    uint64_t count, max;
+} hist_t;
+
+typedef struct {
+    _Atomic uint64_t n[HIST_BUCKETS];
+    _Atomic uint64_t count, max;
+} hist_shared_t;
+
+void hist_add(hist_t *h, uint64_t ns);
+void hist_merge(hist_shared_t *dst, const hist_t *src);
+
+// Value (ns) at percentile p (0..100)
+uint64_t hist_pct(const hist_shared_t *h, double p);
+
+// "p50=.. p90=.. p99=.. p99.9=.. max=.. us"
+void hist_format(const hist_shared_t *h, char *buf, size_t len);
+
+#endif
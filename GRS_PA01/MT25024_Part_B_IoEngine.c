@@ -0,0 +1,303 @@
+#define _GNU_SOURCE     // O_DIRECT, fallocate
+#include "MT25024_Part_B_IoEngine.h"
+#include "MT25024_Part_B_Workers.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define IO_ALIGN    4096
+#define FSYNC_TAG   (~0ULL)     // user_data of the IORING_OP_FSYNC
+
+static const char *g_engine_name[IOE_COUNT] = { "stdio", "pwrite", "direct", "uring" };
+
+static io_engine_cfg_t g_cfg;
+static int g_active = 0;
+
+// Process-shared totals
+typedef struct {
+    _Atomic uint64_t workers, writes, bytes, fsyncs, fsync_ns, errors;
+    _Atomic uint64_t t_first, t_last;
+    hist_shared_t lat;
+} io_totals_t;
+
+static io_totals_t *g_tot = NULL;
+
+uint64_t io_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+const char *io_engine_name(int e) {
+    return (e >= 0 && e < IOE_COUNT) ? g_engine_name[e] : "?";
+}
+
+int io_engine_parse(const char *s) {
+    for (int i = 0; i < IOE_COUNT; i++) {
+        if (strcmp(s, g_engine_name[i]) == 0) return i;
+    }
+    return -1;
+}
+
+int io_engine_set(const io_engine_cfg_t *cfg) {
+    if (cfg->qd < 1 || cfg->qd > IO_MAX_QD) {
+        fprintf(stderr, "--qd must be 1..%d\n", IO_MAX_QD);
+        return -1;
+    }
+    g_cfg = *cfg;
+    g_active = 1;
+    if (g_tot) return 0;
+
+    void *p = mmap(NULL, sizeof(io_totals_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+        perror("mmap failed in io_engine_set()");
+        return -1;
+    }
+    g_tot = (io_totals_t *)p;
+    return 0;
+}
+
+int io_engine_active(void) {
+    return g_active;
+}
+
+io_engine_t io_engine_kind(void) {
+    return g_active ? g_cfg.engine : IOE_STDIO;
+}
+
+static void span(io_engine_state_t *s, uint64_t t0, uint64_t t1) {
+    if (!s->t_first) s->t_first = t0;
+    s->t_last = t1;
+}
+
+static int engine_open(io_engine_state_t *s, const char *name) {
+    int direct = g_cfg.engine == IOE_DIRECT || g_cfg.engine == IOE_URING;
+    unsigned nbuf = g_cfg.engine == IOE_URING ? g_cfg.qd : 1;
+
+    s->fd = open(name, O_WRONLY | O_CREAT | O_TRUNC | (direct ? O_DIRECT : 0), 0644);
+    if (s->fd < 0) {
+        perror(direct ? "open(O_DIRECT) failed in io()" : "open failed in io()");
+        return -1;
+    }
+    s->open = 1;            // from here on io_engine_close() cleans up
+    // preallocate the slots so the writes do not extend the file
+    int rc = fallocate(s->fd, 0, 0, (off_t)IO_SLOTS * IO_BUF_SIZE);
+    if (rc != 0) rc = posix_fallocate(s->fd, 0, (off_t)IO_SLOTS * IO_BUF_SIZE);
+    if (rc != 0) perror("fallocate failed in io() (continuing without)");
+
+    s->buf_len = (size_t)nbuf * IO_BUF_SIZE;
+    if (posix_memalign((void **)&s->buf, IO_ALIGN, s->buf_len) != 0) {
+        fprintf(stderr, "posix_memalign failed in io()\n");
+        s->buf = NULL;
+        return -1;
+    }
+    memset(s->buf, 'A', s->buf_len);
+
+    if (g_cfg.engine == IOE_URING) {
+        // room for qd writes and an fsync behind each of them
+        unsigned entries = 2;
+        while (entries < 2 * g_cfg.qd) entries <<= 1;
+        int err = uring_init(&s->ring, entries);
+        if (err < 0) {
+            fprintf(stderr, "io_uring_setup failed in io(): %s\n", strerror(-err));
+            return -1;
+        }
+        struct iovec iov[IO_MAX_QD];
+        for (unsigned i = 0; i < nbuf; i++) {
+            iov[i].iov_base = s->buf + (size_t)i * IO_BUF_SIZE;
+            iov[i].iov_len = IO_BUF_SIZE;
+            s->free_slot[i] = nbuf - 1 - i;
+        }
+        s->nfree = nbuf;
+        err = uring_register_buffers(&s->ring, iov, nbuf);
+        if (err < 0) {
+            fprintf(stderr, "IORING_REGISTER_BUFFERS failed in io(): %s\n", strerror(-err));
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// ---- io_uring -------------------------------------------------------------
+static void uring_reap(io_engine_state_t *s) {
+    struct io_uring_cqe *cqe;
+    while ((cqe = uring_peek_cqe(&s->ring)) != NULL) {
+        uint64_t now = io_now_ns();
+        if (cqe->user_data == FSYNC_TAG) {
+            if (cqe->res < 0 && !s->err) fprintf(stderr, "io_uring fsync: %s\n", strerror(-cqe->res));
+            if (cqe->res < 0) s->err = 1;
+            s->fsyncs++;
+            s->fsync_ns += now - s->fsync_submit_ns[s->fsync_head++ % IO_MAX_QD];
+            s->fsync_pending--;
+        } else {
+            unsigned slot = (unsigned)cqe->user_data;
+            if (cqe->res != (int)IO_BUF_SIZE) {
+                if (!s->err) {
+                    fprintf(stderr, "io_uring write: %s\n", cqe->res < 0 ? strerror(-cqe->res) : "short write");
+                }
+                s->err = 1;
+            } else {
+                // only completed writes are latency samples, as in sync_write()
+                s->writes++;
+                s->bytes += IO_BUF_SIZE;
+                hist_add(&s->lat, now - s->submit_ns[slot]);
+                span(s, s->submit_ns[slot], now);
+            }
+            s->free_slot[s->nfree++] = slot;
+            s->inflight--;
+        }
+        uring_cqe_seen(&s->ring);
+    }
+}
+
+static int uring_write(io_engine_state_t *s, size_t iter) {
+    // queue depth reached (or the fsync FIFO full): wait for a completion
+    while (s->nfree == 0 || s->fsync_pending == IO_MAX_QD) {
+        if (uring_submit(&s->ring, 1) < 0) return -1;
+        uring_reap(s);
+    }
+    unsigned slot = s->free_slot[--s->nfree];
+
+    struct io_uring_sqe *sqe = uring_get_sqe(&s->ring);
+    if (!sqe) {
+        s->free_slot[s->nfree++] = slot;
+        return -1;
+    }
+    sqe->opcode = IORING_OP_WRITE_FIXED;
+    sqe->fd = s->fd;
+    sqe->addr = (uint64_t)(uintptr_t)(s->buf + (size_t)slot * IO_BUF_SIZE);
+    sqe->len = IO_BUF_SIZE;
+    sqe->off = (uint64_t)(iter % IO_SLOTS) * IO_BUF_SIZE;
+    sqe->buf_index = (uint16_t)slot;
+    sqe->user_data = slot;
+    s->submit_ns[slot] = io_now_ns();
+    s->inflight++;
+
+    // fsync after this write, ordered behind everything queued before it
+    if ((iter % FSYNC_EVERY) == 0) {
+        struct io_uring_sqe *fs;
+        while ((fs = uring_get_sqe(&s->ring)) == NULL) {
+            if (uring_submit(&s->ring, 1) < 0) return -1;
+            uring_reap(s);
+        }
+        fs->opcode = IORING_OP_FSYNC;
+        fs->fd = s->fd;
+        fs->flags = IOSQE_IO_DRAIN;
+        fs->user_data = FSYNC_TAG;
+        s->fsync_submit_ns[(s->fsync_head + s->fsync_pending) % IO_MAX_QD] = io_now_ns();
+        s->fsync_pending++;
+    }
+
+    if (uring_submit(&s->ring, 0) < 0) return -1;
+    uring_reap(s);
+    return s->err ? -1 : 0;
+}
+
+// ---- pwrite / O_DIRECT --------------------------------------------------
+static int sync_write(io_engine_state_t *s, size_t iter) {
+    uint64_t t0 = io_now_ns();
+    ssize_t n = pwrite(s->fd, s->buf, IO_BUF_SIZE, (off_t)(iter % IO_SLOTS) * IO_BUF_SIZE);
+    uint64_t t1 = io_now_ns();
+    if (n != (ssize_t)IO_BUF_SIZE) {
+        perror("pwrite failed in io()");
+        s->err = 1;
+        return -1;
+    }
+    s->writes++;
+    s->bytes += IO_BUF_SIZE;
+    hist_add(&s->lat, t1 - t0);
+    span(s, t0, t1);
+
+    if ((iter % FSYNC_EVERY) == 0) {
+        if (fsync(s->fd) != 0) {
+            perror("fsync failed in io()");
+            s->err = 1;
+            return -1;
+        }
+        uint64_t t2 = io_now_ns();
+        s->fsyncs++;
+        s->fsync_ns += t2 - t1;
+        span(s, t0, t2);
+    }
+    return 0;
+}
+
+int io_engine_write(io_engine_state_t *s, const char *name, size_t iter) {
+    if (s->err) return -1;      // a failed setup or write: this worker is done
+    if (!s->buf && engine_open(s, name) != 0) {
+        s->err = 1;
+        return -1;
+    }
+    return g_cfg.engine == IOE_URING ? uring_write(s, iter) : sync_write(s, iter);
+}
+
+void io_engine_note(io_engine_state_t *s, uint64_t t0, uint64_t t1, int fsynced, uint64_t fsync_ns) {
+    s->open = 1;
+    s->fd = -1;
+    s->writes++;
+    s->bytes += IO_BUF_SIZE;
+    hist_add(&s->lat, t1 - t0 - fsync_ns);
+    if (fsynced) {
+        s->fsyncs++;
+        s->fsync_ns += fsync_ns;
+    }
+    span(s, t0, t1);
+}
+
+void io_engine_close(io_engine_state_t *s) {
+    if (!s->open) return;
+
+    if (s->ring.sq_ptr) {
+        while (s->inflight || s->fsync_pending) {
+            if (uring_submit(&s->ring, 1) < 0) break;
+            uring_reap(s);
+        }
+        uring_exit(&s->ring);
+    }
+    if (g_tot) {
+        atomic_fetch_add(&g_tot->workers, 1);
+        atomic_fetch_add(&g_tot->writes, s->writes);
+        atomic_fetch_add(&g_tot->bytes, s->bytes);
+        atomic_fetch_add(&g_tot->fsyncs, s->fsyncs);
+        atomic_fetch_add(&g_tot->fsync_ns, s->fsync_ns);
+        if (s->err) atomic_fetch_add(&g_tot->errors, 1);
+        uint64_t cur = atomic_load(&g_tot->t_first);
+        while (s->t_first && (cur == 0 || s->t_first < cur) &&
+               !atomic_compare_exchange_weak(&g_tot->t_first, &cur, s->t_first)) {
+        }
+        cur = atomic_load(&g_tot->t_last);
+        while (s->t_last > cur && !atomic_compare_exchange_weak(&g_tot->t_last, &cur, s->t_last)) {
+        }
+        hist_merge(&g_tot->lat, &s->lat);
+    }
+    if (s->fd >= 0) close(s->fd);
+    free(s->buf);
+    memset(s, 0, sizeof(*s));
+}
+
+void io_engine_report(const char *prog) {
+    if (!g_active || !g_tot) return;
+    uint64_t workers = atomic_load(&g_tot->workers), writes = atomic_load(&g_tot->writes);
+    uint64_t t_span = atomic_load(&g_tot->t_last) - atomic_load(&g_tot->t_first);
+    if (!workers || !writes || !t_span) return;
+
+    double secs = (double)t_span / 1e9;
+    uint64_t fsyncs = atomic_load(&g_tot->fsyncs);
+    char lat[128];
+    hist_format(&g_tot->lat, lat, sizeof(lat));
+
+    printf("%s io engine=%s", prog, g_engine_name[g_cfg.engine]);
+    if (g_cfg.engine == IOE_URING) printf(" qd=%u", g_cfg.qd);
+    printf(": workers=%llu writes=%llu MB/s=%.1f IOPS=%.0f\n", (unsigned long long)workers,
+           (unsigned long long)writes, (double)atomic_load(&g_tot->bytes) / 1e6 / secs, (double)writes / secs);
+    printf("  write latency: %s\n", lat);
+    printf("  fsyncs=%llu avg=%.1f us%s\n", (unsigned long long)fsyncs,
+           fsyncs ? (double)atomic_load(&g_tot->fsync_ns) / 1e3 / (double)fsyncs : 0.0,
+           atomic_load(&g_tot->errors) ? "  (some workers had errors)" : "");
+}
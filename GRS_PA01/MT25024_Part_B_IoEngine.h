@@ -0,0 +1,79 @@
+#ifndef IOENGINE_H
+#define IOENGINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "MT25024_Part_B_Hist.h"
+#include "MT25024_Part_B_Uring.h"
+
+// I/O engines for the io() worker (--io-engine). Same workload for every engine:
+// one 256 KB write per iteration, fsync after every 10th (iterations 0, 10, 20, ...).
+//
+//   stdio    the original io(): fopen("wb") + fwrite + fclose each iteration
+//   pwrite   file opened once and preallocated with fallocate; buffered pwrite
+//            into IO_SLOTS rotating 256 KB slots
+//   direct   as pwrite, with O_DIRECT and a 4 KB aligned buffer
+//   uring    O_DIRECT writes through io_uring (raw syscalls), --qd writes in
+//            flight, each from its own registered buffer (WRITE_FIXED); the
+//            fsync is an IORING_OP_FSYNC with IOSQE_IO_DRAIN
+//
+// Per-write latency is the write alone (for uring: submit to completion; for
+// stdio: fopen to fclose); fsyncs are counted and timed separately.
+#define IO_SLOTS   16       // file = IO_SLOTS * 256 KB
+#define IO_MAX_QD  64
+
+typedef enum {
+    IOE_STDIO = 0,
+    IOE_PWRITE,
+    IOE_DIRECT,
+    IOE_URING,
+    IOE_COUNT
+} io_engine_t;
+
+typedef struct {
+    io_engine_t engine;
+    unsigned qd;            // uring queue depth
+} io_engine_cfg_t;
+
+// Per-worker engine state (lives in worker_ctx_t)
+typedef struct {
+    int open;
+    int fd;
+    char *buf;              // pwrite/direct: one buffer; uring: qd buffers
+    size_t buf_len;
+    uring_t ring;
+    unsigned inflight;
+    unsigned free_slot[IO_MAX_QD], nfree;
+    uint64_t submit_ns[IO_MAX_QD];
+    uint64_t fsync_submit_ns[IO_MAX_QD];  // FIFO: drained fsyncs complete in order
+    unsigned fsync_head, fsync_pending;
+    uint64_t writes, bytes, fsyncs, fsync_ns;
+    uint64_t t_first, t_last;
+    hist_t lat;
+    int err;
+} io_engine_state_t;
+
+const char *io_engine_name(int e);
+int io_engine_parse(const char *s);         // -1 if unknown
+
+// Select the engine for every later io() call; sets up the process-shared
+// totals, so call it before forking. 0, or -1 with a message.
+int io_engine_set(const io_engine_cfg_t *cfg);
+int io_engine_active(void);                 // --io-engine given (even stdio)
+io_engine_t io_engine_kind(void);
+
+// One 256 KB write (plus the fsync every 10th) into name; opens on first use. 0 or -1.
+int io_engine_write(io_engine_state_t *s, const char *name, size_t iter);
+
+// stdio engine: record one timed iteration done by io_iter()
+void io_engine_note(io_engine_state_t *s, uint64_t t0, uint64_t t1, int fsynced, uint64_t fsync_ns);
+
+// Wait for what is in flight, add the counters to the shared totals, close
+void io_engine_close(io_engine_state_t *s);
+
+// MB/s, IOPS, latency percentiles over all workers
+void io_engine_report(const char *prog);
+
+uint64_t io_now_ns(void);
+
+#endif
@@ -0,0 +1,284 @@
+#define _GNU_SOURCE     // RUSAGE_THREAD, MAP_HUGETLB, MADV_HUGEPAGE
+#include "MT25024_Part_B_MemBuf.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#define HUGE_2M (2UL * 1024UL * 1024UL)
+
+static const char *g_pages_name[] = { "malloc", "4k", "thp", "huge" };
+
+static membuf_cfg_t g_cfg;
+static int g_active = 0;
+
+// --mem-shared region
+static char *g_shared = NULL;
+static size_t g_shared_len = 0, g_slice_len = 0;
+static int g_slices = 0;
+static _Atomic int g_next_slice = 0;
+
+// Process-shared totals (MAP_SHARED so Program A's children add to them too)
+typedef struct {
+    _Atomic uint64_t workers, perf_workers;
+    _Atomic uint64_t touch_ns, touch_ns_max, touch_faults, touch_dtlb;
+    _Atomic uint64_t sweep_ns, sweep_faults, sweep_dtlb;
+    _Atomic uint64_t huge_kb_max;
+} membuf_totals_t;
+
+static membuf_totals_t *g_tot = NULL;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t thread_faults(void) {
+    struct rusage ru;
+    if (getrusage(RUSAGE_THREAD, &ru) != 0) return 0;
+    return (uint64_t)ru.ru_minflt + (uint64_t)ru.ru_majflt;
+}
+
+// dTLB load misses of the calling thread (user space only, so perf_event_paranoid 2 allows it)
+static int dtlb_open(void) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static uint64_t dtlb_read(const membuf_stats_t *st) {
+    uint64_t v = 0;
+    if (st->perf_fd < 0 || read(st->perf_fd, &v, sizeof(v)) != (ssize_t)sizeof(v)) return 0;
+    return v;
+}
+
+// AnonHugePages + hugetlb pages of the process, in kB
+static uint64_t huge_kb(void) {
+    FILE *f = fopen("/proc/self/smaps_rollup", "r");
+    if (!f) return 0;
+    char line[128];
+    uint64_t kb = 0;
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, "AnonHugePages:", 14) == 0 || strncmp(line, "Private_Hugetlb:", 16) == 0 ||
+            strncmp(line, "Shared_Hugetlb:", 15) == 0) {
+            kb += strtoull(strchr(line, ':') + 1, NULL, 10);
+        }
+    }
+    fclose(f);
+    return kb;
+}
+
+static void atomic_max(_Atomic uint64_t *a, uint64_t v) {
+    uint64_t cur = atomic_load(a);
+    while (v > cur && !atomic_compare_exchange_weak(a, &cur, v)) {
+    }
+}
+
+int membuf_set(const membuf_cfg_t *cfg) {
+    g_cfg = *cfg;
+    g_active = cfg->pages != PAGES_MALLOC || cfg->populate || cfg->shared;
+    if (!g_active || g_tot) return 0;
+
+    void *p = mmap(NULL, sizeof(membuf_totals_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+        perror("mmap failed in membuf_set()");
+        return -1;
+    }
+    g_tot = (membuf_totals_t *)p;
+    return 0;
+}
+
+int membuf_active(void) {
+    return g_active;
+}
+
+// Fault the range in now (pages that must get their huge-page advice first, or
+// shared slices that each thread populates itself)
+static void populate_range(char *p, size_t len) {
+#ifdef MADV_POPULATE_WRITE
+    if (madvise(p, len, MADV_POPULATE_WRITE) != 0) perror("madvise(MADV_POPULATE_WRITE)");
+#else
+    (void)p;
+    (void)len;      // kernel headers older than 5.14: the memset faults them
+#endif
+}
+
+// mmap with the configured page mode; len is already rounded as the mode needs
+static char *map_pages(size_t len, int populate) {
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | (populate ? MAP_POPULATE : 0);
+
+    if (g_cfg.pages == PAGES_HUGE) {
+        void *p = mmap(NULL, len, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0);
+        if (p == MAP_FAILED) {
+            perror("mmap(MAP_HUGETLB) failed (reserve pages: sysctl vm.nr_hugepages=N)");
+            return NULL;
+        }
+        return (char *)p;
+    }
+
+    if (g_cfg.pages == PAGES_THP) {
+        // over-map by 2 MB and trim, so the buffer starts on a huge page boundary
+        char *raw = (char *)mmap(NULL, len + HUGE_2M, PROT_READ | PROT_WRITE,
+                                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            perror("mmap failed in mem()");
+            return NULL;
+        }
+        char *p = (char *)(((uintptr_t)raw + HUGE_2M - 1) & ~(uintptr_t)(HUGE_2M - 1));
+        if (p > raw) munmap(raw, (size_t)(p - raw));
+        if (p + len < raw + len + HUGE_2M) munmap(p + len, (size_t)(raw + len + HUGE_2M - (p + len)));
+        if (madvise(p, len, MADV_HUGEPAGE) != 0) perror("madvise(MADV_HUGEPAGE)");
+        // MAP_POPULATE would fault before the madvise; populate by hand instead
+        if (populate) populate_range(p, len);
+        return p;
+    }
+
+    void *p = mmap(NULL, len, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (p == MAP_FAILED) {
+        perror("mmap failed in mem()");
+        return NULL;
+    }
+    madvise(p, len, MADV_NOHUGEPAGE);
+    return (char *)p;
+}
+
+static size_t map_len(size_t len) {
+    if (g_cfg.pages == PAGES_HUGE || g_cfg.pages == PAGES_THP) return (len + HUGE_2M - 1) & ~(HUGE_2M - 1);
+    return (len + 4095) & ~(size_t)4095;
+}
+
+int membuf_shared_setup(int slices, size_t slice_len) {
+    if (!g_cfg.shared) return 0;
+    g_slice_len = (slice_len + HUGE_2M - 1) & ~(HUGE_2M - 1);   // no huge page straddles two threads
+    g_shared_len = g_slice_len * (size_t)slices;
+    // not populated here even with --populate: the slices are faulted by their threads
+    g_shared = map_pages(g_shared_len, 0);
+    if (!g_shared) return -1;
+    g_slices = slices;
+    atomic_store(&g_next_slice, 0);
+    return 0;
+}
+
+void membuf_shared_rewind(void) {
+    if (!g_shared) return;
+    // drop the pages too, so the next round's threads first-touch their slices again
+    if (madvise(g_shared, g_shared_len, MADV_DONTNEED) != 0) perror("madvise(MADV_DONTNEED)");
+    atomic_store(&g_next_slice, 0);
+}
+
+void membuf_shared_free(void) {
+    if (g_shared) munmap(g_shared, g_shared_len);
+    g_shared = NULL;
+    g_slices = 0;
+}
+
+char *membuf_alloc(membuf_stats_t *st, size_t len) {
+    if (!st->used) {
+        st->perf_fd = g_active ? dtlb_open() : -1;
+        st->used = 1;
+    }
+    uint64_t t0 = now_ns(), f0 = thread_faults(), d0 = dtlb_read(st);
+    char *p = NULL;
+
+    if (!g_active) {
+        p = (char *)malloc(len);
+        if (!p) perror("malloc failed in mem()");
+    } else if (g_shared && len <= g_slice_len) {
+        int i = atomic_fetch_add(&g_next_slice, 1);
+        if (i < g_slices) {
+            p = g_shared + (size_t)i * g_slice_len;
+            if (g_cfg.populate) populate_range(p, len);
+        }
+    }
+    if (g_active && !p) p = map_pages(map_len(len), g_cfg.populate);
+    if (!p) return NULL;
+
+    // First-touch to ensure pages are mapped
+    memset(p, 1, len);
+
+    st->touch_ns += now_ns() - t0;
+    st->touch_faults += thread_faults() - f0;
+    st->touch_dtlb += dtlb_read(st) - d0;
+    if (g_active) st->thp_kb = huge_kb();
+    return p;
+}
+
+void membuf_free(char *p, size_t len) {
+    if (!p) return;
+    if (!g_active) {
+        free(p);
+    } else if (g_shared && p >= g_shared && p < g_shared + g_shared_len) {
+        return;     // freed with the region
+    } else {
+        munmap(p, map_len(len));
+    }
+}
+
+void membuf_sweep_begin(membuf_stats_t *st) {
+    if (!g_active) return;
+    st->s_ns = now_ns();
+    st->s_faults = thread_faults();
+    st->s_dtlb = dtlb_read(st);
+}
+
+void membuf_sweep_end(membuf_stats_t *st) {
+    if (!g_active) return;
+    st->sweep_ns += now_ns() - st->s_ns;
+    st->sweep_faults += thread_faults() - st->s_faults;
+    st->sweep_dtlb += dtlb_read(st) - st->s_dtlb;
+}
+
+void membuf_stats_flush(membuf_stats_t *st) {
+    if (!st->used) return;
+    if (g_active && g_tot) {
+        atomic_fetch_add(&g_tot->workers, 1);
+        if (st->perf_fd >= 0) atomic_fetch_add(&g_tot->perf_workers, 1);
+        atomic_fetch_add(&g_tot->touch_ns, st->touch_ns);
+        atomic_max(&g_tot->touch_ns_max, st->touch_ns);
+        atomic_fetch_add(&g_tot->touch_faults, st->touch_faults);
+        atomic_fetch_add(&g_tot->touch_dtlb, st->touch_dtlb);
+        atomic_fetch_add(&g_tot->sweep_ns, st->sweep_ns);
+        atomic_fetch_add(&g_tot->sweep_faults, st->sweep_faults);
+        atomic_fetch_add(&g_tot->sweep_dtlb, st->sweep_dtlb);
+        atomic_max(&g_tot->huge_kb_max, st->thp_kb);
+    }
+    if (st->perf_fd >= 0) close(st->perf_fd);
+    memset(st, 0, sizeof(*st));
+}
+
+void membuf_report(const char *prog) {
+    if (!g_active || !g_tot) return;
+    uint64_t workers = atomic_load(&g_tot->workers);
+    if (!workers) return;
+    int perf = atomic_load(&g_tot->perf_workers) == workers;
+    char td[32] = "n/a", sd[32] = "n/a";
+    if (perf) {
+        snprintf(td, sizeof(td), "%llu", (unsigned long long)atomic_load(&g_tot->touch_dtlb));
+        snprintf(sd, sizeof(sd), "%llu", (unsigned long long)atomic_load(&g_tot->sweep_dtlb));
+    }
+
+    // with any option set the buffers are mmap'ed, so the default backing is 4k pages, not malloc
+    page_mode_t backing = g_cfg.pages == PAGES_MALLOC ? PAGES_4K : g_cfg.pages;
+    printf("%s mem buffers pages=%s populate=%s shared=%s: workers=%llu\n", prog, g_pages_name[backing],
+           g_cfg.populate ? "yes" : "no", g_cfg.shared ? "yes" : "no", (unsigned long long)workers);
+    printf("  first touch: %.3f s (slowest worker %.3f s) faults=%llu dTLB_misses=%s\n",
+           (double)atomic_load(&g_tot->touch_ns) / 1e9, (double)atomic_load(&g_tot->touch_ns_max) / 1e9,
+           (unsigned long long)atomic_load(&g_tot->touch_faults), td);
+    printf("  sweep:       %.3f s faults=%llu dTLB_misses=%s\n",
+           (double)atomic_load(&g_tot->sweep_ns) / 1e9, (unsigned long long)atomic_load(&g_tot->sweep_faults), sd);
+    printf("  huge pages after first touch: %llu kB (largest seen by a worker)\n",
+           (unsigned long long)atomic_load(&g_tot->huge_kb_max));
+}
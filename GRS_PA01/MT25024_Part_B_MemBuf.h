@@ -0,0 +1,66 @@
+#ifndef MEMBUF_H
+#define MEMBUF_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// How the mem() buffers are mapped (--pages, --populate, --mem-shared).
+// Without any of these options mem() keeps its malloc + memset.
+//
+//   --pages=4k     private anonymous mmap, MADV_NOHUGEPAGE
+//   --pages=thp    mmap aligned to 2 MB + MADV_HUGEPAGE (THP is usually "madvise")
+//   --pages=huge   MAP_HUGETLB from the hugetlbfs pool (vm.nr_hugepages)
+//   --populate     MAP_POPULATE: the kernel faults the pages in inside mmap()
+//   --mem-shared   Program B: one mapping for all threads, thread i takes slice i
+//                  (2 MB aligned) and first-touches it itself, in parallel
+//
+// The first touch (mmap + memset) and the sweeps are measured separately: time,
+// page faults (getrusage RUSAGE_THREAD) and dTLB load misses (perf_event_open,
+// "n/a" where perf is not available), plus AnonHugePages after the first touch.
+typedef enum {
+    PAGES_MALLOC = 0,       // default: malloc
+    PAGES_4K,
+    PAGES_THP,
+    PAGES_HUGE
+} page_mode_t;
+
+typedef struct {
+    page_mode_t pages;
+    int populate;
+    int shared;
+} membuf_cfg_t;
+
+// Per-worker counters (first touch vs sweep)
+typedef struct {
+    int perf_fd;                    // dTLB misses of this thread, -1 if unavailable
+    uint64_t touch_ns, touch_faults, touch_dtlb;
+    uint64_t sweep_ns, sweep_faults, sweep_dtlb;
+    uint64_t thp_kb;
+    uint64_t s_ns, s_faults, s_dtlb;    // sweep_begin snapshot
+    int used;
+} membuf_stats_t;
+
+// Select the mapping for every later mem() buffer. 0, or -1 with a message.
+int membuf_set(const membuf_cfg_t *cfg);
+int membuf_active(void);            // any option given: stats are reported
+
+// --mem-shared: map slices * slice_len once (no touch); call before the threads
+int membuf_shared_setup(int slices, size_t slice_len);
+// Start a new round (--sched=compare): hand out the slices from 0 again, untouched
+void membuf_shared_rewind(void);
+void membuf_shared_free(void);
+
+// Map (or take the next shared slice) and first-touch len bytes with 1s. NULL on error.
+char *membuf_alloc(membuf_stats_t *st, size_t len);
+void membuf_free(char *p, size_t len);
+
+// Around the sweeps
+void membuf_sweep_begin(membuf_stats_t *st);
+void membuf_sweep_end(membuf_stats_t *st);
+
+// Add the worker's counters to the process-shared totals
+void membuf_stats_flush(membuf_stats_t *st);
+
+void membuf_report(const char *prog);
+
+#endif
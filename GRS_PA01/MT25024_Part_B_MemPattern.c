@@ -0,0 +1,263 @@
+#include "MT25024_Part_B_MemPattern.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/mman.h>
+
+static const char *g_pattern_name[PAT_COUNT] = { "xor", "seqread", "seqwrite", "rmw", "triad", "chase" };
+
+static mem_pattern_cfg_t g_cfg;
+static int g_active = 0;
+
+// Process-shared totals, filled in by mem_pattern_free() of every worker
+typedef struct {
+    _Atomic uint64_t workers, passes, accesses, bytes;
+    _Atomic uint64_t ns_sum;
+    _Atomic uint64_t t_first, t_last;   // sweep span over all workers
+} mem_totals_t;
+
+static mem_totals_t *g_tot = NULL;
+static volatile uint64_t g_sink;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// ---- kernels: one set per element width ----------------------------------
+// Every kernel takes the buffer and the pass number, touches m->elems elements
+// and returns something for the sink.
+typedef uint64_t (*mem_kernel_t)(const mem_pattern_buf_t *m, size_t step, size_t iter);
+
+#define MEM_KERNELS(W, T, FT)                                                        \
+static uint64_t seqread_##W(const mem_pattern_buf_t *m, size_t step, size_t iter) {  \
+    const T *a = (const T *)m->a;                                                    \
+    T sum = 0;                                                                       \
+    (void)iter;                                                                      \
+    for (size_t i = 0, e = m->elems * step; i < e; i += step) sum += a[i];           \
+    return (uint64_t)sum;                                                            \
+}                                                                                    \
+static uint64_t seqwrite_##W(const mem_pattern_buf_t *m, size_t step, size_t iter) { \
+    T *a = (T *)m->a;                                                                \
+    T v = (T)iter;                                                                   \
+    for (size_t i = 0, e = m->elems * step; i < e; i += step) a[i] = v;              \
+    return (uint64_t)a[0];                                                           \
+}                                                                                    \
+static uint64_t rmw_##W(const mem_pattern_buf_t *m, size_t step, size_t iter) {      \
+    T *a = (T *)m->a;                                                                \
+    T v = (T)(iter | 1);                                                             \
+    for (size_t i = 0, e = m->elems * step; i < e; i += step) a[i] += v;             \
+    return (uint64_t)a[0];                                                           \
+}                                                                                    \
+static uint64_t triad_##W(const mem_pattern_buf_t *m, size_t step, size_t iter) {    \
+    FT *a = (FT *)m->a;                                                              \
+    const FT *b = (const FT *)m->b, *c = (const FT *)m->c;                           \
+    const FT s = (FT)3.0;                                                            \
+    (void)iter;                                                                      \
+    for (size_t i = 0, e = m->elems * step; i < e; i += step) a[i] = b[i] + s * c[i]; \
+    return (uint64_t)a[0];                                                           \
+}
+
+MEM_KERNELS(4, uint32_t, float)
+MEM_KERNELS(8, uint64_t, double)
+
+static uint64_t chase(const mem_pattern_buf_t *m, size_t step, size_t iter) {
+    void **p = (void **)m->a;
+    (void)step;
+    (void)iter;
+    for (size_t i = 0; i < m->elems; i++) p = (void **)*p;
+    return (uint64_t)(uintptr_t)p;
+}
+
+// [pattern][width 4, 8]; xor is handled by mem_sweep()
+static const mem_kernel_t g_kernel[PAT_COUNT][2] = {
+    [PAT_SEQREAD]  = { seqread_4, seqread_8 },
+    [PAT_SEQWRITE] = { seqwrite_4, seqwrite_8 },
+    [PAT_RMW]      = { rmw_4, rmw_8 },
+    [PAT_TRIAD]    = { triad_4, triad_8 },
+    [PAT_CHASE]    = { chase, chase },
+};
+
+// ---- configuration --------------------------------------------------------
+const char *mem_pattern_name(int p) {
+    return (p >= 0 && p < PAT_COUNT) ? g_pattern_name[p] : "?";
+}
+
+int mem_pattern_parse(const char *s) {
+    for (int i = 0; i < PAT_COUNT; i++) {
+        if (strcmp(s, g_pattern_name[i]) == 0) return i;
+    }
+    return -1;
+}
+
+size_t mem_size_parse(const char *s) {
+    char *end = NULL;
+    unsigned long long v = strtoull(s, &end, 10);
+    if (s[0] == '\0' || s[0] == '-' || end == s) return 0;
+    switch (*end) {
+    case 'k': case 'K': v <<= 10; end++; break;
+    case 'm': case 'M': v <<= 20; end++; break;
+    case 'g': case 'G': v <<= 30; end++; break;
+    default: break;
+    }
+    if (*end != '\0') return 0;
+    return (size_t)v;
+}
+
+static size_t access_bytes(void) {
+    switch (g_cfg.pattern) {
+    case PAT_RMW:   return 2 * g_cfg.width;
+    case PAT_TRIAD: return 3 * g_cfg.width;
+    case PAT_CHASE: return sizeof(void *);
+    default:        return g_cfg.width;
+    }
+}
+
+int mem_pattern_set(const mem_pattern_cfg_t *cfg) {
+    if (cfg->pattern == PAT_XOR) {
+        g_active = 0;
+        return 0;
+    }
+    if (cfg->width != 4 && cfg->width != 8) {
+        fprintf(stderr, "--width must be 4 or 8\n");
+        return -1;
+    }
+    size_t min_stride = cfg->pattern == PAT_CHASE ? sizeof(void *) : cfg->width;
+    if (cfg->stride < min_stride || cfg->stride % min_stride != 0) {
+        fprintf(stderr, "--stride must be a multiple of %zu\n", min_stride);
+        return -1;
+    }
+    size_t arrays = cfg->pattern == PAT_TRIAD ? 3 : 1;
+    if (cfg->wss / arrays < 2 * cfg->stride || cfg->wss > (64UL << 30)) {
+        fprintf(stderr, "--wss must hold at least 2 strides per array (and be <= 64G)\n");
+        return -1;
+    }
+
+    if (!g_tot) {
+        void *p = mmap(NULL, sizeof(mem_totals_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            perror("mmap failed in mem_pattern_set()");
+            return -1;
+        }
+        g_tot = (mem_totals_t *)p;      // zero-filled
+    }
+    g_cfg = *cfg;
+    g_active = 1;
+    return 0;
+}
+
+const mem_pattern_cfg_t *mem_pattern_get(void) {
+    return g_active ? &g_cfg : NULL;
+}
+
+// ---- buffers --------------------------------------------------------------
+// Random single cycle over the nodes (Sattolo), so the prefetcher cannot follow
+static void chase_init(mem_pattern_buf_t *m) {
+    size_t n = m->elems, stride = g_cfg.stride;
+    size_t *order = (size_t *)malloc(n * sizeof(size_t));
+    uint64_t x = 0x9E3779B97F4A7C15ULL ^ (uint64_t)(uintptr_t)m;
+
+    if (!order) {                       // fall back to a sequential ring
+        for (size_t i = 0; i < n; i++) *(void **)(m->a + i * stride) = m->a + ((i + 1) % n) * stride;
+        return;
+    }
+    for (size_t i = 0; i < n; i++) order[i] = i;
+    for (size_t i = n - 1; i > 0; i--) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        size_t j = (size_t)(x % i);     // j < i: one cycle through all nodes
+        size_t t = order[i];
+        order[i] = order[j];
+        order[j] = t;
+    }
+    for (size_t i = 0; i < n; i++) {
+        *(void **)(m->a + order[i] * stride) = m->a + order[(i + 1) % n] * stride;
+    }
+    free(order);
+}
+
+static int buf_init(mem_pattern_buf_t *m) {
+    size_t len = (g_cfg.wss + 63) & ~(size_t)63;
+    m->base = membuf_alloc(&m->st, len);    // first touch, as mem() always did
+    if (!m->base) return -1;
+    m->len = len;
+
+    if (g_cfg.pattern == PAT_TRIAD) {
+        size_t part = (len / 3) & ~(size_t)63;
+        m->a = m->base;
+        m->b = m->base + part;
+        m->c = m->base + 2 * part;
+        m->elems = part / g_cfg.stride;
+        for (size_t i = 0; i < part; i += g_cfg.width) {
+            if (g_cfg.width == 4) {
+                *(float *)(m->b + i) = 1.0f;
+                *(float *)(m->c + i) = 2.0f;
+            } else {
+                *(double *)(m->b + i) = 1.0;
+                *(double *)(m->c + i) = 2.0;
+            }
+        }
+    } else {
+        m->a = m->base;
+        m->elems = g_cfg.wss / g_cfg.stride;
+        if (g_cfg.pattern == PAT_CHASE) chase_init(m);
+    }
+    return 0;
+}
+
+int mem_pattern_pass(mem_pattern_buf_t *m, size_t iter) {
+    if (!m->base && buf_init(m) != 0) return -1;
+
+    mem_kernel_t k = g_kernel[g_cfg.pattern][g_cfg.width == 8];
+    membuf_sweep_begin(&m->st);
+    uint64_t t0 = now_ns();
+    g_sink = k(m, g_cfg.stride / g_cfg.width, iter);
+    uint64_t t1 = now_ns();
+    membuf_sweep_end(&m->st);
+    if (!m->passes) m->t_first = t0;
+    m->t_last = t1;
+    m->ns += t1 - t0;
+    m->passes++;
+    return 0;
+}
+
+void mem_pattern_free(mem_pattern_buf_t *m) {
+    if (m->passes && g_tot) {
+        uint64_t acc = m->passes * m->elems;
+        atomic_fetch_add(&g_tot->workers, 1);
+        atomic_fetch_add(&g_tot->passes, m->passes);
+        atomic_fetch_add(&g_tot->accesses, acc);
+        atomic_fetch_add(&g_tot->bytes, acc * access_bytes());
+        atomic_fetch_add(&g_tot->ns_sum, m->ns);
+        uint64_t cur = atomic_load(&g_tot->t_first);
+        while ((cur == 0 || m->t_first < cur) && !atomic_compare_exchange_weak(&g_tot->t_first, &cur, m->t_first)) {
+        }
+        cur = atomic_load(&g_tot->t_last);
+        while (m->t_last > cur && !atomic_compare_exchange_weak(&g_tot->t_last, &cur, m->t_last)) {
+        }
+    }
+    membuf_stats_flush(&m->st);
+    membuf_free(m->base, m->len);
+    memset(m, 0, sizeof(*m));
+}
+
+void mem_pattern_report(const char *prog) {
+    if (!g_active || !g_tot) return;
+    uint64_t workers = atomic_load(&g_tot->workers), acc = atomic_load(&g_tot->accesses);
+    uint64_t bytes = atomic_load(&g_tot->bytes), ns_sum = atomic_load(&g_tot->ns_sum);
+    uint64_t span = atomic_load(&g_tot->t_last) - atomic_load(&g_tot->t_first);
+    if (!workers || !acc || !span) return;
+
+    // aggregate: all bytes over the span from the first pass to the last one of any
+    // worker (honest on one core too); per worker: own bytes / own sweep time
+    printf("%s mem pattern=%s width=%zu stride=%zu wss=%zu: workers=%llu passes=%llu "
+           "GB/s=%.2f (per worker %.2f) ns/access=%.2f\n",
+           prog, g_pattern_name[g_cfg.pattern], g_cfg.width, g_cfg.stride, g_cfg.wss,
+           (unsigned long long)workers, (unsigned long long)atomic_load(&g_tot->passes),
+           (double)bytes / (double)span, (double)bytes / (double)ns_sum,
+           (double)ns_sum / (double)acc);
+}
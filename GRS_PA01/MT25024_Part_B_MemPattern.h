@@ -0,0 +1,69 @@
+#ifndef MEMPATTERN_H
+#define MEMPATTERN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "MT25024_Part_B_MemBuf.h"
+
+// Access patterns for the mem() worker (--pattern). One mem() iteration is one
+// pass over the working set (--wss), touching one element (--width bytes) every
+// --stride bytes. The kernels are generated per pattern and element width by a
+// macro, so each loop is compiled with its width and operation fixed.
+//
+//   xor       the original mem(): 50 MB, XOR one byte per 64-byte line (default)
+//   seqread   sum += a[i]                       1 access = width bytes read
+//   seqwrite  a[i] = v                          1 access = width bytes written
+//   rmw       a[i] += v                         1 access = width read + width written
+//   triad     a[i] = b[i] + s * c[i] (float/double, wss split over a, b, c)
+//                                               1 access = 2 width read + width written
+//   chase     p = *p over a random cycle, one node per stride (dependent loads:
+//             latency, not bandwidth)           1 access = 8 bytes read
+typedef enum {
+    PAT_XOR = 0,
+    PAT_SEQREAD,
+    PAT_SEQWRITE,
+    PAT_RMW,
+    PAT_TRIAD,
+    PAT_CHASE,
+    PAT_COUNT
+} mem_pattern_t;
+
+typedef struct {
+    mem_pattern_t pattern;
+    size_t wss;             // bytes
+    size_t stride;          // bytes between touched elements
+    size_t width;           // 4 or 8
+} mem_pattern_cfg_t;
+
+// Per-worker buffer and counters (lives in worker_ctx_t)
+typedef struct {
+    char *base;             // allocation (a, b, c point into it)
+    size_t len;
+    membuf_stats_t st;      // first touch vs sweep
+    char *a, *b, *c;
+    size_t elems;           // accesses per pass
+    uint64_t passes, ns;    // sweep time only, not the setup
+    uint64_t t_first, t_last;   // CLOCK_MONOTONIC start of first / end of last pass
+} mem_pattern_buf_t;
+
+const char *mem_pattern_name(int p);
+int mem_pattern_parse(const char *s);       // -1 if unknown
+
+// "32K", "4M", "1G" or plain bytes; 0 on error
+size_t mem_size_parse(const char *s);
+
+// Select the pattern for every later mem() call; validates the sizes and sets up
+// the process-shared totals, so call it before forking. 0, or -1 with a message.
+int mem_pattern_set(const mem_pattern_cfg_t *cfg);
+const mem_pattern_cfg_t *mem_pattern_get(void);     // NULL while xor
+
+// One pass (sets the buffer up on first use). 0 or -1.
+int mem_pattern_pass(mem_pattern_buf_t *m, size_t iter);
+
+// Adds the worker's counters to the shared totals and frees the buffer
+void mem_pattern_free(mem_pattern_buf_t *m);
+
+// GB/s and ns/access over all workers
+void mem_pattern_report(const char *prog);
+
+#endif
@@ -0,0 +1,320 @@
+#include "MT25024_Part_B_Options.h"
+#include "MT25024_Part_B_Workers.h"
+#include "MT25024_Part_B_Simd.h"
+#include "MT25024_Part_B_Account.h"
+#include "MT25024_Part_B_Pin.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void run_opts_usage(const char *prog, const char *unit) {
+    fprintf(stderr, "Usage: %s <cpu|mem|io> [%s]\n", prog, unit);
+    fprintf(stderr, "       %s <cpu|mem|io|mix> [%s] --sched=static|steal|compare [--loops=N]\n", prog, unit);
+    fprintf(stderr, "       %s <cpu|mem|io> [%s] --strong [--loops=N]\n", prog, unit);
+    fprintf(stderr, "       options for all: --loops=N --isa=scalar|sse2|avx2|avx512|auto\n");
+    fprintf(stderr, "                        --csv=FILE --cpus=LIST (worker i on LIST[i %% len], e.g. 0,2,4-7)\n");
+    fprintf(stderr, "       mem options: --pattern=xor|seqread|seqwrite|rmw|triad|chase --wss=SIZE[K|M|G]\n");
+    fprintf(stderr, "                    --stride=BYTES --width=4|8 --pages=4k|thp|huge --populate\n");
+    fprintf(stderr, "                    --mem-shared (Program B)\n");
+    fprintf(stderr, "       io options:  --io-engine=stdio|pwrite|direct|uring --qd=N\n");
+    fprintf(stderr, "                    --commit=fsync|group|range --window=US\n");
+    fprintf(stderr, "                    --read=pread|mmap|uring --access=seq|rand --readahead=on|off\n");
+    fprintf(stderr, "                    --cache=cold|warm --files=N --file-size=SIZE --block=SIZE\n");
+}
+
+// Strict positive integer (atoi would take "4x" or "-1")
+static int parse_count(const char *s, size_t *out) {
+    char *end = NULL;
+    unsigned long long v = strtoull(s, &end, 10);
+    if (s[0] == '\0' || s[0] == '-' || *end != '\0' || v == 0) return -1;
+    *out = (size_t)v;
+    return 0;
+}
+
+int run_opts_parse(int argc, char *argv[], int def_workers, run_opts_t *o) {
+    memset(o, 0, sizeof(*o));
+    o->workers = def_workers;
+    o->loops = LOOP_COUNT;
+    o->sched = SCHED_NONE;
+    o->isa = ISA_SCALAR;
+    o->mem.pattern = PAT_XOR;
+    o->mem.wss = MEM_SIZE;
+    o->mem.width = 8;
+    size_t stride = 0;      // default depends on the pattern
+    int window_set = 0;
+    int read_opt = 0;       // a read option other than --read
+    o->rd.readahead = 1;
+    o->rd.files = 4;
+    o->rd.file_size = 16UL << 20;
+    o->rd.block = 4096;
+    o->io.engine = IOE_STDIO;
+    o->io.qd = 8;
+
+    if (argc < 2) return -1;
+    o->work = argv[1];
+    o->kind = work_kind(o->work);
+    if (o->kind < 0) {
+        fprintf(stderr, "Unknown worker type: %s\n", o->work);
+        return -1;
+    }
+
+    int pos = 0;
+    for (int i = 2; i < argc; i++) {
+        const char *a = argv[i];
+        if (strncmp(a, "--sched=", 8) == 0) {
+            const char *m = a + 8;
+            if (strcmp(m, "static") == 0) o->sched = SCHED_STATIC;
+            else if (strcmp(m, "steal") == 0) o->sched = SCHED_STEAL;
+            else if (strcmp(m, "compare") == 0) o->sched = SCHED_COMPARE;
+            else {
+                fprintf(stderr, "Unknown scheduler: %s (static|steal|compare)\n", m);
+                return -1;
+            }
+        } else if (strncmp(a, "--loops=", 8) == 0) {
+            if (parse_count(a + 8, &o->loops) != 0) {
+                fprintf(stderr, "Invalid --loops: %s\n", a + 8);
+                return -1;
+            }
+        } else if (strncmp(a, "--isa=", 6) == 0) {
+            o->isa = isa_parse(a + 6);
+            if (o->isa == -2) {
+                fprintf(stderr, "Unknown ISA: %s (scalar|sse2|avx2|avx512|auto)\n", a + 6);
+                return -1;
+            }
+            if (cpu_set_isa(o->isa) != 0) {
+                fprintf(stderr, "ISA %s is not supported by this CPU\n", a + 6);
+                return -1;
+            }
+        } else if (strncmp(a, "--pattern=", 10) == 0) {
+            int pat = mem_pattern_parse(a + 10);
+            if (pat < 0) {
+                fprintf(stderr, "Unknown pattern: %s\n", a + 10);
+                return -1;
+            }
+            o->mem.pattern = (mem_pattern_t)pat;
+        } else if (strncmp(a, "--wss=", 6) == 0) {
+            if ((o->mem.wss = mem_size_parse(a + 6)) == 0) {
+                fprintf(stderr, "Invalid --wss: %s\n", a + 6);
+                return -1;
+            }
+        } else if (strncmp(a, "--stride=", 9) == 0) {
+            if ((stride = mem_size_parse(a + 9)) == 0) {
+                fprintf(stderr, "Invalid --stride: %s\n", a + 9);
+                return -1;
+            }
+        } else if (strncmp(a, "--width=", 8) == 0) {
+            if (parse_count(a + 8, &o->mem.width) != 0) {
+                fprintf(stderr, "Invalid --width: %s\n", a + 8);
+                return -1;
+            }
+        } else if (strncmp(a, "--pages=", 8) == 0) {
+            const char *m = a + 8;
+            if (strcmp(m, "4k") == 0) o->membuf.pages = PAGES_4K;
+            else if (strcmp(m, "thp") == 0) o->membuf.pages = PAGES_THP;
+            else if (strcmp(m, "huge") == 0) o->membuf.pages = PAGES_HUGE;
+            else {
+                fprintf(stderr, "Unknown page mode: %s (4k|thp|huge)\n", m);
+                return -1;
+            }
+        } else if (strcmp(a, "--populate") == 0) {
+            o->membuf.populate = 1;
+        } else if (strcmp(a, "--mem-shared") == 0) {
+            o->membuf.shared = 1;
+        } else if (strncmp(a, "--io-engine=", 12) == 0) {
+            int e = io_engine_parse(a + 12);
+            if (e < 0) {
+                fprintf(stderr, "Unknown io engine: %s (stdio|pwrite|direct|uring)\n", a + 12);
+                return -1;
+            }
+            o->io.engine = (io_engine_t)e;
+            o->io_set = 1;
+        } else if (strncmp(a, "--qd=", 5) == 0) {
+            size_t qd;
+            if (parse_count(a + 5, &qd) != 0 || qd > IO_MAX_QD) {
+                fprintf(stderr, "Invalid --qd: %s (1..%d)\n", a + 5, IO_MAX_QD);
+                return -1;
+            }
+            o->io.qd = (unsigned)qd;
+        } else if (strncmp(a, "--commit=", 9) == 0) {
+            int m = group_commit_parse(a + 9);
+            if (m < 0) {
+                fprintf(stderr, "Unknown commit mode: %s (fsync|group|range)\n", a + 9);
+                return -1;
+            }
+            o->commit.mode = (gc_mode_t)m;
+        } else if (strncmp(a, "--window=", 9) == 0) {
+            char *end = NULL;
+            unsigned long us = strtoul(a + 9, &end, 10);
+            if (a[9] == '\0' || a[9] == '-' || *end != '\0' || us > 1000000) {
+                fprintf(stderr, "Invalid --window: %s (0..1000000 us)\n", a + 9);
+                return -1;
+            }
+            o->commit.window_us = (unsigned)us;
+            window_set = 1;
+        } else if (strncmp(a, "--read=", 7) == 0) {
+            int m = read_method_parse(a + 7);
+            if (m < 0) {
+                fprintf(stderr, "Unknown read method: %s (pread|mmap|uring)\n", a + 7);
+                return -1;
+            }
+            o->rd.method = (read_method_t)m;
+        } else if (strncmp(a, "--access=", 9) == 0) {
+            const char *m = a + 9;
+            if (strcmp(m, "seq") == 0) o->rd.random = 0;
+            else if (strcmp(m, "rand") == 0) o->rd.random = 1;
+            else {
+                fprintf(stderr, "Unknown access: %s (seq|rand)\n", m);
+                return -1;
+            }
+            read_opt = 1;
+        } else if (strncmp(a, "--readahead=", 12) == 0) {
+            const char *m = a + 12;
+            if (strcmp(m, "on") == 0) o->rd.readahead = 1;
+            else if (strcmp(m, "off") == 0) o->rd.readahead = 0;
+            else {
+                fprintf(stderr, "Unknown readahead: %s (on|off)\n", m);
+                return -1;
+            }
+            read_opt = 1;
+        } else if (strncmp(a, "--cache=", 8) == 0) {
+            const char *m = a + 8;
+            if (strcmp(m, "cold") == 0) o->rd.warm = 0;
+            else if (strcmp(m, "warm") == 0) o->rd.warm = 1;
+            else {
+                fprintf(stderr, "Unknown cache: %s (cold|warm)\n", m);
+                return -1;
+            }
+            read_opt = 1;
+        } else if (strncmp(a, "--files=", 8) == 0) {
+            size_t n;
+            if (parse_count(a + 8, &n) != 0 || n > RD_MAX_FILES) {
+                fprintf(stderr, "Invalid --files: %s (1..%d)\n", a + 8, RD_MAX_FILES);
+                return -1;
+            }
+            o->rd.files = (unsigned)n;
+            read_opt = 1;
+        } else if (strncmp(a, "--file-size=", 12) == 0) {
+            if ((o->rd.file_size = mem_size_parse(a + 12)) == 0) {
+                fprintf(stderr, "Invalid --file-size: %s\n", a + 12);
+                return -1;
+            }
+            read_opt = 1;
+        } else if (strncmp(a, "--block=", 8) == 0) {
+            if ((o->rd.block = mem_size_parse(a + 8)) == 0) {
+                fprintf(stderr, "Invalid --block: %s\n", a + 8);
+                return -1;
+            }
+            read_opt = 1;
+        } else if (strncmp(a, "--csv=", 6) == 0) {
+            if (a[6] == '\0') {
+                fprintf(stderr, "--csv needs a file name\n");
+                return -1;
+            }
+            o->csv = a + 6;
+        } else if (strncmp(a, "--cpus=", 7) == 0) {
+            o->cpus = a + 7;
+        } else if (strcmp(a, "--strong") == 0) {
+            o->strong = 1;
+        } else if (a[0] != '-' && pos == 0) {
+            size_t n;
+            if (parse_count(a, &n) != 0 || n > 4096) {
+                fprintf(stderr, "Invalid number of workers: %s\n", a);
+                return -1;
+            }
+            o->workers = (int)n;
+            pos++;
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", a);
+            return -1;
+        }
+    }
+
+    if (o->strong && o->sched != SCHED_NONE) {
+        fprintf(stderr, "--strong and --sched cannot be combined\n");
+        return -1;
+    }
+    if (o->strong && o->membuf.shared) {
+        fprintf(stderr, "--mem-shared and --strong cannot be combined (--strong maps its own shared buffer)\n");
+        return -1;
+    }
+    if (o->strong && o->kind == WORK_MIX) {
+        fprintf(stderr, "--strong needs cpu, mem or io\n");
+        return -1;
+    }
+    if (o->kind == WORK_MIX && o->sched == SCHED_NONE) {
+        fprintf(stderr, "Worker type 'mix' needs --sched\n");
+        return -1;
+    }
+
+    if (o->csv && (o->strong || o->sched == SCHED_COMPARE)) {
+        fprintf(stderr, "--csv records one run: not with --strong or --sched=compare\n");
+        return -1;
+    }
+    if (account_set(o->csv, o->workers) != 0) return -1;
+    if (pin_set(o->cpus) != 0) return -1;
+
+    // Chase nodes default to one per cache line, the other patterns to dense elements
+    o->mem.stride = stride ? stride : (o->mem.pattern == PAT_CHASE ? 64 : o->mem.width);
+    if (o->mem.pattern != PAT_XOR) {
+        if (o->kind != WORK_MEM && o->kind != WORK_MIX) {
+            fprintf(stderr, "--pattern needs mem or mix\n");
+            return -1;
+        }
+        if (o->strong) {
+            fprintf(stderr, "--pattern and --strong cannot be combined\n");
+            return -1;
+        }
+    }
+    if (o->membuf.pages != PAGES_MALLOC || o->membuf.populate || o->membuf.shared) {
+        if (o->kind != WORK_MEM && o->kind != WORK_MIX) {
+            fprintf(stderr, "--pages, --populate and --mem-shared need mem or mix\n");
+            return -1;
+        }
+        if (o->strong) {
+            fprintf(stderr, "--strong maps its own shared buffer; drop --pages/--populate\n");
+            return -1;
+        }
+    }
+    if (membuf_set(&o->membuf) != 0) return -1;
+    if (o->io_set) {
+        if (o->kind != WORK_IO && o->kind != WORK_MIX) {
+            fprintf(stderr, "--io-engine needs io or mix\n");
+            return -1;
+        }
+        if (io_engine_set(&o->io) != 0) return -1;
+    }
+    if (o->commit.mode != GC_OFF) {
+        if (o->kind != WORK_IO && o->kind != WORK_MIX) {
+            fprintf(stderr, "--commit needs io or mix\n");
+            return -1;
+        }
+        if (o->io_set) {
+            fprintf(stderr, "--commit writes its own shared log; drop --io-engine\n");
+            return -1;
+        }
+        if (window_set && o->commit.mode == GC_FSYNC) {
+            fprintf(stderr, "--window needs --commit=group or range\n");
+            return -1;
+        }
+        if (group_commit_set(&o->commit) != 0) return -1;
+    } else if (window_set) {
+        fprintf(stderr, "--window needs --commit=group or range\n");
+        return -1;
+    }
+    if (o->rd.method != RD_OFF) {
+        if (o->kind != WORK_IO && o->kind != WORK_MIX) {
+            fprintf(stderr, "--read needs io or mix\n");
+            return -1;
+        }
+        if (o->io_set || o->commit.mode != GC_OFF) {
+            fprintf(stderr, "--read cannot be combined with --io-engine or --commit\n");
+            return -1;
+        }
+        o->rd.qd = o->io.qd;
+        if (read_work_set(&o->rd) != 0) return -1;
+    } else if (read_opt) {
+        fprintf(stderr, "--access, --readahead, --cache, --files, --file-size and --block need --read\n");
+        return -1;
+    }
+    return mem_pattern_set(&o->mem);
+}
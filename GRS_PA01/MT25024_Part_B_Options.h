@@ -0,0 +1,52 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include <stddef.h>
+#include "MT25024_Part_B_MemPattern.h"
+#include "MT25024_Part_B_IoEngine.h"
+#include "MT25024_Part_B_GroupCommit.h"
+#include "MT25024_Part_B_ReadWork.h"
+
+// How the loop iterations are handed to the workers
+typedef enum {
+    SCHED_NONE = 0,     // original behaviour: every worker runs cpu/mem/io(loops)
+    SCHED_STATIC,       // task runtime, each worker only runs its own deque
+    SCHED_STEAL,        // task runtime with work stealing
+    SCHED_COMPARE       // static, then steal, and print both makespans
+} sched_mode_t;
+
+// Command line shared by Program A and Program B:
+//   <cpu|mem|io|mix> [num_workers] [--sched=static|steal|compare] [--loops=N]
+//   [--isa=scalar|sse2|avx2|avx512|auto] [--strong] [--csv=FILE] [--cpus=LIST]
+//   [--pattern=P] [--wss=SIZE] [--stride=B] [--width=4|8]
+//   [--pages=4k|thp|huge] [--populate] [--mem-shared]
+//   [--io-engine=stdio|pwrite|direct|uring] [--qd=N]
+//   [--commit=fsync|group|range] [--window=US]
+//   [--read=pread|mmap|uring] [--access=seq|rand] [--readahead=on|off]
+//   [--cache=cold|warm] [--files=N] [--file-size=SIZE] [--block=SIZE]
+typedef struct {
+    const char *work;   // worker type as typed
+    int kind;           // WORK_CPU / WORK_MEM / WORK_IO / WORK_MIX
+    int workers;        // child processes (A) or threads (B)
+    size_t loops;       // iterations per worker (default LOOP_COUNT)
+    sched_mode_t sched;
+    int isa;            // cpu() kernel (ISA_SCALAR unless --isa)
+    int strong;         // split loops across 1..workers (MT25024_Part_B_Strong.h)
+    mem_pattern_cfg_t mem;  // mem() access pattern (MT25024_Part_B_MemPattern.h)
+    membuf_cfg_t membuf;    // mem() buffer mapping (MT25024_Part_B_MemBuf.h)
+    int io_set;             // --io-engine given
+    io_engine_cfg_t io;     // io() engine (MT25024_Part_B_IoEngine.h)
+    commit_cfg_t commit;    // io() group commit (MT25024_Part_B_GroupCommit.h)
+    read_cfg_t rd;          // io() read workload (MT25024_Part_B_ReadWork.h)
+    const char *csv;        // in-process accounting row (MT25024_Part_B_Account.h)
+    const char *cpus;       // worker placement (MT25024_Part_B_Pin.h)
+} run_opts_t;
+
+// Returns 0, or -1 after printing the reason. Also selects the cpu() kernel (--isa)
+// the mem() pattern and buffer mapping, and the io() engine, group commit or reads.
+int run_opts_parse(int argc, char *argv[], int def_workers, run_opts_t *o);
+
+// unit is "num_processes" or "num_threads"
+void run_opts_usage(const char *prog, const char *unit);
+
+#endif
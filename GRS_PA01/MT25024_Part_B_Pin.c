@@ -0,0 +1,74 @@
+#define _GNU_SOURCE     // cpu_set_t, sched_setaffinity
+#include "MT25024_Part_B_Pin.h"
+#include <errno.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int g_cpu[PIN_MAX_CPUS];
+static int g_ncpu = 0;
+
+static int bad(const char *list, const char *why) {
+    fprintf(stderr, "Invalid --cpus: %s (%s)\n", list, why);
+    g_ncpu = 0;
+    return -1;
+}
+
+int pin_set(const char *list) {
+    g_ncpu = 0;
+    if (!list) return 0;
+
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        perror("sched_getaffinity failed in pin_set()");
+        return -1;
+    }
+
+    const char *p = list;
+    while (*p) {
+        char *end;
+        errno = 0;
+        long lo = strtol(p, &end, 10), hi;
+        if (end == p || lo < 0 || errno) return bad(list, "expected N or N-M");
+        hi = lo;
+        if (*end == '-') {
+            p = end + 1;
+            hi = strtol(p, &end, 10);
+            if (end == p || hi < lo) return bad(list, "expected N or N-M");
+        }
+        for (long c = lo; c <= hi; c++) {
+            if (c >= CPU_SETSIZE || !CPU_ISSET((int)c, &allowed)) {
+                fprintf(stderr, "Invalid --cpus: CPU %ld is not available to this process\n", c);
+                g_ncpu = 0;
+                return -1;
+            }
+            if (g_ncpu == PIN_MAX_CPUS) return bad(list, "too many CPUs");
+            g_cpu[g_ncpu++] = (int)c;
+        }
+        if (*end == ',') end++;
+        else if (*end != '\0') return bad(list, "expected N or N-M");
+        p = end;
+    }
+    if (g_ncpu == 0) return bad(list, "empty");
+    return 0;
+}
+
+int pin_active(void) {
+    return g_ncpu > 0;
+}
+
+int pin_worker(int id) {
+    if (g_ncpu == 0 || id < 0) return 0;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(g_cpu[id % g_ncpu], &set);
+    // pid 0 = the calling thread, so this works for children and threads alike
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+        perror("sched_setaffinity failed");
+        return -1;
+    }
+    return 0;
+}
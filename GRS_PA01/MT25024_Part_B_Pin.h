@@ -0,0 +1,17 @@
+#ifndef PIN_H
+#define PIN_H
+
+// Explicit worker placement (--cpus=LIST, e.g. 0,2,4-7): worker i runs on
+// LIST[i % len], set by the worker itself (child process or thread) before its
+// first iteration. Without --cpus nothing is pinned, so an outer taskset still applies.
+#define PIN_MAX_CPUS 1024
+
+// Parse and check the list against the CPUs this process may use; call before
+// forking. NULL turns pinning off. 0, or -1 with a message.
+int pin_set(const char *list);
+int pin_active(void);
+
+// Pin the calling thread for worker id (no-op without --cpus). 0 or -1.
+int pin_worker(int id);
+
+#endif
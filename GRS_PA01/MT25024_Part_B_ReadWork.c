@@ -0,0 +1,364 @@
+#include "MT25024_Part_B_ReadWork.h"
+#include "MT25024_Part_B_Workers.h"
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define RD_PAGE      4096
+#define RD_GEN_CHUNK (1UL << 20)
+
+static const char *g_method_name[RD_COUNT] = { "off", "pread", "mmap", "uring" };
+
+static read_cfg_t g_cfg;
+static int g_fd[RD_MAX_FILES];      // the generated set, opened before fork (unlinked)
+static uint64_t g_bpf, g_nblocks;   // blocks per file, in the set
+static volatile uint64_t g_sink;
+
+// Process-shared totals
+typedef struct {
+    _Atomic uint64_t workers, reads, bytes, errors, ids;
+    _Atomic uint64_t t_first, t_last;
+    hist_shared_t lat;
+} read_totals_t;
+
+static read_totals_t *g_tot = NULL;
+
+const char *read_method_name(int m) {
+    return (m >= 0 && m < RD_COUNT) ? g_method_name[m] : "?";
+}
+
+int read_method_parse(const char *s) {
+    for (int i = RD_PREAD; i < RD_COUNT; i++) {
+        if (strcmp(s, g_method_name[i]) == 0) return i;
+    }
+    return -1;
+}
+
+int read_work_active(void) {
+    return g_tot != NULL && g_cfg.method != RD_OFF;
+}
+
+static int gen_file(unsigned i, const char *chunk) {
+    char name[64];
+    snprintf(name, sizeof(name), "io_read_%ld_%u.bin", (long)getpid(), i);
+    int fd = open(name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        perror("open failed in read_work_set()");
+        return -1;
+    }
+    unlink(name);           // the fd keeps it; workers reopen through /proc/self/fd
+
+    for (size_t off = 0; off < g_cfg.file_size; off += RD_GEN_CHUNK) {
+        size_t len = g_cfg.file_size - off < RD_GEN_CHUNK ? g_cfg.file_size - off : RD_GEN_CHUNK;
+        if (pwrite(fd, chunk, len, (off_t)off) != (ssize_t)len) {
+            perror("pwrite failed in read_work_set()");
+            close(fd);
+            return -1;
+        }
+    }
+    // DONTNEED only drops clean pages: write back first
+    fsync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    return fd;
+}
+
+int read_work_set(const read_cfg_t *cfg) {
+    g_cfg = *cfg;
+    if (g_cfg.method == RD_OFF || g_tot) return 0;
+
+    if (g_cfg.files < 1 || g_cfg.files > RD_MAX_FILES) {
+        fprintf(stderr, "--files must be 1..%d\n", RD_MAX_FILES);
+        return -1;
+    }
+    if (g_cfg.block % RD_PAGE || g_cfg.block > RD_GEN_CHUNK) {
+        fprintf(stderr, "--block must be a multiple of 4K, at most 1M\n");
+        return -1;
+    }
+    if (g_cfg.file_size < g_cfg.block || g_cfg.file_size % g_cfg.block) {
+        fprintf(stderr, "--file-size must be a multiple of --block\n");
+        return -1;
+    }
+    if (g_cfg.qd < 1 || g_cfg.qd > IO_MAX_QD) {
+        fprintf(stderr, "--qd must be 1..%d\n", IO_MAX_QD);
+        return -1;
+    }
+    g_bpf = g_cfg.file_size / g_cfg.block;
+    g_nblocks = g_bpf * g_cfg.files;
+
+    char *chunk = (char *)malloc(RD_GEN_CHUNK);
+    if (!chunk) {
+        perror("malloc failed in read_work_set()");
+        return -1;
+    }
+    memset(chunk, 'R', RD_GEN_CHUNK);
+    for (unsigned i = 0; i < g_cfg.files; i++) {
+        g_fd[i] = gen_file(i, chunk);
+        if (g_fd[i] < 0) {
+            while (i > 0) close(g_fd[--i]);
+            free(chunk);
+            return -1;
+        }
+    }
+    free(chunk);
+
+    void *p = mmap(NULL, sizeof(read_totals_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+        perror("mmap failed in read_work_set()");
+        return -1;
+    }
+    g_tot = (read_totals_t *)p;
+    return 0;
+}
+
+static uint64_t splitmix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+static int worker_open(read_worker_t *w) {
+    w->open = 1;            // from here on read_work_close() cleans up
+    for (unsigned f = 0; f < RD_MAX_FILES; f++) w->fd[f] = -1;
+
+    int fadv = !g_cfg.readahead ? POSIX_FADV_RANDOM : (g_cfg.random ? POSIX_FADV_NORMAL : POSIX_FADV_SEQUENTIAL);
+    int madv = !g_cfg.readahead ? MADV_RANDOM : (g_cfg.random ? MADV_NORMAL : MADV_SEQUENTIAL);
+    for (unsigned f = 0; f < g_cfg.files; f++) {
+        // A new open file description, so the readahead state is this worker's own
+        char path[64];
+        snprintf(path, sizeof(path), "/proc/self/fd/%d", g_fd[f]);
+        w->fd[f] = open(path, O_RDONLY);
+        if (w->fd[f] < 0) {
+            perror("open failed in io() (--read)");
+            return -1;
+        }
+        posix_fadvise(w->fd[f], 0, 0, fadv);
+        if (g_cfg.method == RD_MMAP) {
+            void *m = mmap(NULL, g_cfg.file_size, PROT_READ, MAP_SHARED, w->fd[f], 0);
+            if (m == MAP_FAILED) {
+                perror("mmap failed in io() (--read)");
+                return -1;
+            }
+            w->map[f] = (char *)m;
+            madvise(m, g_cfg.file_size, madv);
+        }
+    }
+
+    uint64_t id = atomic_fetch_add(&g_tot->ids, 1) + 1;
+    w->rng = splitmix64(id ^ ((uint64_t)getpid() << 32) ^ (uint64_t)time(NULL));
+    if (!w->rng) w->rng = 1;
+    w->pos = w->rng % g_nblocks;
+    if (g_cfg.method == RD_MMAP) return 0;
+
+    unsigned nbuf = g_cfg.method == RD_URING ? g_cfg.qd : 1;
+    if (posix_memalign((void **)&w->buf, RD_PAGE, (size_t)nbuf * g_cfg.block) != 0) {
+        fprintf(stderr, "posix_memalign failed in io() (--read)\n");
+        w->buf = NULL;
+        return -1;
+    }
+    if (g_cfg.method == RD_URING) {
+        unsigned entries = 2;
+        while (entries < g_cfg.qd) entries <<= 1;
+        int err = uring_init(&w->ring, entries);
+        if (err < 0) {
+            fprintf(stderr, "io_uring_setup failed in io(): %s\n", strerror(-err));
+            return -1;
+        }
+        struct iovec iov[IO_MAX_QD];
+        for (unsigned i = 0; i < nbuf; i++) {
+            iov[i].iov_base = w->buf + (size_t)i * g_cfg.block;
+            iov[i].iov_len = g_cfg.block;
+            w->free_slot[i] = nbuf - 1 - i;
+        }
+        w->nfree = nbuf;
+        err = uring_register_buffers(&w->ring, iov, nbuf);
+        if (err < 0) {
+            fprintf(stderr, "IORING_REGISTER_BUFFERS failed in io(): %s\n", strerror(-err));
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static uint64_t next_block(read_worker_t *w) {
+    if (g_cfg.random) {
+        w->rng ^= w->rng << 13;
+        w->rng ^= w->rng >> 7;
+        w->rng ^= w->rng << 17;
+        return w->rng % g_nblocks;
+    }
+    uint64_t b = w->pos;
+    w->pos = (w->pos + 1) % g_nblocks;
+    return b;
+}
+
+static void done(read_worker_t *w, uint64_t blk, uint64_t t0, uint64_t t1) {
+    w->reads++;
+    w->bytes += g_cfg.block;
+    hist_add(&w->lat, t1 - t0);
+    if (!w->t_first) w->t_first = t0;
+    w->t_last = t1;
+
+    if (g_cfg.warm) return;
+    // --cache=cold: drop what was just read (untimed)
+    unsigned f = (unsigned)(blk / g_bpf);
+    off_t off = (off_t)((blk % g_bpf) * g_cfg.block);
+    if (w->map[f]) madvise(w->map[f] + off, g_cfg.block, MADV_DONTNEED);
+    posix_fadvise(w->fd[f], off, (off_t)g_cfg.block, POSIX_FADV_DONTNEED);
+}
+
+// ---- io_uring -------------------------------------------------------------
+static void uring_reap(read_worker_t *w) {
+    struct io_uring_cqe *cqe;
+    while ((cqe = uring_peek_cqe(&w->ring)) != NULL) {
+        uint64_t now = io_now_ns();
+        unsigned slot = (unsigned)cqe->user_data;
+        if (cqe->res != (int)g_cfg.block) {
+            if (!w->err) fprintf(stderr, "io_uring read: %s\n", cqe->res < 0 ? strerror(-cqe->res) : "short read");
+            w->err = 1;
+        } else {
+            w->sink += (unsigned char)w->buf[(size_t)slot * g_cfg.block];
+            done(w, w->slot_blk[slot], w->submit_ns[slot], now);
+        }
+        w->free_slot[w->nfree++] = slot;
+        w->inflight--;
+        uring_cqe_seen(&w->ring);
+    }
+}
+
+static int uring_read(read_worker_t *w, uint64_t blk) {
+    while (w->nfree == 0) {         // queue depth reached: wait for one
+        if (uring_submit(&w->ring, 1) < 0) return -1;
+        uring_reap(w);
+    }
+    unsigned slot = w->free_slot[--w->nfree];
+    struct io_uring_sqe *sqe = uring_get_sqe(&w->ring);
+    if (!sqe) {
+        w->free_slot[w->nfree++] = slot;
+        return -1;
+    }
+    sqe->opcode = IORING_OP_READ_FIXED;
+    sqe->fd = w->fd[blk / g_bpf];
+    sqe->addr = (uint64_t)(uintptr_t)(w->buf + (size_t)slot * g_cfg.block);
+    sqe->len = (unsigned)g_cfg.block;
+    sqe->off = (blk % g_bpf) * g_cfg.block;
+    sqe->buf_index = (uint16_t)slot;
+    sqe->user_data = slot;
+    w->slot_blk[slot] = blk;
+    w->submit_ns[slot] = io_now_ns();
+    w->inflight++;
+    return 0;
+}
+
+// ---- pread / mmap -----------------------------------------------------------
+static int sync_read(read_worker_t *w, uint64_t blk) {
+    unsigned f = (unsigned)(blk / g_bpf);
+    size_t off = (size_t)(blk % g_bpf) * g_cfg.block;
+    uint64_t t0 = io_now_ns(), sum = 0;
+
+    if (g_cfg.method == RD_MMAP) {
+        const char *p = w->map[f] + off;
+        for (size_t o = 0; o < g_cfg.block; o += RD_PAGE) sum += (unsigned char)p[o];
+    } else {
+        ssize_t n = pread(w->fd[f], w->buf, g_cfg.block, (off_t)off);
+        if (n != (ssize_t)g_cfg.block) {
+            if (n < 0) perror("pread failed in io()");
+            else fprintf(stderr, "pread failed in io(): short read\n");
+            w->err = 1;
+            return -1;
+        }
+        sum = (unsigned char)w->buf[0];
+    }
+    w->sink += sum;
+    done(w, blk, t0, io_now_ns());
+    return 0;
+}
+
+int read_work_iter(read_worker_t *w) {
+    if (w->err) return -1;
+    if (!w->open && worker_open(w) != 0) {
+        w->err = 1;
+        return -1;
+    }
+
+    size_t n = IO_BUF_SIZE / g_cfg.block;
+    if (n == 0) n = 1;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t blk = next_block(w);
+        int rc = g_cfg.method == RD_URING ? uring_read(w, blk) : sync_read(w, blk);
+        if (rc != 0) {
+            w->err = 1;
+            return -1;
+        }
+    }
+    if (g_cfg.method == RD_URING) {
+        if (uring_submit(&w->ring, 0) < 0) w->err = 1;
+        uring_reap(w);
+    }
+    return w->err ? -1 : 0;
+}
+
+void read_work_close(read_worker_t *w) {
+    if (!w->open) return;
+
+    if (w->ring.sq_ptr) {
+        while (w->inflight) {
+            if (uring_submit(&w->ring, 1) < 0) break;
+            uring_reap(w);
+        }
+        uring_exit(&w->ring);
+    }
+    if (g_tot) {
+        atomic_fetch_add(&g_tot->workers, 1);
+        atomic_fetch_add(&g_tot->reads, w->reads);
+        atomic_fetch_add(&g_tot->bytes, w->bytes);
+        if (w->err) atomic_fetch_add(&g_tot->errors, 1);
+        uint64_t cur = atomic_load(&g_tot->t_first);
+        while (w->t_first && (cur == 0 || w->t_first < cur) &&
+               !atomic_compare_exchange_weak(&g_tot->t_first, &cur, w->t_first)) {
+        }
+        cur = atomic_load(&g_tot->t_last);
+        while (w->t_last > cur && !atomic_compare_exchange_weak(&g_tot->t_last, &cur, w->t_last)) {
+        }
+        hist_merge(&g_tot->lat, &w->lat);
+    }
+    g_sink += w->sink;
+    for (unsigned f = 0; f < RD_MAX_FILES; f++) {
+        if (w->map[f]) munmap(w->map[f], g_cfg.file_size);
+        if (w->fd[f] >= 0) close(w->fd[f]);
+    }
+    free(w->buf);
+    memset(w, 0, sizeof(*w));
+}
+
+static const char *size_str(size_t v, char *buf, size_t len) {
+    if (v % (1UL << 20) == 0) snprintf(buf, len, "%zuM", v >> 20);
+    else snprintf(buf, len, "%zuK", v >> 10);
+    return buf;
+}
+
+void read_work_report(const char *prog) {
+    if (!read_work_active()) return;
+    uint64_t workers = atomic_load(&g_tot->workers), reads = atomic_load(&g_tot->reads);
+    uint64_t t_span = atomic_load(&g_tot->t_last) - atomic_load(&g_tot->t_first);
+    if (!workers || !reads || !t_span) return;
+
+    double secs = (double)t_span / 1e9;
+    char lat[128], blk[24], fsz[24];
+    hist_format(&g_tot->lat, lat, sizeof(lat));
+
+    printf("%s io read=%s", prog, g_method_name[g_cfg.method]);
+    if (g_cfg.method == RD_URING) printf(" qd=%u", g_cfg.qd);
+    printf(" access=%s readahead=%s cache=%s block=%s files=%ux%s\n", g_cfg.random ? "rand" : "seq",
+           g_cfg.readahead ? "on" : "off", g_cfg.warm ? "warm" : "cold", size_str(g_cfg.block, blk, sizeof(blk)),
+           g_cfg.files, size_str(g_cfg.file_size, fsz, sizeof(fsz)));
+    printf("  workers=%llu reads=%llu MB/s=%.1f IOPS=%.0f%s\n", (unsigned long long)workers,
+           (unsigned long long)reads, (double)atomic_load(&g_tot->bytes) / 1e6 / secs, (double)reads / secs,
+           atomic_load(&g_tot->errors) ? "  (some workers had errors)" : "");
+    printf("  read latency: %s\n", lat);
+}
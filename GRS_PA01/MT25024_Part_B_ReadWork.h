@@ -0,0 +1,83 @@
+#ifndef READWORK_H
+#define READWORK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "MT25024_Part_B_Hist.h"
+#include "MT25024_Part_B_IoEngine.h"
+#include "MT25024_Part_B_Uring.h"
+
+// Read workload for io() (--read). A file set (--files x --file-size) is generated
+// before fork; every io() iteration then reads 256 KB of it in --block sized reads,
+// sequentially from a per-worker start block or at random blocks (--access).
+//
+//   pread    one pread per block
+//   mmap     the files are mapped; a block is read by touching each of its pages
+//   uring    IORING_OP_READ_FIXED, --qd reads in flight (buffered, not O_DIRECT,
+//            so the page cache and readahead still apply)
+//
+// --cache=cold (default): the set is dropped from the page cache with
+// posix_fadvise(DONTNEED) after it is written, and every block again right after it
+// is read, so each read misses unless readahead already fetched it.
+// --cache=warm: dropped once, later passes hit the cache.
+// --readahead=off uses POSIX_FADV_RANDOM / MADV_RANDOM; on uses SEQUENTIAL for
+// --access=seq and the kernel default for rand.
+//
+// Each worker reopens the files (through /proc/self/fd), so readahead state is
+// per worker even for forked children. The files are unlinked as soon as they are
+// open; nothing is left behind.
+#define RD_MAX_FILES 64
+
+typedef enum {
+    RD_OFF = 0,
+    RD_PREAD,
+    RD_MMAP,
+    RD_URING,
+    RD_COUNT
+} read_method_t;
+
+typedef struct {
+    read_method_t method;
+    int random;             // --access=rand
+    int readahead;          // --readahead=on (default)
+    int warm;               // --cache=warm
+    unsigned files;
+    size_t file_size;
+    size_t block;
+    unsigned qd;            // uring: reads in flight (--qd)
+} read_cfg_t;
+
+// Per-worker state (lives in worker_ctx_t)
+typedef struct {
+    int open;
+    int fd[RD_MAX_FILES];
+    char *map[RD_MAX_FILES];
+    char *buf;                  // pread: one block; uring: qd blocks
+    uring_t ring;
+    unsigned inflight;
+    unsigned free_slot[IO_MAX_QD], nfree;
+    uint64_t submit_ns[IO_MAX_QD], slot_blk[IO_MAX_QD];
+    uint64_t pos, rng;          // next block (seq) / xorshift state (rand)
+    uint64_t reads, bytes, sink;
+    uint64_t t_first, t_last;
+    hist_t lat;
+    int err;
+} read_worker_t;
+
+const char *read_method_name(int m);
+int read_method_parse(const char *s);       // -1 if unknown
+
+// Generate the file set and the shared totals; call before forking. 0, or -1 with a message.
+int read_work_set(const read_cfg_t *cfg);
+int read_work_active(void);
+
+// One io() iteration: 256 KB (at least one block) of reads. 0 or -1.
+int read_work_iter(read_worker_t *w);
+
+// Wait for what is in flight, add the counters to the shared totals, unmap and close
+void read_work_close(read_worker_t *w);
+
+// MB/s, IOPS and read latency percentiles over all workers
+void read_work_report(const char *prog);
+
+#endif
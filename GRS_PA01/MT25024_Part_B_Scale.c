@@ -0,0 +1,284 @@
+// scale_sweep: multi-core scaling driver for program_a and program_b.
+//
+// Usage: ./scale_sweep [--programs=a,b] [--work=cpu,mem,io] [--workers=1,2,4]
+//                      [--max-cpus=N] [--place=spread,smt] [--loops=N] [--csv=FILE]
+// For every program, workload and placement it runs the program with W workers
+// pinned from inside (--cpus) to the first C CPUs of the placement order, for
+// C = 1..N and every W, and prints wall time, throughput (worker iterations/s),
+// speedup over the first run (1 worker on 1 CPU unless --workers leaves out 1) and
+// efficiency (speedup / CPUs in use, i.e. min(W, C)).
+//   spread  one CPU per physical core first, SMT siblings only once every core is used
+//   smt     all SMT siblings of a core before the next core
+// Run from the directory with program_a and program_b (make scale builds all three).
+#define _GNU_SOURCE     // cpu_set_t, sched_getaffinity
+#include <fcntl.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define MAX_CPUS    1024
+#define MAX_LIST    64
+
+typedef struct {
+    int cpu, pkg, core, rank;   // rank: index among the SMT siblings of its core
+} cpu_info_t;
+
+typedef struct {
+    const char *items[MAX_LIST];
+    int n;
+} str_list_t;
+
+static cpu_info_t g_cpus[MAX_CPUS];
+static int g_ncpus = 0;
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static int read_int(const char *fmt, int cpu, int def) {
+    char path[128];
+    snprintf(path, sizeof(path), fmt, cpu);
+    FILE *fp = fopen(path, "r");
+    if (!fp) return def;
+    int v = def;
+    if (fscanf(fp, "%d", &v) != 1) v = def;
+    fclose(fp);
+    return v;
+}
+
+static int by_core(const void *a, const void *b) {
+    const cpu_info_t *x = (const cpu_info_t *)a, *y = (const cpu_info_t *)b;
+    if (x->pkg != y->pkg) return x->pkg - y->pkg;
+    if (x->core != y->core) return x->core - y->core;
+    return x->cpu - y->cpu;
+}
+
+static int by_rank(const void *a, const void *b) {
+    const cpu_info_t *x = (const cpu_info_t *)a, *y = (const cpu_info_t *)b;
+    if (x->rank != y->rank) return x->rank - y->rank;
+    return by_core(a, b);
+}
+
+// The CPUs this process may use, with their core and SMT sibling rank; returns the core count
+static int read_topology(void) {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        perror("sched_getaffinity failed");
+        return -1;
+    }
+    for (int c = 0; c < CPU_SETSIZE && g_ncpus < MAX_CPUS; c++) {
+        if (!CPU_ISSET(c, &allowed)) continue;
+        cpu_info_t *ci = &g_cpus[g_ncpus++];
+        ci->cpu = c;
+        ci->pkg = read_int("/sys/devices/system/cpu/cpu%d/topology/physical_package_id", c, 0);
+        ci->core = read_int("/sys/devices/system/cpu/cpu%d/topology/core_id", c, c);
+    }
+
+    qsort(g_cpus, (size_t)g_ncpus, sizeof(cpu_info_t), by_core);
+    int cores = 0;
+    for (int i = 0; i < g_ncpus; i++) {
+        int same = i > 0 && g_cpus[i].pkg == g_cpus[i - 1].pkg && g_cpus[i].core == g_cpus[i - 1].core;
+        g_cpus[i].rank = same ? g_cpus[i - 1].rank + 1 : 0;
+        if (!same) cores++;
+    }
+    return cores;
+}
+
+// CPU order for a placement: the first c entries are the CPU set of size c
+static void placement(const char *place, int *order) {
+    cpu_info_t tmp[MAX_CPUS];
+    memcpy(tmp, g_cpus, sizeof(cpu_info_t) * (size_t)g_ncpus);
+    qsort(tmp, (size_t)g_ncpus, sizeof(cpu_info_t), strcmp(place, "smt") == 0 ? by_core : by_rank);
+    for (int i = 0; i < g_ncpus; i++) order[i] = tmp[i].cpu;
+}
+
+static int split_list(char *s, str_list_t *out) {
+    out->n = 0;
+    for (char *tok = strtok(s, ","); tok; tok = strtok(NULL, ",")) {
+        if (out->n == MAX_LIST) return -1;
+        out->items[out->n++] = tok;
+    }
+    return out->n > 0 ? 0 : -1;
+}
+
+// Run one program to completion with stdout discarded; wall time in s, or -1
+static double run_prog(const char *prog, const char *work, int workers, long loops, const char *cpus) {
+    char path[64], nw[16], lp[32], cp[4200];
+    snprintf(path, sizeof(path), "./%s", prog);
+    snprintf(nw, sizeof(nw), "%d", workers);
+    snprintf(lp, sizeof(lp), "--loops=%ld", loops);
+    snprintf(cp, sizeof(cp), "--cpus=%s", cpus);
+    char *argv[] = { path, (char *)work, nw, lp, cp, NULL };
+
+    fflush(stdout);
+    double t0 = now_s();
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork failed");
+        return -1;
+    }
+    if (pid == 0) {
+        int fd = open("/dev/null", O_WRONLY);
+        if (fd >= 0) dup2(fd, STDOUT_FILENO);
+        execv(path, argv);
+        perror("execv failed");
+        _exit(127);
+    }
+    int status;
+    if (waitpid(pid, &status, 0) < 0) return -1;
+    double t = now_s() - t0;
+    return (WIFEXITED(status) && WEXITSTATUS(status) == 0) ? t : -1;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [--programs=a,b] [--work=cpu,mem,io] [--workers=1,2,4] [--max-cpus=N]\n"
+                    "       [--place=spread,smt] [--loops=N] [--csv=FILE]\n", prog);
+}
+
+int main(int argc, char *argv[]) {
+    char programs[64] = "a,b", works[64] = "cpu,mem,io", places[64] = "spread,smt", workers_s[256] = "";
+    long loops = 400;
+    int max_cpus = 0;
+    const char *csv = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        if (strncmp(a, "--programs=", 11) == 0) snprintf(programs, sizeof(programs), "%s", a + 11);
+        else if (strncmp(a, "--work=", 7) == 0) snprintf(works, sizeof(works), "%s", a + 7);
+        else if (strncmp(a, "--place=", 8) == 0) snprintf(places, sizeof(places), "%s", a + 8);
+        else if (strncmp(a, "--workers=", 10) == 0) snprintf(workers_s, sizeof(workers_s), "%s", a + 10);
+        else if (strncmp(a, "--max-cpus=", 11) == 0) max_cpus = atoi(a + 11);
+        else if (strncmp(a, "--loops=", 8) == 0) loops = atol(a + 8);
+        else if (strncmp(a, "--csv=", 6) == 0) csv = a + 6;
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (loops <= 0 || max_cpus < 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    int cores = read_topology();
+    if (cores < 0) return 1;
+    int smt = g_ncpus > cores;
+    int ncpu = (max_cpus > 0 && max_cpus < g_ncpus) ? max_cpus : g_ncpus;
+
+    // Worker counts: given, or 1, 2, 4, ... up to ncpu (and ncpu itself)
+    int wl[MAX_LIST], nw = 0;
+    if (workers_s[0]) {
+        str_list_t l;
+        if (split_list(workers_s, &l) != 0) {
+            usage(argv[0]);
+            return 1;
+        }
+        for (int i = 0; i < l.n; i++) {
+            wl[nw] = atoi(l.items[i]);
+            if (wl[nw] <= 0) {
+                fprintf(stderr, "Invalid worker count: %s\n", l.items[i]);
+                return 1;
+            }
+            nw++;
+        }
+    } else {
+        for (int w = 1; w < ncpu && nw < MAX_LIST - 1; w *= 2) wl[nw++] = w;
+        wl[nw++] = ncpu;
+    }
+
+    str_list_t pl, wk, pc;
+    if (split_list(programs, &pl) != 0 || split_list(works, &wk) != 0 || split_list(places, &pc) != 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    for (int i = 0; i < pl.n; i++) {
+        if (strcmp(pl.items[i], "a") != 0 && strcmp(pl.items[i], "b") != 0) {
+            fprintf(stderr, "Unknown program: %s (a|b)\n", pl.items[i]);
+            return 1;
+        }
+        char path[32];
+        snprintf(path, sizeof(path), "./program_%s", pl.items[i]);
+        if (access(path, X_OK) != 0) {
+            fprintf(stderr, "%s not found: build it with make first\n", path);
+            return 1;
+        }
+    }
+    for (int i = 0; i < pc.n; i++) {
+        if (strcmp(pc.items[i], "spread") != 0 && strcmp(pc.items[i], "smt") != 0) {
+            fprintf(stderr, "Unknown placement: %s (spread|smt)\n", pc.items[i]);
+            return 1;
+        }
+    }
+
+    FILE *out = NULL;
+    if (csv) {
+        out = fopen(csv, "w");
+        if (!out) {
+            perror("fopen failed for --csv");
+            return 1;
+        }
+        fprintf(out, "Program,Workload,Placement,CPUs,Workers,CPU_list,Time(s),Throughput(iter/s),Speedup,Efficiency\n");
+    }
+
+    printf("scale_sweep: %d CPUs on %d cores (%s), using 1..%d, %ld loops per worker\n",
+           g_ncpus, cores, smt ? "SMT" : "no SMT", ncpu, loops);
+
+    int order[MAX_CPUS];
+    int failed = 0;
+    for (int p = 0; p < pl.n; p++) {
+        char prog[16];
+        snprintf(prog, sizeof(prog), "program_%s", pl.items[p]);
+        for (int k = 0; k < wk.n; k++) {
+            for (int q = 0; q < pc.n; q++) {
+                const char *place = pc.items[q];
+                if (strcmp(place, "smt") == 0 && !smt) {
+                    printf("\n%s %s place=smt: no SMT siblings, same as spread (skipped)\n", prog, wk.items[k]);
+                    continue;
+                }
+                placement(place, order);
+                printf("\n%s %s place=%s\n", prog, wk.items[k], place);
+                printf("%6s %8s %10s %12s %8s %11s  %s\n", "cpus", "workers", "time_s", "iter/s",
+                       "speedup", "efficiency", "cpu_list");
+
+                double base = 0;        // throughput of the first run (1 worker on 1 CPU)
+                for (int c = 1; c <= ncpu; c++) {
+                    char list[4096] = "";
+                    size_t len = 0;
+                    for (int i = 0; i < c && len < sizeof(list) - 12; i++) {
+                        len += (size_t)snprintf(list + len, sizeof(list) - len, i ? ",%d" : "%d", order[i]);
+                    }
+                    for (int j = 0; j < nw; j++) {
+                        int w = wl[j];
+                        double t = run_prog(prog, wk.items[k], w, loops, list);
+                        if (t <= 0) {
+                            printf("%6d %8d  failed\n", c, w);
+                            failed = 1;
+                            continue;
+                        }
+                        double thr = (double)w * (double)loops / t;
+                        if (base == 0) base = thr;
+                        double sp = base > 0 ? thr / base : 0.0;
+                        double eff = sp / (double)(w < c ? w : c);
+                        printf("%6d %8d %10.3f %12.1f %8.2f %11.2f  %s\n", c, w, t, thr, sp, eff, list);
+                        if (out) {
+                            fprintf(out, "%s,%s,%s,%d,%d,\"%s\",%.4f,%.1f,%.3f,%.3f\n", prog, wk.items[k], place,
+                                    c, w, list, t, thr, sp, eff);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    if (out) {
+        fclose(out);
+        printf("\nscale_sweep: results saved to %s\n", csv);
+    }
+    return failed;
+}
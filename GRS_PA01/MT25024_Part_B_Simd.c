@@ -0,0 +1,282 @@
+#include "MT25024_Part_B_Simd.h"
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <immintrin.h>
+
+// Range reduction: x = q * pi/2 + r, pi/2 split into three 33-bit parts so that
+// q * PIO2_1 and q * PIO2_2 are exact for the j < 2^20 the workers use
+#define TWO_OVER_PI 6.36619772367581382433e-01
+#define PIO2_1      1.57079632673412561417e+00
+#define PIO2_2      6.07710050630396597660e-11
+#define PIO2_3      2.02226624871116645580e-21
+
+// sin(r) = r + r^3 * S(r^2), cos(r) = 1 - r^2/2 + r^4 * C(r^2) on [-pi/4, pi/4] (Cephes)
+#define S0  1.58962301576546568060e-10
+#define S1 -2.50507477628578072866e-08
+#define S2  2.75573136213857245213e-06
+#define S3 -1.98412698295895385996e-04
+#define S4  8.33333333332211858878e-03
+#define S5 -1.66666666666666307295e-01
+#define C0 -1.13585365213876817300e-11
+#define C1  2.08757008419747316778e-09
+#define C2 -2.75573141792967388112e-07
+#define C3  2.48015872888517045348e-05
+#define C4 -1.38888888888730564116e-03
+#define C5  4.16666666666665929218e-02
+
+static const char *g_isa_name[ISA_COUNT] = { "scalar", "sse2", "avx2", "avx512" };
+
+// The original loop body
+static double k_scalar(int n, double *out) {
+    double result = 0.0;
+    for (int j = 0; j < n; j++) {
+        double t = sin(j) * cos(j);
+        if (out) out[j] = t;
+        result += t;
+    }
+    return result;
+}
+
+// Polynomial sin(x) * cos(x) for one element: the vector kernels' tails
+static double poly_term(double x) {
+    double q = nearbyint(x * TWO_OVER_PI);
+    int64_t qi = (int64_t)q;
+    double r = ((x - q * PIO2_1) - q * PIO2_2) - q * PIO2_3;
+    double z = r * r;
+    double s = r + r * z * (((((S0 * z + S1) * z + S2) * z + S3) * z + S4) * z + S5);
+    double c = 1.0 - 0.5 * z + z * z * (((((C0 * z + C1) * z + C2) * z + C3) * z + C4) * z + C5);
+
+    if (qi & 1) {               // odd quadrant: sin and cos swap
+        double tmp = s;
+        s = c;
+        c = tmp;
+    }
+    if (qi & 2) s = -s;
+    if ((qi + 1) & 2) c = -c;
+    return s * c;
+}
+
+__attribute__((target("sse2")))
+static double k_sse2(int n, double *out) {
+    const __m128d two_over_pi = _mm_set1_pd(TWO_OVER_PI);
+    const __m128d p1 = _mm_set1_pd(PIO2_1), p2 = _mm_set1_pd(PIO2_2), p3 = _mm_set1_pd(PIO2_3);
+    const __m128d half = _mm_set1_pd(0.5), one_d = _mm_set1_pd(1.0);
+    const __m128d sign = _mm_set1_pd(-0.0);
+    const __m128i one = _mm_set1_epi32(1), two = _mm_set1_epi32(2);
+    __m128d acc = _mm_setzero_pd();
+    __m128d x = _mm_set_pd(1.0, 0.0);
+    const __m128d step = _mm_set1_pd(2.0);
+    int j = 0;
+
+    for (; j + 2 <= n; j += 2, x = _mm_add_pd(x, step)) {
+        __m128i qi = _mm_cvtpd_epi32(_mm_mul_pd(x, two_over_pi));     // round to nearest
+        __m128d q = _mm_cvtepi32_pd(qi);
+        __m128d r = _mm_sub_pd(x, _mm_mul_pd(q, p1));
+        r = _mm_sub_pd(r, _mm_mul_pd(q, p2));
+        r = _mm_sub_pd(r, _mm_mul_pd(q, p3));
+        __m128d z = _mm_mul_pd(r, r);
+
+        __m128d ps = _mm_set1_pd(S0);
+        ps = _mm_add_pd(_mm_mul_pd(ps, z), _mm_set1_pd(S1));
+        ps = _mm_add_pd(_mm_mul_pd(ps, z), _mm_set1_pd(S2));
+        ps = _mm_add_pd(_mm_mul_pd(ps, z), _mm_set1_pd(S3));
+        ps = _mm_add_pd(_mm_mul_pd(ps, z), _mm_set1_pd(S4));
+        ps = _mm_add_pd(_mm_mul_pd(ps, z), _mm_set1_pd(S5));
+        __m128d s = _mm_add_pd(r, _mm_mul_pd(_mm_mul_pd(r, z), ps));
+
+        __m128d pc = _mm_set1_pd(C0);
+        pc = _mm_add_pd(_mm_mul_pd(pc, z), _mm_set1_pd(C1));
+        pc = _mm_add_pd(_mm_mul_pd(pc, z), _mm_set1_pd(C2));
+        pc = _mm_add_pd(_mm_mul_pd(pc, z), _mm_set1_pd(C3));
+        pc = _mm_add_pd(_mm_mul_pd(pc, z), _mm_set1_pd(C4));
+        pc = _mm_add_pd(_mm_mul_pd(pc, z), _mm_set1_pd(C5));
+        __m128d c = _mm_add_pd(_mm_sub_pd(one_d, _mm_mul_pd(half, z)), _mm_mul_pd(_mm_mul_pd(z, z), pc));
+
+        // 32-bit quadrants widened to 64-bit lane masks
+        __m128i q64 = _mm_shuffle_epi32(qi, _MM_SHUFFLE(1, 1, 0, 0));
+        __m128d swap = _mm_castsi128_pd(_mm_cmpeq_epi32(_mm_and_si128(q64, one), one));
+        __m128d sneg = _mm_castsi128_pd(_mm_cmpeq_epi32(_mm_and_si128(q64, two), two));
+        __m128d cneg = _mm_castsi128_pd(_mm_cmpeq_epi32(_mm_and_si128(_mm_add_epi32(q64, one), two), two));
+
+        __m128d sv = _mm_or_pd(_mm_and_pd(swap, c), _mm_andnot_pd(swap, s));
+        __m128d cv = _mm_or_pd(_mm_and_pd(swap, s), _mm_andnot_pd(swap, c));
+        sv = _mm_xor_pd(sv, _mm_and_pd(sneg, sign));
+        cv = _mm_xor_pd(cv, _mm_and_pd(cneg, sign));
+
+        __m128d t = _mm_mul_pd(sv, cv);
+        if (out) _mm_storeu_pd(out + j, t);
+        acc = _mm_add_pd(acc, t);
+    }
+
+    double lanes[2];
+    _mm_storeu_pd(lanes, acc);
+    double result = lanes[0] + lanes[1];
+    for (; j < n; j++) {
+        double t = poly_term(j);
+        if (out) out[j] = t;
+        result += t;
+    }
+    return result;
+}
+
+__attribute__((target("avx2,fma")))
+static double k_avx2(int n, double *out) {
+    const __m256d two_over_pi = _mm256_set1_pd(TWO_OVER_PI);
+    const __m256d p1 = _mm256_set1_pd(PIO2_1), p2 = _mm256_set1_pd(PIO2_2), p3 = _mm256_set1_pd(PIO2_3);
+    const __m256d mhalf = _mm256_set1_pd(-0.5), one_d = _mm256_set1_pd(1.0);
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    const __m256i one = _mm256_set1_epi64x(1), two = _mm256_set1_epi64x(2);
+    __m256d acc = _mm256_setzero_pd();
+    __m256d x = _mm256_set_pd(3.0, 2.0, 1.0, 0.0);
+    const __m256d step = _mm256_set1_pd(4.0);
+    int j = 0;
+
+    for (; j + 4 <= n; j += 4, x = _mm256_add_pd(x, step)) {
+        __m256d q = _mm256_round_pd(_mm256_mul_pd(x, two_over_pi), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        __m256d r = _mm256_fnmadd_pd(q, p1, x);
+        r = _mm256_fnmadd_pd(q, p2, r);
+        r = _mm256_fnmadd_pd(q, p3, r);
+        __m256d z = _mm256_mul_pd(r, r);
+
+        __m256d ps = _mm256_set1_pd(S0);
+        ps = _mm256_fmadd_pd(ps, z, _mm256_set1_pd(S1));
+        ps = _mm256_fmadd_pd(ps, z, _mm256_set1_pd(S2));
+        ps = _mm256_fmadd_pd(ps, z, _mm256_set1_pd(S3));
+        ps = _mm256_fmadd_pd(ps, z, _mm256_set1_pd(S4));
+        ps = _mm256_fmadd_pd(ps, z, _mm256_set1_pd(S5));
+        __m256d s = _mm256_fmadd_pd(_mm256_mul_pd(r, z), ps, r);
+
+        __m256d pc = _mm256_set1_pd(C0);
+        pc = _mm256_fmadd_pd(pc, z, _mm256_set1_pd(C1));
+        pc = _mm256_fmadd_pd(pc, z, _mm256_set1_pd(C2));
+        pc = _mm256_fmadd_pd(pc, z, _mm256_set1_pd(C3));
+        pc = _mm256_fmadd_pd(pc, z, _mm256_set1_pd(C4));
+        pc = _mm256_fmadd_pd(pc, z, _mm256_set1_pd(C5));
+        __m256d c = _mm256_fmadd_pd(_mm256_mul_pd(z, z), pc, _mm256_fmadd_pd(mhalf, z, one_d));
+
+        __m256i qi = _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(q));
+        __m256d swap = _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(qi, one), one));
+        __m256d sneg = _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(qi, two), two));
+        __m256d cneg = _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(_mm256_add_epi64(qi, one), two), two));
+
+        __m256d sv = _mm256_blendv_pd(s, c, swap);
+        __m256d cv = _mm256_blendv_pd(c, s, swap);
+        sv = _mm256_xor_pd(sv, _mm256_and_pd(sneg, sign));
+        cv = _mm256_xor_pd(cv, _mm256_and_pd(cneg, sign));
+
+        __m256d t = _mm256_mul_pd(sv, cv);
+        if (out) _mm256_storeu_pd(out + j, t);
+        acc = _mm256_add_pd(acc, t);
+    }
+
+    double lanes[4];
+    _mm256_storeu_pd(lanes, acc);
+    double result = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for (; j < n; j++) {
+        double t = poly_term(j);
+        if (out) out[j] = t;
+        result += t;
+    }
+    return result;
+}
+
+__attribute__((target("avx512f")))
+static double k_avx512(int n, double *out) {
+    const __m512d two_over_pi = _mm512_set1_pd(TWO_OVER_PI);
+    const __m512d p1 = _mm512_set1_pd(PIO2_1), p2 = _mm512_set1_pd(PIO2_2), p3 = _mm512_set1_pd(PIO2_3);
+    const __m512d mhalf = _mm512_set1_pd(-0.5), one_d = _mm512_set1_pd(1.0);
+    const __m512d zero = _mm512_setzero_pd();
+    const __m512i one = _mm512_set1_epi64(1), two = _mm512_set1_epi64(2);
+    __m512d acc = _mm512_setzero_pd();
+    __m512d x = _mm512_set_pd(7.0, 6.0, 5.0, 4.0, 3.0, 2.0, 1.0, 0.0);
+    const __m512d step = _mm512_set1_pd(8.0);
+    int j = 0;
+
+    for (; j + 8 <= n; j += 8, x = _mm512_add_pd(x, step)) {
+        __m512d q = _mm512_roundscale_pd(_mm512_mul_pd(x, two_over_pi), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        __m512d r = _mm512_fnmadd_pd(q, p1, x);
+        r = _mm512_fnmadd_pd(q, p2, r);
+        r = _mm512_fnmadd_pd(q, p3, r);
+        __m512d z = _mm512_mul_pd(r, r);
+
+        __m512d ps = _mm512_set1_pd(S0);
+        ps = _mm512_fmadd_pd(ps, z, _mm512_set1_pd(S1));
+        ps = _mm512_fmadd_pd(ps, z, _mm512_set1_pd(S2));
+        ps = _mm512_fmadd_pd(ps, z, _mm512_set1_pd(S3));
+        ps = _mm512_fmadd_pd(ps, z, _mm512_set1_pd(S4));
+        ps = _mm512_fmadd_pd(ps, z, _mm512_set1_pd(S5));
+        __m512d s = _mm512_fmadd_pd(_mm512_mul_pd(r, z), ps, r);
+
+        __m512d pc = _mm512_set1_pd(C0);
+        pc = _mm512_fmadd_pd(pc, z, _mm512_set1_pd(C1));
+        pc = _mm512_fmadd_pd(pc, z, _mm512_set1_pd(C2));
+        pc = _mm512_fmadd_pd(pc, z, _mm512_set1_pd(C3));
+        pc = _mm512_fmadd_pd(pc, z, _mm512_set1_pd(C4));
+        pc = _mm512_fmadd_pd(pc, z, _mm512_set1_pd(C5));
+        __m512d c = _mm512_fmadd_pd(_mm512_mul_pd(z, z), pc, _mm512_fmadd_pd(mhalf, z, one_d));
+
+        // AVX-512F has no double xor, so the signs are flipped with masked 0 - v
+        __m512i qi = _mm512_cvtepi32_epi64(_mm512_cvtpd_epi32(q));
+        __mmask8 swap = _mm512_test_epi64_mask(qi, one);
+        __mmask8 sneg = _mm512_test_epi64_mask(qi, two);
+        __mmask8 cneg = _mm512_test_epi64_mask(_mm512_add_epi64(qi, one), two);
+
+        __m512d sv = _mm512_mask_blend_pd(swap, s, c);
+        __m512d cv = _mm512_mask_blend_pd(swap, c, s);
+        sv = _mm512_mask_sub_pd(sv, sneg, zero, sv);
+        cv = _mm512_mask_sub_pd(cv, cneg, zero, cv);
+
+        __m512d t = _mm512_mul_pd(sv, cv);
+        if (out) _mm512_storeu_pd(out + j, t);
+        acc = _mm512_add_pd(acc, t);
+    }
+
+    double result = _mm512_reduce_add_pd(acc);
+    for (; j < n; j++) {
+        double t = poly_term(j);
+        if (out) out[j] = t;
+        result += t;
+    }
+    return result;
+}
+
+static const sincos_kernel_t g_kernel[ISA_COUNT] = { k_scalar, k_sse2, k_avx2, k_avx512 };
+
+const char *isa_name(int isa) {
+    if (isa == ISA_AUTO) return "auto";
+    return (isa >= 0 && isa < ISA_COUNT) ? g_isa_name[isa] : "?";
+}
+
+int isa_parse(const char *s) {
+    if (strcmp(s, "auto") == 0) return ISA_AUTO;
+    for (int i = 0; i < ISA_COUNT; i++) {
+        if (strcmp(s, g_isa_name[i]) == 0) return i;
+    }
+    return -2;
+}
+
+// __builtin_cpu_supports reads CPUID (and XCR0 for the AVX state) once at startup
+int isa_supported(int isa) {
+    __builtin_cpu_init();
+    switch (isa) {
+    case ISA_SCALAR: return 1;
+    case ISA_SSE2:   return __builtin_cpu_supports("sse2");
+    case ISA_AVX2:   return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case ISA_AVX512: return __builtin_cpu_supports("avx512f");
+    default:         return 0;
+    }
+}
+
+int isa_best(void) {
+    for (int i = ISA_COUNT - 1; i > ISA_SCALAR; i--) {
+        if (isa_supported(i)) return i;
+    }
+    return ISA_SCALAR;
+}
+
+sincos_kernel_t isa_kernel(int isa) {
+    if (isa == ISA_AUTO) isa = isa_best();
+    if (isa < 0 || isa >= ISA_COUNT || !isa_supported(isa)) return NULL;
+    return g_kernel[isa];
+}
@@ -0,0 +1,33 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+// Alternative kernels for the cpu() worker: sum of sin(j) * cos(j) over j = 0 .. n-1.
+//
+// ISA_SCALAR is the reference (libm sin/cos, the original cpu() loop). The SIMD
+// kernels evaluate sin and cos with the same polynomials for every ISA: reduction
+// by pi/2 in three parts (Cody-Waite), minimax polynomials on [-pi/4, pi/4], and
+// the quadrant picks sin/cos and the signs. Each one is built with a gcc target
+// attribute, so the Makefile needs no -m flags, and is only used if CPUID says the
+// CPU (and OS) support it.
+enum {
+    ISA_SCALAR = 0,
+    ISA_SSE2,
+    ISA_AVX2,       // AVX2 + FMA
+    ISA_AVX512,     // AVX-512F
+    ISA_COUNT
+};
+#define ISA_AUTO (-1)
+
+// Largest acceptable |kernel - libm| for one sin(j)*cos(j) term
+#define SIMD_TOL 1e-12
+
+// Sum over j < n; if out is not NULL, also stores every term in out[j]
+typedef double (*sincos_kernel_t)(int n, double *out);
+
+const char *isa_name(int isa);
+int isa_parse(const char *s);           // name or "auto"; -2 if unknown
+int isa_supported(int isa);
+int isa_best(void);                     // widest supported ISA
+sincos_kernel_t isa_kernel(int isa);    // NULL if not supported
+
+#endif
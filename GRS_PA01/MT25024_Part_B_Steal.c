@@ -0,0 +1,221 @@
+#include "MT25024_Part_B_Steal.h"
+#include "MT25024_Part_B_Workers.h"
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sched.h>
+#include <time.h>
+#include <sys/mman.h>
+
+#define CACHE_LINE 64
+
+static const char *kind_name[WORK_KINDS] = { "cpu", "mem", "io" };
+
+// The owner updates its stats on every task, so they get their own line: on the
+// deque ends' line each update would take it away from the thieves' loads and CAS
+// of top. Stats are read once the run is over.
+typedef struct {
+    _Atomic int64_t top;        // thieves take from here (CAS)
+    _Atomic int64_t bottom;     // owner pops from here
+    int kind;                   // static share: kind of this worker's tasks
+    int err __attribute__((aligned(CACHE_LINE)));
+    uint64_t executed, stolen, failed_steals;
+    uint64_t busy_ns, finish_ns;
+} __attribute__((aligned(CACHE_LINE))) deque_t;
+
+struct steal_rt {
+    size_t map_len;
+    int workers;
+    int kind;
+    int steal;                  // 0 = static split only
+    size_t loops;               // tasks per deque (capacity)
+    _Atomic int64_t remaining __attribute__((aligned(CACHE_LINE)));
+    _Atomic int ready;
+    _Atomic int go;
+    uint64_t t0_ns;             // set by the last worker through the start barrier
+    deque_t *dq;                // == (deque_t *)(rt + 1), same address after fork
+    uint64_t *tasks;            // workers * loops slots
+};
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Task word: kind in the high half, iteration number in the low half
+static inline uint64_t task_make(int kind, size_t iter) {
+    return ((uint64_t)kind << 32) | (uint32_t)iter;
+}
+
+steal_rt_t *steal_create(int workers, int kind, size_t loops) {
+    if (workers < 1 || loops == 0 || loops > UINT32_MAX) return NULL;
+
+    size_t head = (sizeof(steal_rt_t) + CACHE_LINE - 1) & ~(size_t)(CACHE_LINE - 1);
+    size_t len = head + (size_t)workers * sizeof(deque_t) + (size_t)workers * loops * sizeof(uint64_t);
+    void *p = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+        perror("mmap failed in steal_create()");
+        return NULL;
+    }
+
+    steal_rt_t *rt = (steal_rt_t *)p;
+    rt->map_len = len;
+    rt->workers = workers;
+    rt->kind = kind;
+    rt->loops = loops;
+    rt->dq = (deque_t *)((char *)p + head);
+    rt->tasks = (uint64_t *)(rt->dq + workers);
+    steal_reset(rt, 1);
+    return rt;
+}
+
+void steal_destroy(steal_rt_t *rt) {
+    if (rt) munmap(rt, rt->map_len);
+}
+
+void steal_reset(steal_rt_t *rt, int steal) {
+    rt->steal = steal;
+    for (int i = 0; i < rt->workers; i++) {
+        deque_t *d = &rt->dq[i];
+        int kind = (rt->kind == WORK_MIX) ? i % WORK_KINDS : rt->kind;
+        uint64_t *slot = rt->tasks + (size_t)i * rt->loops;
+
+        // Pushed in reverse so the owner pops iteration 0 first, like the plain loop
+        for (size_t k = 0; k < rt->loops; k++) {
+            slot[k] = task_make(kind, rt->loops - 1 - k);
+        }
+        d->kind = kind;
+        d->err = 0;
+        d->executed = d->stolen = d->failed_steals = 0;
+        d->busy_ns = d->finish_ns = 0;
+        atomic_store(&d->top, 0);
+        atomic_store(&d->bottom, (int64_t)rt->loops);
+    }
+    atomic_store(&rt->remaining, (int64_t)rt->workers * (int64_t)rt->loops);
+    atomic_store(&rt->ready, 0);
+    atomic_store(&rt->go, 0);
+    rt->t0_ns = 0;
+}
+
+// Owner end (Chase-Lev take). Nothing is pushed during a run, so no resizing.
+static int dq_take(steal_rt_t *rt, int id, uint64_t *task) {
+    deque_t *d = &rt->dq[id];
+    int64_t b = atomic_load_explicit(&d->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&d->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t t = atomic_load_explicit(&d->top, memory_order_relaxed);
+
+    if (t > b) {                                    // empty
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+        return 0;
+    }
+    *task = rt->tasks[(size_t)id * rt->loops + (size_t)b];
+    if (t == b) {                                   // last task: race the thieves for it
+        int won = atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1,
+                                                          memory_order_seq_cst, memory_order_relaxed);
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+        return won;
+    }
+    return 1;
+}
+
+// Thief end
+static int dq_steal(steal_rt_t *rt, int victim, uint64_t *task) {
+    deque_t *d = &rt->dq[victim];
+    int64_t t = atomic_load_explicit(&d->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t b = atomic_load_explicit(&d->bottom, memory_order_acquire);
+
+    if (t >= b) return 0;
+    *task = rt->tasks[(size_t)victim * rt->loops + (size_t)t];
+    return atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1,
+                                                   memory_order_seq_cst, memory_order_relaxed);
+}
+
+static void run_task(steal_rt_t *rt, deque_t *d, worker_ctx_t *w, uint64_t task) {
+    uint64_t s = now_ns();
+    if (work_iter(w, (int)(task >> 32), (size_t)(uint32_t)task) != 0) d->err = 1;
+    d->busy_ns += now_ns() - s;
+    d->executed++;
+    atomic_fetch_sub_explicit(&rt->remaining, 1, memory_order_release);
+}
+
+static void start_barrier(steal_rt_t *rt) {
+    if (atomic_fetch_add(&rt->ready, 1) + 1 == rt->workers) {
+        rt->t0_ns = now_ns();
+        atomic_store_explicit(&rt->go, 1, memory_order_release);
+        return;
+    }
+    while (!atomic_load_explicit(&rt->go, memory_order_acquire)) {
+        sched_yield();      // with taskset -c 0 the last worker needs the CPU
+    }
+}
+
+int steal_worker(steal_rt_t *rt, int id) {
+    deque_t *d = &rt->dq[id];
+    worker_ctx_t w;
+    worker_ctx_init(&w);
+    uint32_t seed = (uint32_t)id * 2654435761u + 1u;
+    uint64_t task;
+
+    start_barrier(rt);
+
+    for (;;) {
+        if (dq_take(rt, id, &task)) {
+            run_task(rt, d, &w, task);
+            continue;
+        }
+        if (!rt->steal || rt->workers == 1) break;
+        if (atomic_load_explicit(&rt->remaining, memory_order_acquire) == 0) break;
+
+        // One pass over random victims, then give the CPU away
+        int got = 0;
+        for (int k = 0; k < rt->workers && !got; k++) {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            int v = (int)(seed % (uint32_t)(rt->workers - 1));
+            if (v >= id) v++;                       // never ourselves
+            if (dq_steal(rt, v, &task)) {
+                d->stolen++;
+                run_task(rt, d, &w, task);
+                got = 1;
+            } else {
+                d->failed_steals++;
+            }
+        }
+        if (!got) sched_yield();
+    }
+
+    d->finish_ns = now_ns() - rt->t0_ns;
+    worker_ctx_free(&w);
+    return d->err ? -1 : 0;
+}
+
+double steal_report(const steal_rt_t *rt, const char *prog) {
+    uint64_t total = 0, stolen = 0, max_ns = 0, sum_ns = 0;
+    for (int i = 0; i < rt->workers; i++) {
+        const deque_t *d = &rt->dq[i];
+        total += d->executed;
+        stolen += d->stolen;
+        sum_ns += d->finish_ns;
+        if (d->finish_ns > max_ns) max_ns = d->finish_ns;
+    }
+    double makespan = (double)max_ns / 1e9;
+    double mean = (double)sum_ns / 1e9 / rt->workers;
+
+    printf("%s [%s]: workers=%d tasks=%llu makespan=%.3f s stolen=%llu (%.1f%%) imbalance=%.2f\n",
+           prog, rt->steal ? "steal" : "static", rt->workers, (unsigned long long)total, makespan,
+           (unsigned long long)stolen, total ? 100.0 * (double)stolen / (double)total : 0.0,
+           mean > 0 ? makespan / mean : 1.0);
+    for (int i = 0; i < rt->workers; i++) {
+        const deque_t *d = &rt->dq[i];
+        printf("  worker %d (%s): executed=%llu stolen=%llu failed_steals=%llu busy=%.3f s finish=%.3f s%s\n",
+               i, kind_name[d->kind], (unsigned long long)d->executed, (unsigned long long)d->stolen,
+               (unsigned long long)d->failed_steals, (double)d->busy_ns / 1e9, (double)d->finish_ns / 1e9,
+               d->err ? " (errors)" : "");
+    }
+    return makespan;
+}
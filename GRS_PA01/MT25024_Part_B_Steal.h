@@ -0,0 +1,29 @@
+#ifndef STEAL_H
+#define STEAL_H
+
+#include <stddef.h>
+
+// Work-stealing task runtime for the workers (--sched=static|steal|compare).
+//
+// Every loop iteration of cpu()/mem()/io() is one task. Before a run each worker's
+// deque is filled with its static share (loops tasks of its kind), exactly what
+// the plain programs do. A worker pops from the bottom of its own deque; with
+// stealing on, an idle worker takes tasks from the top of a random victim's deque
+// (Chase-Lev). The whole runtime sits in one MAP_SHARED mapping and uses indices
+// only, so it works for forked children (Program A) as well as threads (Program B).
+typedef struct steal_rt steal_rt_t;
+
+// kind is WORK_CPU/MEM/IO, or WORK_MIX (worker i gets kind i % 3); NULL on error
+steal_rt_t *steal_create(int workers, int kind, size_t loops);
+void steal_destroy(steal_rt_t *rt);
+
+// Refill the deques with the static split and clear the stats
+void steal_reset(steal_rt_t *rt, int steal);
+
+// Body of worker id; returns once every task of the run is done. 0 or -1.
+int steal_worker(steal_rt_t *rt, int id);
+
+// Per-worker executed/stolen counts and the makespan; returns the makespan (s)
+double steal_report(const steal_rt_t *rt, const char *prog);
+
+#endif
@@ -0,0 +1,94 @@
+#include "MT25024_Part_B_Strong.h"
+#include "MT25024_Part_B_Workers.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+static int g_kind = WORK_CPU;
+static size_t g_loops = LOOP_COUNT;
+static char *g_mem = NULL;             // shared mem() buffer (MAP_SHARED for Program A)
+
+int strong_setup(int kind, size_t loops) {
+    g_kind = kind;
+    g_loops = loops;
+    if (kind != WORK_MEM) return 0;
+
+    void *p = mmap(NULL, MEM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+        perror("mmap failed in strong_setup()");
+        return -1;
+    }
+    g_mem = (char *)p;
+    memset(g_mem, 1, MEM_SIZE);
+    return 0;
+}
+
+void strong_cleanup(void) {
+    if (g_mem) munmap(g_mem, MEM_SIZE);
+    g_mem = NULL;
+}
+
+// [lo, hi) of total items for worker i of n; the first total % n workers get one more
+static void split(size_t total, int n, int i, size_t *lo, size_t *hi) {
+    size_t base = total / (size_t)n, extra = total % (size_t)n;
+    *lo = (size_t)i * base + ((size_t)i < extra ? (size_t)i : extra);
+    *hi = *lo + base + ((size_t)i < extra ? 1 : 0);
+}
+
+int strong_worker(int i, int n) {
+    size_t lo, hi;
+
+    if (g_kind == WORK_MEM) {
+        // split in cache lines so no two workers write the same line
+        split(MEM_SIZE / MEM_STRIDE, n, i, &lo, &hi);
+        if (lo == hi) return 0;
+        for (size_t iter = 0; iter < g_loops; iter++) {
+            mem_sweep(g_mem, lo * MEM_STRIDE, hi * MEM_STRIDE, iter);
+        }
+        return 0;
+    }
+
+    worker_ctx_t w;
+    int rc = 0;
+    worker_ctx_init(&w);
+    split(g_loops, n, i, &lo, &hi);
+    for (size_t iter = lo; iter < hi && rc == 0; iter++) {
+        rc = work_iter(&w, g_kind, iter);
+    }
+    worker_ctx_free(&w);
+    return rc;
+}
+
+void strong_sweep(const char *prog, int max_workers, strong_run_t run) {
+    double t[max_workers + 1];
+
+    printf("%s strong scaling: %zu iterations in total, 1..%d workers\n", prog, g_loops, max_workers);
+    printf("%8s %10s %8s %11s %11s\n", "workers", "time_s", "speedup", "efficiency", "karp_flatt");
+    for (int n = 1; n <= max_workers; n++) {
+        t[n] = run(n);
+        double sp = t[n] > 0 ? t[1] / t[n] : 0.0;
+        if (n == 1) {
+            printf("%8d %10.4f %8.2f %11.2f %11s\n", n, t[n], sp, sp / n, "-");
+        } else {
+            // experimentally determined serial fraction (1/S - 1/n) / (1 - 1/n)
+            double kf = (1.0 / sp - 1.0 / n) / (1.0 - 1.0 / n);
+            printf("%8d %10.4f %8.2f %11.2f %11.3f\n", n, t[n], sp, sp / n, kf);
+        }
+    }
+
+    // Amdahl: T(n)/T(1) = f + (1 - f)/n, i.e. y - 1/n = f * (1 - 1/n); least squares for f
+    if (max_workers < 2) return;
+    double num = 0, den = 0;
+    for (int n = 2; n <= max_workers; n++) {
+        double y = t[n] / t[1], a = 1.0 - 1.0 / n;
+        num += (y - 1.0 / n) * a;
+        den += a * a;
+    }
+    double f = num / den;
+    if (f > 0) {
+        printf("%s: Amdahl serial fraction f = %.3f (max speedup 1/f = %.1f)\n", prog, f, 1.0 / f);
+    } else {
+        printf("%s: Amdahl serial fraction f = %.3f (no serial part visible)\n", prog, f);
+    }
+}
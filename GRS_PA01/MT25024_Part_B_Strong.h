@@ -0,0 +1,29 @@
+#ifndef STRONG_H
+#define STRONG_H
+
+#include <stddef.h>
+
+// Strong scaling (--strong): one fixed amount of work, split across n workers.
+//   cpu  the loops iterations are cut into n contiguous ranges (parallel for)
+//   mem  loops passes over ONE shared 50 MB buffer; worker i sweeps its own
+//        1/n of it (cache-line aligned) in every pass
+//   io   the loops 256 KB writes are sharded: worker i does its range of them
+//        into its own file, fsync every 10th write of the whole run as before
+// The sweep runs n = 1 .. max workers and reports speedup T(1)/T(n), efficiency
+// speedup/n, the Karp-Flatt serial fraction per n and a least-squares Amdahl fit.
+
+// Set up the shared state (mem buffer in a MAP_SHARED mapping, touched once here
+// so no worker pays the first touch); call before forking. 0 or -1.
+int strong_setup(int kind, size_t loops);
+void strong_cleanup(void);
+
+// Body of worker i out of n. 0 or -1.
+int strong_worker(int i, int n);
+
+// Runs n workers (children or threads) to completion; returns the wall time in s
+typedef double (*strong_run_t)(int n);
+
+// Measure n = 1 .. max_workers with run() and print the table and the fit
+void strong_sweep(const char *prog, int max_workers, strong_run_t run);
+
+#endif
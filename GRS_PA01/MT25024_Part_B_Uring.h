@@ -0,0 +1,41 @@
+#ifndef URING_H
+#define URING_H
+
+#include <stddef.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+
+// Minimal io_uring on raw syscalls (no liburing): one ring per worker, used by
+// the io engines (--io-engine=uring) and the read workload (--read-method=uring).
+typedef struct {
+    int fd;
+    unsigned entries;
+    // submission ring
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    struct io_uring_sqe *sqes;
+    unsigned sq_local;          // tail including SQEs not yet handed to the kernel
+    unsigned sq_flushed;        // tail the kernel has seen
+    // completion ring
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_cqe *cqes;
+    // mappings
+    void *sq_ptr, *cq_ptr;
+    size_t sq_len, cq_len, sqe_len;
+} uring_t;
+
+// 0, or -errno (e.g. -ENOSYS / -EPERM where io_uring is disabled)
+int uring_init(uring_t *r, unsigned entries);
+void uring_exit(uring_t *r);
+int uring_register_buffers(uring_t *r, const struct iovec *iov, unsigned n);
+
+// Next free SQE (zeroed), or NULL if the ring is full
+struct io_uring_sqe *uring_get_sqe(uring_t *r);
+
+// Hand the queued SQEs to the kernel and wait for at least wait_nr completions
+int uring_submit(uring_t *r, unsigned wait_nr);
+
+// Oldest completion or NULL; uring_cqe_seen() releases it
+struct io_uring_cqe *uring_peek_cqe(uring_t *r);
+void uring_cqe_seen(uring_t *r);
+
+#endif
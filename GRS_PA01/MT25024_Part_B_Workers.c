@@ -1,4 +1,5 @@
 #include "MT25024_Part_B_Workers.h"
+#include "MT25024_Part_B_Simd.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -6,80 +7,165 @@
 #include <math.h>
 #include <pthread.h>
 
-// 1. CPU Task
-void cpu(size_t n) {
-    for (size_t i = 0; i < n; i++) {
-        double result = 0.0;
-        for (int j = 0; j < 1000; j++) {
-            result += sin(j) * cos(j);
-        }
-        (void)result; // prevent optimization
+#define CPU_TERMS   1000
+
+static sincos_kernel_t g_cpu_kernel = NULL;    // NULL = the libm loop below (--isa)
+static volatile double g_cpu_sink;             // keeps -O2 from dropping the result
+
+int cpu_set_isa(int isa) {
+    if (isa == ISA_SCALAR) {
+        g_cpu_kernel = NULL;
+        return 0;
     }
+    sincos_kernel_t k = isa_kernel(isa);
+    if (!k) return -1;
+    g_cpu_kernel = k;
+    return 0;
 }
 
-// 2. Memory Task (allocate once, touch memory repeatedly)
-void mem(size_t n) {
-    const size_t size = 50UL * 1024UL * 1024UL; // 50MB
-    const size_t stride = 64;                  // cache-line stride
+int work_kind(const char *name) {
+    if (strcmp(name, "cpu") == 0) return WORK_CPU;
+    if (strcmp(name, "mem") == 0) return WORK_MEM;
+    if (strcmp(name, "io") == 0) return WORK_IO;
+    if (strcmp(name, "mix") == 0) return WORK_MIX;
+    return -1;
+}
+
+void worker_ctx_init(worker_ctx_t *w) {
+    memset(w, 0, sizeof(*w));
+}
+
+void worker_ctx_free(worker_ctx_t *w) {
+    membuf_stats_flush(&w->mb);
+    membuf_free(w->mem_buf, MEM_SIZE);
+    mem_pattern_free(&w->mp);
+    io_engine_close(&w->ioe);
+    group_commit_close(&w->gc);
+    read_work_close(&w->rd);
+    if (w->io_name[0]) remove(w->io_name);
+    free(w->io_buf);
+    worker_ctx_init(w);
+}
 
-    char *buffer = (char *)malloc(size);
-    if (!buffer) {
-        perror("malloc failed in mem()");
+// 1. CPU Task
+void cpu_iter(void) {
+    if (g_cpu_kernel) {
+        g_cpu_sink = g_cpu_kernel(CPU_TERMS, NULL);
         return;
     }
 
-    // First-touch to ensure pages are mapped
-    memset(buffer, 1, size);
+    double result = 0.0;
+    for (int j = 0; j < CPU_TERMS; j++) {
+        result += sin(j) * cos(j);
+    }
+    g_cpu_sink = result; // prevent optimization
+}
 
-    for (size_t iter = 0; iter < n; iter++) {
-        for (size_t off = 0; off < size; off += stride) {
-            buffer[off] ^= (char)(iter & 0xFF);
-        }
+void cpu(size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        cpu_iter();
+    }
+}
+
+// 2. Memory Task (allocate once, touch memory repeatedly)
+int mem_iter(worker_ctx_t *w, size_t iter) {
+    if (mem_pattern_get()) {
+        return mem_pattern_pass(&w->mp, iter);
+    }
 
-        // Prevent compiler from optimizing loop away
-        volatile char sink = buffer[(iter * 4096) % size];
-        (void)sink;
+    if (!w->mem_buf) {
+        // malloc + first touch, or the --pages / --mem-shared mapping
+        w->mem_buf = membuf_alloc(&w->mb, MEM_SIZE);
+        if (!w->mem_buf) return -1;
     }
 
-    free(buffer);
+    membuf_sweep_begin(&w->mb);
+    mem_sweep(w->mem_buf, 0, MEM_SIZE, iter);
+    membuf_sweep_end(&w->mb);
+    return 0;
 }
 
-// 3. IO Task
-void io(size_t n) {
-    char filename[64];
+void mem_sweep(char *buffer, size_t lo, size_t hi, size_t iter) {
+    for (size_t off = lo; off < hi; off += MEM_STRIDE) {
+        buffer[off] ^= (char)(iter & 0xFF);
+    }
 
-    // Unique filename per thread
-    snprintf(filename, sizeof(filename),
-             "io_test_%lu.bin", (unsigned long)pthread_self());
+    // Prevent compiler from optimizing loop away
+    volatile char sink = buffer[lo + (iter * 4096) % (hi - lo)];
+    (void)sink;
+}
 
-    const size_t BUF_SIZE = 256UL * 1024UL;
-    const size_t FSYNC_EVERY = 10;
+void mem(size_t n) {
+    worker_ctx_t w;
+    worker_ctx_init(&w);
+    for (size_t iter = 0; iter < n; iter++) {
+        if (mem_iter(&w, iter) != 0) break;
+    }
+    worker_ctx_free(&w);
+}
 
-    char *buf = (char *)malloc(BUF_SIZE);
-    if (!buf) {
-        perror("malloc failed in io()");
-        return;
+// 3. IO Task
+int io_iter(worker_ctx_t *w, size_t i) {
+    if (read_work_active()) {
+        return read_work_iter(&w->rd);          // the generated file set, read instead of written
+    }
+    if (group_commit_active()) {
+        return group_commit_iter(&w->gc, i);    // shared log instead of a file per worker
+    }
+    if (!w->io_name[0]) {
+        // Unique filename per worker: pid for forked children (which all inherit
+        // the same pthread_self() value), thread id for threads
+        snprintf(w->io_name, sizeof(w->io_name),
+                 "io_test_%ld_%lu.bin", (long)getpid(), (unsigned long)pthread_self());
+    }
+    if (io_engine_kind() != IOE_STDIO) {
+        return io_engine_write(&w->ioe, w->io_name, i);
     }
-    memset(buf, 'A', BUF_SIZE);
 
-    for (size_t i = 0; i < n; i++) {
-        FILE *fp = fopen(filename, "wb");
-        if (!fp) {
-            perror("fopen failed in io()");
-            break;
+    if (!w->io_buf) {
+        w->io_buf = (char *)malloc(IO_BUF_SIZE);
+        if (!w->io_buf) {
+            perror("malloc failed in io()");
+            return -1;
         }
+        memset(w->io_buf, 'A', IO_BUF_SIZE);
+    }
 
-        fwrite(buf, 1, BUF_SIZE, fp);
+    uint64_t t0 = io_engine_active() ? io_now_ns() : 0, fsync_ns = 0;
+    FILE *fp = fopen(w->io_name, "wb");
+    if (!fp) {
+        perror("fopen failed in io()");
+        return -1;
+    }
 
-        if ((i % FSYNC_EVERY) == 0) {
-            fflush(fp);
-            fsync(fileno(fp));
-        }
+    fwrite(w->io_buf, 1, IO_BUF_SIZE, fp);
 
-        fclose(fp);
+    if ((i % FSYNC_EVERY) == 0) {
+        fflush(fp);
+        uint64_t f0 = t0 ? io_now_ns() : 0;
+        fsync(fileno(fp));
+        if (t0) fsync_ns = io_now_ns() - f0;
     }
 
-    remove(filename);
-    free(buf);
+    fclose(fp);
+    if (t0) io_engine_note(&w->ioe, t0, io_now_ns(), (i % FSYNC_EVERY) == 0, fsync_ns);
+    return 0;
+}
+
+void io(size_t n) {
+    worker_ctx_t w;
+    worker_ctx_init(&w);
+    for (size_t i = 0; i < n; i++) {
+        if (io_iter(&w, i) != 0) break;
+    }
+    worker_ctx_free(&w);
 }
 
+int work_iter(worker_ctx_t *w, int kind, size_t iter) {
+    switch (kind) {
+    case WORK_CPU: cpu_iter(); return 0;
+    case WORK_MEM: return mem_iter(w, iter);
+    case WORK_IO:  return io_iter(w, iter);
+    default:       return -1;
+    }
+}
@@ -1,15 +1,59 @@
 #ifndef WORKERS_H
 #define WORKERS_H
 
-#include <stddef.h> 
+#include <stddef.h>
+#include "MT25024_Part_B_MemPattern.h"
+#include "MT25024_Part_B_IoEngine.h"
+#include "MT25024_Part_B_GroupCommit.h"
+#include "MT25024_Part_B_ReadWork.h"
 
 // ROLL NO IS MT25024 -> Last digit is 4.
 // Assignment says: Last digit * 1000.
 // So your loop count is 4000.
-#define LOOP_COUNT 4000 
+#define LOOP_COUNT 4000
+
+#define MEM_SIZE    (50UL * 1024UL * 1024UL) // mem(): 50MB buffer
+#define MEM_STRIDE  64                       // cache-line stride
+#define IO_BUF_SIZE (256UL * 1024UL)         // io(): bytes per write
+#define FSYNC_EVERY 10                       // io(): fsync every 10th write
 
 void cpu(size_t n);
 void mem(size_t n);
 void io(size_t n);
 
+// Worker kinds, as given on the command line ("mix" = worker i runs kind i % 3)
+enum { WORK_CPU = 0, WORK_MEM = 1, WORK_IO = 2, WORK_KINDS = 3, WORK_MIX = 3 };
+
+// Parse "cpu" / "mem" / "io" / "mix"; returns -1 if unknown
+int work_kind(const char *name);
+
+// Per-worker state, so one loop iteration of cpu()/mem()/io() can run on its own
+// (as a task of the scheduler). Buffers are set up on first use.
+typedef struct {
+    char *mem_buf;          // mem(): 50 MB buffer
+    mem_pattern_buf_t mp;   // mem() with --pattern
+    membuf_stats_t mb;      // mem(): first touch vs sweep (--pages etc.)
+    char *io_buf;           // io(): 256 KB write buffer
+    char io_name[64];       // io(): this worker's file
+    io_engine_state_t ioe;  // io() with --io-engine
+    gc_worker_t gc;         // io() with --commit
+    read_worker_t rd;       // io() with --read
+} worker_ctx_t;
+
+void worker_ctx_init(worker_ctx_t *w);
+void worker_ctx_free(worker_ctx_t *w);
+
+// cpu() kernel: ISA_SCALAR (default, libm), a SIMD one or ISA_AUTO, see
+// MT25024_Part_B_Simd.h. Returns -1 if the CPU does not support it.
+int cpu_set_isa(int isa);
+
+// One iteration of the given kind; returns -1 on error
+void cpu_iter(void);
+int mem_iter(worker_ctx_t *w, size_t iter);
+int io_iter(worker_ctx_t *w, size_t iter);
+int work_iter(worker_ctx_t *w, int kind, size_t iter);
+
+// One mem() pass over buffer[lo, hi) (lo and hi multiples of MEM_STRIDE)
+void mem_sweep(char *buffer, size_t lo, size_t hi, size_t iter);
+
 #endif
@@ -5,6 +5,7 @@
 # Roll Number: MT25024
 # Description: Part C Automation with taskset, top sampling, iostat + time
 # Output CSV: MT25024_Part_C_CSV.csv (CPU/Mem/IO + Time_real)
+#             MT25024_Part_C_Acct_CSV.csv (exact in-process accounting, --csv)
 ################################################################################
 
 set -u
@@ -37,6 +38,10 @@ CSV_FILE="MT25024_Part_C_CSV.csv"
 # One CSV only (include time in same CSV)
 echo "Program+Function,CPU%,Mem(KB),IO(%util),Time_real(s)" > "$CSV_FILE"
 
+# Programs append their own exact row here (getrusage, /proc/thread-self/io, per-worker times)
+ACCT_CSV="MT25024_Part_C_Acct_CSV.csv"
+rm -f "$ACCT_CSV"
+
 echo "Starting measurements for Part C..."
 
 # Get all descendants of a PID (children, grandchildren, ...)
@@ -73,7 +78,7 @@ for prog in "${PROGRAMS[@]}"; do
     START_T=$(date +%s.%N)
 
     # Run program pinned to CPU0 (PID is REAL program PID -> top works)
-    taskset -c 0 ./"$prog" "$work" &
+    taskset -c 0 ./"$prog" "$work" --csv="$ACCT_CSV" &
     PID=$!
 
     # allow program to start + spawn children before first sample
@@ -143,4 +148,10 @@ done
 
 rm -f top_log_*.txt iostat_*.txt
 echo "------------------------------------------------"
-echo "Done! Part C results saved to $CSV_FILE"
+echo "Done! Part C results saved to $CSV_FILE (in-process accounting: $ACCT_CSV)"
+
+# Append this run to the result store (keyed by git rev + host + params) so that
+# later runs can be checked with: ../MT25024_Result_Store.py compare --base <rev> --head <rev>
+if command -v python3 >/dev/null 2>&1; then
+  python3 ../MT25024_Result_Store.py record --csv "$CSV_FILE" || true
+fi
@@ -0,0 +1,65 @@
+#include "MT25024_Capture.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static unsigned g_next_thread;
+
+int capture_open(capture_ring_t *r, const char *dir, const char *prog, uint64_t records, int sock) {
+    memset(r, 0, sizeof(*r));
+
+    uint64_t cap = 1;
+    while (cap < records) cap <<= 1;
+
+    struct sockaddr_in local;
+    socklen_t slen = sizeof(local);
+    if (getsockname(sock, (struct sockaddr *)&local, &slen) == 0) r->conn = ntohs(local.sin_port);
+
+    char path[512];
+    unsigned idx = __atomic_fetch_add(&g_next_thread, 1, __ATOMIC_RELAXED);
+    snprintf(path, sizeof(path), "%s/%s.%ld.t%u.cap", dir, prog, (long)getpid(), idx);
+
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "capture: %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    size_t len = CAPTURE_HDR_BYTES + (size_t)cap * sizeof(capture_rec_t);
+    if (ftruncate(fd, (off_t)len) != 0) {
+        fprintf(stderr, "capture: ftruncate %s: %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    void *m = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED) {
+        fprintf(stderr, "capture: mmap %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    r->hdr = (capture_hdr_t *)m;
+    r->rec = (capture_rec_t *)((char *)m + CAPTURE_HDR_BYTES);
+    r->mask = cap - 1;
+    r->map_len = len;
+
+    r->hdr->rec_size = sizeof(capture_rec_t);
+    r->hdr->hdr_size = CAPTURE_HDR_BYTES;
+    r->hdr->capacity = cap;
+    r->hdr->head = 0;
+    snprintf(r->hdr->prog, sizeof(r->hdr->prog), "%s", prog);
+    r->hdr->version = CAPTURE_VERSION;
+    __atomic_store_n(&r->hdr->magic, CAPTURE_MAGIC, __ATOMIC_RELEASE);   // header complete
+    return 0;
+}
+
+void capture_close(capture_ring_t *r) {
+    if (!r->hdr) return;
+    munmap(r->hdr, r->map_len);   // MAP_SHARED: the page cache already holds the records
+    r->hdr = NULL;
+}
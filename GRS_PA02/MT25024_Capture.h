@@ -0,0 +1,70 @@
+/*
+ * MT25024 – per-request record capture (--capture=DIR on the clients).
+ *
+ * Every client thread owns one ring file  DIR/<prog>.<pid>.t<N>.cap  mapped with
+ * MAP_SHARED, and appends one fixed-size record per response (or failed request).
+ * The thread is the only writer, so the hot path is a store into the mapping plus
+ * a release store of the head counter: no lock and no syscall. When the ring is
+ * full the oldest records are overwritten. capture_read converts the files.
+ *
+ *   file = capture_hdr_t (padded to CAPTURE_HDR_BYTES) | capacity x capture_rec_t
+ * All fields are in host byte order; the files are read back on the same host.
+ */
+#ifndef MT25024_CAPTURE_H
+#define MT25024_CAPTURE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CAPTURE_MAGIC           0x43415054u   /* "CAPT" */
+#define CAPTURE_VERSION         1
+#define CAPTURE_HDR_BYTES       4096
+#define CAPTURE_DEFAULT_RECORDS (1u << 20)    /* 32 MB per thread */
+
+typedef struct {
+    uint64_t send_ns;   // CLOCK_MONOTONIC, trigger about to be sent
+    uint64_t recv_ns;   // full response received (or the failure was seen)
+    uint64_t bytes;     // payload bytes received
+    uint32_t conn;      // client's local TCP port
+    int32_t err;        // 0, or an errno value: ETIMEDOUT, ECONNRESET, EBADMSG (verify / frame check)
+} capture_rec_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t rec_size;
+    uint32_t hdr_size;
+    uint64_t capacity;  // records, a power of two
+    uint64_t head;      // records ever written; the newest is at (head - 1) & (capacity - 1)
+    char prog[32];
+} capture_hdr_t;
+
+typedef struct {
+    capture_hdr_t *hdr;  // NULL when capture is off
+    capture_rec_t *rec;
+    uint64_t mask;
+    uint32_t conn;
+    size_t map_len;
+} capture_ring_t;
+
+/*
+ * create the next thread's ring file under dir (threads are numbered in call order);
+ * records is rounded up to a power of two. Returns 0, or -1 with a message printed.
+ */
+int capture_open(capture_ring_t *r, const char *dir, const char *prog, uint64_t records, int sock);
+
+static inline void capture_add(capture_ring_t *r, uint64_t send_ns, uint64_t recv_ns, uint64_t bytes, int err) {
+    if (!r->hdr) return;
+    uint64_t h = r->hdr->head;
+    capture_rec_t *e = &r->rec[h & r->mask];
+    e->send_ns = send_ns;
+    e->recv_ns = recv_ns;
+    e->bytes = bytes;
+    e->conn = r->conn;
+    e->err = err;
+    __atomic_store_n(&r->hdr->head, h + 1, __ATOMIC_RELEASE);   // a live reader sees whole records
+}
+
+void capture_close(capture_ring_t *r);
+
+#endif
@@ -0,0 +1,303 @@
+/*
+ * MT25024 – reader for the client --capture ring files.
+ *
+ * Usage: ./capture_read [--csv=FILE|-] [--columns=PREFIX] [--window=MS] [--stall=X]
+ *                       [--all-windows] <file.cap>...
+ *
+ * The rings of all given files (usually every thread of one run) are merged in
+ * send-time order.
+ *   --csv=FILE       one row per request: file,conn,send_ns,recv_ns,rtt_ns,bytes,err
+ *   --columns=PREFIX one raw little-endian array per column, PREFIX.<name>.<type>
+ *                    (e.g. numpy.fromfile("run.rtt_ns.u64", dtype="<u8"))
+ *   --window=MS      windowed statistics by completion time (default 10 ms)
+ *
+ * A window is flagged as a stall when its p99 RTT exceeds --stall=X (default 3)
+ * times the median window p99. Windows in which nothing completed (client idle,
+ * between runs) are skipped and only counted. Consecutive stalled windows form one
+ * episode, and the distribution of distances between episode starts is printed, so
+ * a spike every 200 ms shows up as period_p50=200.
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "MT25024_Capture.h"
+#include "MT25024_Stats.h"
+
+typedef struct {
+    capture_rec_t r;
+    uint32_t file;
+} row_t;
+
+static int cmp_send(const void *a, const void *b) {
+    const row_t *x = (const row_t*)a, *y = (const row_t*)b;
+    return x->r.send_ns < y->r.send_ns ? -1 : x->r.send_ns > y->r.send_ns;
+}
+
+static int cmp_recv(const void *a, const void *b) {
+    const row_t *x = (const row_t*)a, *y = (const row_t*)b;
+    return x->r.recv_ns < y->r.recv_ns ? -1 : x->r.recv_ns > y->r.recv_ns;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+/* appends the valid records of one ring (oldest first); returns -1 on a bad file */
+static int load_ring(const char *path, uint32_t file, row_t **rows, size_t *n, size_t *cap) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) { fprintf(stderr, "%s: %s\n", path, strerror(errno)); return -1; }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < CAPTURE_HDR_BYTES) {
+        fprintf(stderr, "%s: not a capture file\n", path);
+        close(fd);
+        return -1;
+    }
+    const char *m = (const char*)mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED) { fprintf(stderr, "%s: mmap: %s\n", path, strerror(errno)); return -1; }
+
+    const capture_hdr_t *h = (const capture_hdr_t*)m;
+    uint64_t capy = h->capacity;
+    if (h->magic != CAPTURE_MAGIC || h->version != CAPTURE_VERSION || h->rec_size != sizeof(capture_rec_t) ||
+        h->hdr_size != CAPTURE_HDR_BYTES || capy == 0 || (capy & (capy - 1)) ||
+        (uint64_t)st.st_size < CAPTURE_HDR_BYTES + capy * sizeof(capture_rec_t)) {
+        fprintf(stderr, "%s: bad capture header\n", path);
+        munmap((void*)m, (size_t)st.st_size);
+        return -1;
+    }
+
+    uint64_t head = __atomic_load_n(&h->head, __ATOMIC_ACQUIRE);
+    uint64_t cnt = head < capy ? head : capy;
+    const capture_rec_t *rec = (const capture_rec_t*)(m + CAPTURE_HDR_BYTES);
+
+    if (*n + cnt > *cap) {
+        size_t ncap = *cap ? *cap : 1024;
+        while (ncap < *n + cnt) ncap *= 2;
+        row_t *nr = (row_t*)realloc(*rows, ncap * sizeof(row_t));
+        if (!nr) { perror("realloc"); munmap((void*)m, (size_t)st.st_size); return -1; }
+        *rows = nr;
+        *cap = ncap;
+    }
+    for (uint64_t i = head - cnt; i < head; i++) {
+        row_t *o = &(*rows)[(*n)++];
+        o->r = rec[i & (capy - 1)];
+        o->file = file;
+    }
+    fprintf(stderr, "[capture] %s: prog=%.32s records=%llu%s\n", path, h->prog, (unsigned long long)cnt,
+            head > capy ? " (ring wrapped, oldest records lost)" : "");
+    munmap((void*)m, (size_t)st.st_size);
+    return 0;
+}
+
+static int write_csv(const char *path, const row_t *rows, size_t n) {
+    FILE *fp = strcmp(path, "-") == 0 ? stdout : fopen(path, "w");
+    if (!fp) { fprintf(stderr, "%s: %s\n", path, strerror(errno)); return -1; }
+    fprintf(fp, "file,conn,send_ns,recv_ns,rtt_ns,bytes,err\n");
+    for (size_t i = 0; i < n; i++) {
+        const capture_rec_t *r = &rows[i].r;
+        fprintf(fp, "%u,%u,%llu,%llu,%llu,%llu,%d\n", rows[i].file, r->conn,
+                (unsigned long long)r->send_ns, (unsigned long long)r->recv_ns,
+                (unsigned long long)(r->recv_ns - r->send_ns), (unsigned long long)r->bytes, r->err);
+    }
+    if (fp != stdout) fclose(fp);
+    return 0;
+}
+
+/* column writer: which = 0 file, 1 conn, 2 send_ns, 3 recv_ns, 4 rtt_ns, 5 bytes, 6 err */
+static int write_column(const char *prefix, const char *name, int which, const row_t *rows, size_t n) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s.%s", prefix, name);
+    FILE *fp = fopen(path, "wb");
+    if (!fp) { fprintf(stderr, "%s: %s\n", path, strerror(errno)); return -1; }
+    for (size_t i = 0; i < n; i++) {
+        const capture_rec_t *r = &rows[i].r;
+        uint64_t v64 = 0;
+        uint32_t v32 = 0;
+        bool wide = true;
+        switch (which) {
+        case 0: v32 = rows[i].file; wide = false; break;
+        case 1: v32 = r->conn; wide = false; break;
+        case 2: v64 = r->send_ns; break;
+        case 3: v64 = r->recv_ns; break;
+        case 4: v64 = r->recv_ns - r->send_ns; break;
+        case 5: v64 = r->bytes; break;
+        default: v32 = (uint32_t)r->err; wide = false; break;
+        }
+        if (wide) fwrite(&v64, sizeof(v64), 1, fp);
+        else fwrite(&v32, sizeof(v32), 1, fp);
+    }
+    if (fclose(fp) != 0) { fprintf(stderr, "%s: write failed\n", path); return -1; }
+    return 0;
+}
+
+static int write_columns(const char *prefix, const row_t *rows, size_t n) {
+    static const char *names[] = { "file.u32", "conn.u32", "send_ns.u64", "recv_ns.u64",
+                                   "rtt_ns.u64", "bytes.u64", "err.i32" };
+    for (int c = 0; c < 7; c++)
+        if (write_column(prefix, names[c], c, rows, n) != 0) return -1;
+    fprintf(stderr, "[capture] wrote %zu rows to %s.{file,conn,send_ns,recv_ns,rtt_ns,bytes,err}.*\n", n, prefix);
+    return 0;
+}
+
+/* windows by completion time; rows must be sorted by recv_ns */
+static void window_stats(const row_t *rows, size_t n, uint64_t win_ns, double stall_x, bool all) {
+    uint64_t t0 = rows[0].r.send_ns;
+    for (size_t i = 0; i < n; i++) if (rows[i].r.send_ns < t0) t0 = rows[i].r.send_ns;
+    size_t nwin = (size_t)((rows[n - 1].r.recv_ns - t0) / win_ns + 1);
+
+    uint64_t *p99 = (uint64_t*)calloc(nwin, sizeof(uint64_t));
+    uint64_t *sorted = (uint64_t*)malloc(nwin * sizeof(uint64_t));
+    unsigned long long *cnt = (unsigned long long*)calloc(nwin, sizeof(unsigned long long));
+    uint64_t *rtt = (uint64_t*)malloc(n * sizeof(uint64_t));
+    size_t *stalls = (size_t*)malloc(nwin * sizeof(size_t));
+    if (!p99 || !sorted || !cnt || !rtt || !stalls) { perror("malloc"); goto out; }
+
+    // pass 1: per-window p99 (RTTs of one window are contiguous because rows are in recv order)
+    size_t i = 0;
+    for (size_t w = 0; w < nwin; w++) {
+        uint64_t wend = t0 + (uint64_t)(w + 1) * win_ns;
+        size_t k = 0;
+        while (i < n && rows[i].r.recv_ns < wend) { rtt[k++] = rows[i].r.recv_ns - rows[i].r.send_ns; i++; }
+        cnt[w] = k;
+        if (k) {
+            qsort(rtt, k, sizeof(uint64_t), cmp_u64);
+            p99[w] = rtt[(size_t)((double)(k - 1) * 0.99)];
+        }
+    }
+    size_t nz = 0;
+    for (size_t w = 0; w < nwin; w++) if (cnt[w]) sorted[nz++] = p99[w];
+    qsort(sorted, nz, sizeof(uint64_t), cmp_u64);
+    uint64_t med = nz ? sorted[nz / 2] : 0;
+    uint64_t limit = (uint64_t)((double)med * stall_x);
+
+    // pass 2: print, flag stalls
+    size_t nstall = 0, nempty = 0;
+    i = 0;
+    for (size_t w = 0; w < nwin; w++) {
+        uint64_t wend = t0 + (uint64_t)(w + 1) * win_ns;
+        unsigned long long err = 0, bytes = 0;
+        uint64_t mx = 0;
+        size_t k = 0;
+        while (i < n && rows[i].r.recv_ns < wend) {
+            uint64_t r = rows[i].r.recv_ns - rows[i].r.send_ns;
+            rtt[k++] = r;
+            if (r > mx) mx = r;
+            if (rows[i].r.err) err++;
+            bytes += rows[i].r.bytes;
+            i++;
+        }
+        if (k == 0) {
+            nempty++;
+            continue;
+        }
+        bool stall = p99[w] > limit;
+        if (stall) stalls[nstall++] = w;
+        if (!all && !stall) continue;
+
+        qsort(rtt, k, sizeof(uint64_t), cmp_u64);
+        uint64_t p50 = rtt[(k - 1) / 2];
+        printf("window t=%.3f s n=%zu err=%llu rx_throughput=%.3f Gbps p50=%.2f p99=%.2f max=%.2f us%s\n",
+               (double)(w * win_ns) / 1e9, k, err, (double)bytes * 8.0 / (double)win_ns,
+               (double)p50 / 1e3, (double)p99[w] / 1e3, (double)mx / 1e3, stall ? " STALL" : "");
+    }
+
+    printf("windows=%zu (empty=%zu) window=%.3f ms median_p99=%.2f us stall_threshold=%.2f us stalls=%zu\n",
+           nwin, nempty, (double)win_ns / 1e6, (double)med / 1e3, (double)limit / 1e3, nstall);
+
+    // period: consecutive stalled windows are one episode; median distance between episode starts
+    size_t nep = 0;
+    for (size_t s = 0; s < nstall; s++)
+        if (s == 0 || stalls[s] != stalls[s - 1] + 1) stalls[nep++] = stalls[s];
+    printf("stall_episodes=%zu", nep);
+    if (nep >= 3) {
+        uint64_t *gap = sorted;   // reuse, nep - 1 < nwin
+        for (size_t s = 0; s + 1 < nep; s++) gap[s] = stalls[s + 1] - stalls[s];
+        qsort(gap, nep - 1, sizeof(uint64_t), cmp_u64);
+        printf(" period_p50=%.3f ms (p10=%.3f p90=%.3f)", (double)(gap[(nep - 1) / 2] * win_ns) / 1e6,
+               (double)(gap[(nep - 1) / 10] * win_ns) / 1e6, (double)(gap[(nep - 1) * 9 / 10] * win_ns) / 1e6);
+    }
+    printf("\n");
+
+out:
+    free(stalls);
+    free(rtt);
+    free(cnt);
+    free(sorted);
+    free(p99);
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "Usage: %s [options] <file.cap>...\n"
+        "  --csv=FILE       write every request as CSV (FILE '-' = stdout)\n"
+        "  --columns=PREFIX write one raw little-endian array per column to PREFIX.<name>.<type>\n"
+        "  --window=MS      window for the statistics (default 10)\n"
+        "  --stall=X        flag windows whose p99 exceeds X times the median window p99 (default 3)\n"
+        "  --all-windows    print every window, not only stalls\n",
+        prog);
+}
+
+int main(int argc, char **argv) {
+    const char *csv = NULL, *columns = NULL;
+    double win_ms = 10.0, stall_x = 3.0;
+    bool all = false;
+    int first = argc;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--csv=", 6) == 0) {
+            csv = argv[i] + 6;
+        } else if (strncmp(argv[i], "--columns=", 10) == 0) {
+            columns = argv[i] + 10;
+        } else if (strncmp(argv[i], "--window=", 9) == 0) {
+            win_ms = atof(argv[i] + 9);
+        } else if (strncmp(argv[i], "--stall=", 8) == 0) {
+            stall_x = atof(argv[i] + 8);
+        } else if (strcmp(argv[i], "--all-windows") == 0) {
+            all = true;
+        } else if (argv[i][0] == '-') {
+            usage(argv[0]);
+            return 1;
+        } else {
+            first = i;
+            break;
+        }
+    }
+    if (first == argc) { usage(argv[0]); return 1; }
+    if (win_ms <= 0 || stall_x <= 0) { fprintf(stderr, "--window and --stall must be > 0\n"); return 1; }
+
+    row_t *rows = NULL;
+    size_t n = 0, cap = 0;
+    for (int i = first; i < argc; i++)
+        if (load_ring(argv[i], (uint32_t)(i - first), &rows, &n, &cap) != 0) return 1;
+    if (n == 0) { fprintf(stderr, "no records\n"); free(rows); return 1; }
+
+    qsort(rows, n, sizeof(row_t), cmp_send);
+    if (csv && write_csv(csv, rows, n) != 0) return 1;
+    if (columns && write_columns(columns, rows, n) != 0) return 1;
+
+    lat_hist_t h;
+    memset(&h, 0, sizeof(h));
+    unsigned long long errs = 0;
+    for (size_t i = 0; i < n; i++) {
+        lat_hist_add(&h, rows[i].r.recv_ns - rows[i].r.send_ns);
+        if (rows[i].r.err) errs++;
+    }
+    printf("records=%zu errors=%llu span=%.3f s\n", n, errs,
+           (double)(rows[n - 1].r.send_ns - rows[0].r.send_ns) / 1e9);
+    lat_hist_print(stdout, "rtt", &h);
+
+    qsort(rows, n, sizeof(row_t), cmp_recv);
+    window_stats(rows, n, (uint64_t)(win_ms * 1e6), stall_x, all);
+
+    free(rows);
+    return 0;
+}
@@ -0,0 +1,424 @@
+/*
+ * MT25024 – scatter/gather fan-out client.
+ *
+ * Usage: ./fanout_client <ip:port[,ip:port...]> <msgSize> <threads> <duration_sec>
+ *                        [--quorum=K] [--hedge=US]
+ *
+ * Each logical request sends one 8-byte trigger to every backend (any A1/A2/A3
+ * server in its default mode, started with the same msgSize and its own --port)
+ * and completes once K of them (default: all) have returned their full response.
+ * Responses that arrive after the quorum are still drained in order on their
+ * connection; the next request does not wait for them.
+ *
+ * --hedge=US: a backend that has not answered US microseconds after the request
+ * went out gets the trigger again on a second connection to the same server, and
+ * whichever copy finishes first counts.
+ *
+ * Reported: per-thread request counts, the whole-request latency distribution and
+ * one distribution per backend (request sent -> that backend's first full copy).
+ */
+#define _GNU_SOURCE
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "MT25024_Proto.h"
+#include "MT25024_Stats.h"
+
+#define FANOUT_MAX_BACKENDS 16
+#define FANOUT_MAX_INFLIGHT 64      // responses owed on one connection before the sender waits
+#define FANOUT_ANSWERED     (2 * FANOUT_MAX_INFLIGHT)   // answered ids remembered per backend
+#define SINK_BYTES (256 * 1024)     // response bytes are read into this and dropped
+
+typedef struct {
+    char ip[64];
+    int port;
+} backend_addr_t;
+
+typedef struct {
+    backend_addr_t be[FANOUT_MAX_BACKENDS];
+    int nbe;
+    size_t msgSize;
+    int duration;
+    int quorum;
+    unsigned long long hedge_ns;   // 0 = no hedging
+} fanout_cfg_t;
+
+/* one connection: responses come back in trigger order, so a FIFO of owed requests is enough */
+typedef struct {
+    int fd;
+    uint64_t req[FANOUT_MAX_INFLIGHT];
+    uint64_t t_send[FANOUT_MAX_INFLIGHT];
+    unsigned head, len;
+    size_t got;                    // bytes of the head response received so far
+} conn_t;
+
+typedef struct {
+    lat_hist_t lat;
+    unsigned long long responses;  // first copies only
+    unsigned long long hedges;     // duplicate triggers sent
+    unsigned long long hedge_wins; // requests answered first by the duplicate
+} backend_stats_t;
+
+/*
+ * answered[id % FANOUT_ANSWERED] holds the newest answered id in that slot (ids start
+ * at 1). A slot taken by a newer id also means the older one was answered: a newer id
+ * only goes out once the primary owes fewer than FANOUT_MAX_INFLIGHT responses, so the
+ * primary has already returned every id FANOUT_ANSWERED or more below it.
+ */
+typedef struct {
+    conn_t prim, hedge;
+    uint64_t answered[FANOUT_ANSWERED];
+    backend_stats_t st;
+} backend_t;
+
+static bool be_answered(const backend_t *b, uint64_t req) {
+    return b->answered[req % FANOUT_ANSWERED] >= req;
+}
+
+/* merged by main() after all threads finish */
+static lat_hist_t g_req_lat;
+static backend_stats_t g_be_stats[FANOUT_MAX_BACKENDS];
+static unsigned long long g_requests, g_incomplete;
+static pthread_mutex_t g_mu = PTHREAD_MUTEX_INITIALIZER;
+
+static int connect_to(const backend_addr_t *a) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) { perror("socket"); return -1; }
+
+    int one = 1;
+    (void)setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    struct sockaddr_in sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons((uint16_t)a->port);
+    if (inet_pton(AF_INET, a->ip, &sa.sin_addr) != 1) {
+        fprintf(stderr, "inet_pton failed for %s\n", a->ip);
+        close(fd);
+        return -1;
+    }
+    if (connect(fd, (struct sockaddr*)&sa, sizeof(sa)) < 0) {
+        fprintf(stderr, "connect %s:%d: %s\n", a->ip, a->port, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/* blocking 8-byte trigger send; the connection's FIFO must have room */
+static int conn_send(conn_t *c, uint64_t req, uint64_t t_send) {
+    size_t sent = 0;
+    while (sent < 8) {
+        ssize_t n = send(c->fd, "PINGPING" + sent, 8 - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        sent += (size_t)n;
+    }
+    unsigned tail = (c->head + c->len) % FANOUT_MAX_INFLIGHT;
+    c->req[tail] = req;
+    c->t_send[tail] = t_send;
+    c->len++;
+    return 0;
+}
+
+/*
+ * read whatever is available on c without blocking; every completed response is
+ * credited to its backend if it is the first copy for that request.
+ * Returns the number of completions for request 'cur', or -1 on error / close.
+ */
+static int conn_read(conn_t *c, backend_t *b, bool is_hedge, size_t msgSize, char *sink, uint64_t cur) {
+    int done_cur = 0;
+    while (c->len > 0) {
+        size_t want = msgSize - c->got;
+        if (want > SINK_BYTES) want = SINK_BYTES;
+        ssize_t r = recv(c->fd, sink, want, MSG_DONTWAIT);
+        if (r == 0) return -1;
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return -1;
+        }
+        c->got += (size_t)r;
+        if (c->got < msgSize) continue;
+
+        uint64_t req = c->req[c->head];
+        uint64_t t_send = c->t_send[c->head];
+        c->head = (c->head + 1) % FANOUT_MAX_INFLIGHT;
+        c->len--;
+        c->got = 0;
+
+        // the primary and hedge connections finish in different orders, so track each id
+        if (!be_answered(b, req)) {
+            b->answered[req % FANOUT_ANSWERED] = req;
+            b->st.responses++;
+            lat_hist_add(&b->st.lat, mono_ns() - t_send);
+            if (is_hedge) b->st.hedge_wins++;
+            if (req == cur) done_cur++;
+        }
+    }
+    return done_cur;
+}
+
+/* wait up to deadline_ns for any owed response and process it; returns completions for cur or -1 */
+static int pump(backend_t *be, int nbe, size_t msgSize, char *sink, uint64_t cur, uint64_t deadline_ns) {
+    struct pollfd pfd[2 * FANOUT_MAX_BACKENDS];
+    conn_t *conn[2 * FANOUT_MAX_BACKENDS];
+    int owner[2 * FANOUT_MAX_BACKENDS];
+    int n = 0;
+    for (int b = 0; b < nbe; b++) {
+        conn_t *cs[2] = { &be[b].prim, &be[b].hedge };
+        for (int k = 0; k < 2; k++) {
+            if (cs[k]->fd < 0 || cs[k]->len == 0) continue;
+            pfd[n].fd = cs[k]->fd;
+            pfd[n].events = POLLIN;
+            conn[n] = cs[k];
+            owner[n] = b;
+            n++;
+        }
+    }
+    if (n == 0) return 0;
+
+    uint64_t now = mono_ns();
+    uint64_t wait = deadline_ns > now ? deadline_ns - now : 0;
+    struct timespec ts = { (time_t)(wait / 1000000000ULL), (long)(wait % 1000000000ULL) };
+    int pr = ppoll(pfd, (nfds_t)n, &ts, NULL);
+    if (pr < 0) return errno == EINTR ? 0 : -1;
+
+    int done_cur = 0;
+    for (int i = 0; i < n; i++) {
+        if (!(pfd[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+        backend_t *b = &be[owner[i]];
+        int d = conn_read(conn[i], b, conn[i] == &b->hedge, msgSize, sink, cur);
+        if (d < 0) return -1;
+        done_cur += d;
+    }
+    return done_cur;
+}
+
+static void *client_thread(void *arg) {
+    const fanout_cfg_t *cfg = (const fanout_cfg_t*)arg;
+
+    backend_t *be = (backend_t*)calloc((size_t)cfg->nbe, sizeof(backend_t));
+    char *sink = (char*)malloc(SINK_BYTES);
+    if (!be || !sink) {
+        perror("malloc");
+        free(be);
+        free(sink);
+        return NULL;
+    }
+
+    bool ok = true;
+    for (int b = 0; b < cfg->nbe; b++) {
+        be[b].prim.fd = be[b].hedge.fd = -1;
+        if (!ok) continue;
+        be[b].prim.fd = connect_to(&cfg->be[b]);
+        if (be[b].prim.fd < 0) ok = false;
+        if (ok && cfg->hedge_ns) {
+            be[b].hedge.fd = connect_to(&cfg->be[b]);
+            if (be[b].hedge.fd < 0) ok = false;
+        }
+    }
+
+    lat_hist_t req_lat;
+    memset(&req_lat, 0, sizeof(req_lat));
+    unsigned long long requests = 0, incomplete = 0, hedged_reqs = 0;
+
+    uint64_t start = mono_ns();
+    uint64_t end = start + (uint64_t)cfg->duration * 1000000000ULL;
+    uint64_t cur = 0;
+
+    while (ok && mono_ns() < end) {
+        cur++;
+
+        // a connection still owing FANOUT_MAX_INFLIGHT responses is drained first
+        for (int b = 0; b < cfg->nbe && ok; b++) {
+            while (ok && be[b].prim.len == FANOUT_MAX_INFLIGHT)
+                ok = pump(be, cfg->nbe, cfg->msgSize, sink, cur, end) >= 0 && mono_ns() < end;
+        }
+        if (!ok) break;
+
+        uint64_t t_send = mono_ns();
+        for (int b = 0; b < cfg->nbe && ok; b++)
+            ok = conn_send(&be[b].prim, cur, t_send) == 0;
+        if (!ok) { perror("send"); break; }
+
+        int ndone = 0;
+        bool hedged = (cfg->hedge_ns == 0);
+        while (ok && ndone < cfg->quorum) {
+            uint64_t now = mono_ns();
+            if (now >= end) break;
+
+            if (!hedged && now >= t_send + cfg->hedge_ns) {
+                // hedge every backend that has not answered yet (and has room on its hedge connection)
+                for (int b = 0; b < cfg->nbe && ok; b++) {
+                    if (be_answered(&be[b], cur) || be[b].hedge.len == FANOUT_MAX_INFLIGHT) continue;
+                    ok = conn_send(&be[b].hedge, cur, t_send) == 0;
+                    be[b].st.hedges++;
+                }
+                hedged = true;
+                hedged_reqs++;
+                continue;
+            }
+
+            uint64_t deadline = hedged ? end : t_send + cfg->hedge_ns;
+            int d = pump(be, cfg->nbe, cfg->msgSize, sink, cur, deadline < end ? deadline : end);
+            if (d < 0) { ok = false; break; }
+            ndone += d;
+        }
+
+        if (ndone >= cfg->quorum) {
+            lat_hist_add(&req_lat, mono_ns() - t_send);
+            requests++;
+        } else {
+            incomplete++;
+        }
+    }
+
+    double elapsed = (double)(mono_ns() - start) / 1e9;
+    if (elapsed <= 0) elapsed = 1e-9;
+
+    unsigned long long responses = 0;
+    pthread_mutex_lock(&g_mu);
+    lat_hist_merge(&g_req_lat, &req_lat);
+    g_requests += requests;
+    g_incomplete += incomplete;
+    for (int b = 0; b < cfg->nbe; b++) {
+        backend_stats_t *g = &g_be_stats[b];
+        lat_hist_merge(&g->lat, &be[b].st.lat);
+        g->responses += be[b].st.responses;
+        g->hedges += be[b].st.hedges;
+        g->hedge_wins += be[b].st.hedge_wins;
+        responses += be[b].st.responses;
+    }
+    pthread_mutex_unlock(&g_mu);
+
+    double rx_bytes = (double)responses * (double)cfg->msgSize;
+    fprintf(stderr,
+            "[fanout client thread] requests=%llu incomplete=%llu hedged=%llu time=%.2f sec "
+            "req_rate=%.0f/s rx_throughput=%.3f Gbps avg_req=%.2f us\n",
+            requests, incomplete, hedged_reqs, elapsed, (double)requests / elapsed,
+            rx_bytes * 8.0 / (elapsed * 1e9),
+            req_lat.count ? (double)req_lat.sum_ns / (double)req_lat.count / 1e3 : 0.0);
+
+    for (int b = 0; b < cfg->nbe; b++) {
+        if (be[b].prim.fd >= 0) close(be[b].prim.fd);
+        if (be[b].hedge.fd >= 0) close(be[b].hedge.fd);
+    }
+    free(sink);
+    free(be);
+    return NULL;
+}
+
+/* "ip:port,ip:port,..." */
+static int parse_backends(const char *arg, fanout_cfg_t *cfg) {
+    const char *p = arg;
+    while (*p) {
+        if (cfg->nbe == FANOUT_MAX_BACKENDS) return -1;
+        const char *colon = strchr(p, ':');
+        if (!colon || colon == p || (size_t)(colon - p) >= sizeof(cfg->be[0].ip)) return -1;
+        backend_addr_t *a = &cfg->be[cfg->nbe++];
+        memcpy(a->ip, p, (size_t)(colon - p));
+        a->ip[colon - p] = '\0';
+
+        char *endp;
+        long port = strtol(colon + 1, &endp, 10);
+        if (endp == colon + 1 || port <= 0 || port > 65535) return -1;
+        a->port = (int)port;
+
+        if (*endp == ',') endp++;
+        else if (*endp != '\0') return -1;
+        p = endp;
+    }
+    return cfg->nbe > 0 ? 0 : -1;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "Usage: %s <ip:port[,ip:port...]> <msgSize> <threads> <duration_sec> [options]\n"
+        "  every backend is an A1/A2/A3 server started with the same msgSize (up to %d backends)\n"
+        "  --quorum=K     a request completes when K backends have answered (default: all)\n"
+        "  --hedge=US     re-send to backends still silent after US microseconds, on a\n"
+        "                 second connection; the first copy to finish counts\n",
+        prog, FANOUT_MAX_BACKENDS);
+}
+
+int main(int argc, char **argv) {
+    signal(SIGPIPE, SIG_IGN);
+
+    if (argc < 5) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    static fanout_cfg_t cfg;
+    if (parse_backends(argv[1], &cfg) != 0) {
+        fprintf(stderr, "bad backend list '%s' (ip:port[,ip:port...], up to %d)\n", argv[1], FANOUT_MAX_BACKENDS);
+        return 1;
+    }
+    cfg.msgSize = (size_t)strtoull(argv[2], NULL, 10);
+    int threads = atoi(argv[3]);
+    cfg.duration = atoi(argv[4]);
+    cfg.quorum = cfg.nbe;
+
+    for (int i = 5; i < argc; i++) {
+        if (strncmp(argv[i], "--quorum=", 9) == 0) {
+            cfg.quorum = atoi(argv[i] + 9);
+        } else if (strncmp(argv[i], "--hedge=", 8) == 0) {
+            cfg.hedge_ns = strtoull(argv[i] + 8, NULL, 10) * 1000ULL;
+            if (cfg.hedge_ns == 0) { fprintf(stderr, "--hedge must be > 0 us\n"); return 1; }
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (threads <= 0) { fprintf(stderr, "threads must be > 0\n"); return 1; }
+    if (cfg.duration <= 0) { fprintf(stderr, "duration must be > 0\n"); return 1; }
+    if (cfg.msgSize < 8) { fprintf(stderr, "msgSize must be >= 8 bytes\n"); return 1; }
+    if (cfg.quorum < 1 || cfg.quorum > cfg.nbe) {
+        fprintf(stderr, "--quorum must be 1..%d\n", cfg.nbe);
+        return 1;
+    }
+
+    pthread_t *tids = (pthread_t*)malloc(sizeof(pthread_t) * (size_t)threads);
+    if (!tids) { perror("malloc tids"); return 1; }
+
+    for (int i = 0; i < threads; i++) {
+        if (pthread_create(&tids[i], NULL, client_thread, &cfg) != 0) {
+            perror("pthread_create");
+            free(tids);
+            return 1;
+        }
+    }
+    for (int i = 0; i < threads; i++) pthread_join(tids[i], NULL);
+
+    fprintf(stderr, "[fanout] backends=%d quorum=%d hedge=%llu us requests=%llu incomplete=%llu\n",
+            cfg.nbe, cfg.quorum, cfg.hedge_ns / 1000ULL, g_requests, g_incomplete);
+    lat_hist_print(stderr, "[fanout] request", &g_req_lat);
+
+    for (int b = 0; b < cfg.nbe; b++) {
+        const backend_stats_t *s = &g_be_stats[b];
+        char label[128];
+        fprintf(stderr, "[fanout] backend=%d %s:%d responses=%llu hedges=%llu hedge_wins=%llu\n",
+                b, cfg.be[b].ip, cfg.be[b].port, s->responses, s->hedges, s->hedge_wins);
+        snprintf(label, sizeof(label), "[fanout] backend=%d", b);
+        lat_hist_print(stderr, label, &s->lat);
+    }
+
+    free(tids);
+    return 0;
+}
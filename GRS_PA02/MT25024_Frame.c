@@ -0,0 +1,143 @@
+#include "MT25024_Frame.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+
+#include "MT25024_Proto.h"
+
+static void put_be32(unsigned char *p, uint32_t v) {
+    p[0] = (unsigned char)(v >> 24);
+    p[1] = (unsigned char)(v >> 16);
+    p[2] = (unsigned char)(v >> 8);
+    p[3] = (unsigned char)v;
+}
+
+static uint32_t get_be32(const unsigned char *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+int frame_split(size_t total, const unsigned *weights, size_t flen[FRAME_FIELDS]) {
+    unsigned long long wsum = 0;
+    for (int i = 0; i < FRAME_FIELDS; i++) wsum += weights ? weights[i] : 1;
+
+    size_t used = 0;
+    for (int i = 0; i < FRAME_FIELDS - 1; i++) {
+        unsigned long long w = weights ? weights[i] : 1;
+        size_t n = (size_t)((unsigned long long)total * w / wsum);
+        if (n == 0) n = 1;
+        flen[i] = n;
+        used += n;
+    }
+    if (used >= total) return -1;
+    flen[FRAME_FIELDS - 1] = total - used;
+    return 0;
+}
+
+int frame_parse_weights(const char *arg, unsigned weights[FRAME_FIELDS]) {
+    const char *p = arg;
+    for (int i = 0; i < FRAME_FIELDS; i++) {
+        char *end;
+        unsigned long w = strtoul(p, &end, 10);
+        if (end == p || w == 0 || w > 1000000) return -1;
+        weights[i] = (unsigned)w;
+        if (i < FRAME_FIELDS - 1) {
+            if (*end != ',') return -1;
+            end++;
+        }
+        p = end;
+    }
+    return *p ? -1 : 0;
+}
+
+void frame_encode_hdr(unsigned char hdr[FRAME_HDR_LEN], const size_t flen[FRAME_FIELDS]) {
+    size_t total = 0;
+    for (int i = 0; i < FRAME_FIELDS; i++) total += flen[i];
+
+    hdr[0] = (unsigned char)(FRAME_MAGIC >> 8);
+    hdr[1] = (unsigned char)FRAME_MAGIC;
+    hdr[2] = 0;
+    hdr[3] = FRAME_FIELDS;
+    put_be32(hdr + 4, (uint32_t)total);
+    for (int i = 0; i < FRAME_FIELDS; i++) put_be32(hdr + 8 + 4 * i, (uint32_t)flen[i]);
+}
+
+int frame_parse(const char *buf, size_t len, frame_view_t views[FRAME_FIELDS], size_t *frame_len) {
+    if (len < FRAME_HDR_LEN) return 0;
+
+    const unsigned char *h = (const unsigned char *)buf;
+    if (((unsigned)h[0] << 8 | h[1]) != FRAME_MAGIC) return -1;
+    if (((unsigned)h[2] << 8 | h[3]) != FRAME_FIELDS) return -1;
+
+    size_t payload = get_be32(h + 4);
+    size_t off = FRAME_HDR_LEN;
+    size_t sum = 0;
+    for (int i = 0; i < FRAME_FIELDS; i++) {
+        size_t flen = get_be32(h + 8 + 4 * i);
+        views[i].ptr = buf + off + sum;
+        views[i].len = flen;
+        sum += flen;
+    }
+    if (sum != payload) return -1;
+    if (len < off + payload) return 0;
+
+    *frame_len = off + payload;
+    return 1;
+}
+
+/* exactly len bytes, bounded by deadline_ns; 1 / 0 closed / -2 deadline / -1 error */
+static int recv_exact(int fd, char *buf, size_t len, uint64_t deadline_ns) {
+    size_t got = 0;
+    while (got < len) {
+        if (mono_ns() >= deadline_ns) return -2;
+        ssize_t r = recv(fd, buf + got, len - got, 0);
+        if (r == 0) return 0;
+        if (r < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) continue; // bounded by deadline
+            return -1;
+        }
+        got += (size_t)r;
+    }
+    return 1;
+}
+
+int frame_recv(int fd, char *buf, size_t cap, frame_view_t views[FRAME_FIELDS], uint64_t deadline_ns) {
+    if (cap < FRAME_HDR_LEN) return -1;
+
+    int rc = recv_exact(fd, buf, FRAME_HDR_LEN, deadline_ns);
+    if (rc != 1) return rc;
+
+    // the header alone says how much follows
+    size_t frame_len = 0;
+    if (frame_parse(buf, FRAME_HDR_LEN, views, &frame_len) < 0) {
+        errno = EPROTO;
+        return -1;
+    }
+    size_t payload = get_be32((const unsigned char *)buf + 4);
+    if (FRAME_HDR_LEN + payload > cap) {
+        errno = EMSGSIZE;
+        return -1;
+    }
+
+    rc = recv_exact(fd, buf + FRAME_HDR_LEN, payload, deadline_ns);
+    if (rc != 1) return rc;
+
+    return frame_parse(buf, FRAME_HDR_LEN + payload, views, &frame_len) == 1 ? 1 : -1;
+}
+
+int frame_views_check(const frame_view_t views[FRAME_FIELDS], size_t msg_size) {
+    int bad = 0;
+    size_t sum = 0;
+    for (int i = 0; i < FRAME_FIELDS; i++) {
+        sum += views[i].len;
+        if (views[i].len == 0) {
+            bad++;
+            continue;
+        }
+        // A1/A3 end every field with '\0', which is all a 1-byte field holds
+        char c = views[i].ptr[0];
+        if (c != 'A' + i && !(views[i].len == 1 && c == '\0')) bad++;
+    }
+    return sum == msg_size ? bad : FRAME_FIELDS;
+}
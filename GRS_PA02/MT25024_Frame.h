@@ -0,0 +1,63 @@
+/*
+ * MT25024 – length-prefixed 8-field response format (--framed).
+ *
+ * By default a response is the 8 fields back to back with no boundaries on the
+ * wire; A2/A3 clients only find them again because they split msgSize into the
+ * same base/rem lengths as the server. A framed response says where each field is:
+ *
+ *   frame  = header | field 0 | ... | field 7
+ *   header = magic (u16) | nfields (u16, = 8) | payload bytes (u32) | 8 x field length (u32)
+ *            big-endian, FRAME_HDR_LEN bytes
+ *
+ * The parser checks the header and returns views (pointer + length) into the
+ * receive buffer, so fields are never copied out.
+ */
+#ifndef MT25024_FRAME_H
+#define MT25024_FRAME_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FRAME_MAGIC   0x4638u              /* "F8" */
+#define FRAME_FIELDS  8
+#define FRAME_HDR_LEN (8 + 4 * FRAME_FIELDS)
+
+typedef struct {
+    const char *ptr;
+    size_t len;
+} frame_view_t;
+
+/*
+ * split 'total' bytes over the 8 fields in proportion to weights[8] (NULL = even,
+ * which gives the old base/rem split). Fields 0..6 get at least 1 byte; field 7
+ * takes what is left. Returns -1 if that would leave field 7 empty.
+ */
+int frame_split(size_t total, const unsigned *weights, size_t flen[FRAME_FIELDS]);
+
+/* "w0,w1,...,w7" (1..1000000 each) -> weights; returns -1 on bad input */
+int frame_parse_weights(const char *arg, unsigned weights[FRAME_FIELDS]);
+
+void frame_encode_hdr(unsigned char hdr[FRAME_HDR_LEN], const size_t flen[FRAME_FIELDS]);
+
+/*
+ * parse one frame at buf[0..len): returns 1 and fills views / *frame_len when the
+ * whole frame is present, 0 if more bytes are needed, -1 if the header is malformed
+ */
+int frame_parse(const char *buf, size_t len, frame_view_t views[FRAME_FIELDS], size_t *frame_len);
+
+/*
+ * receive one frame into buf (cap bytes) and parse it in place.
+ * Returns 1 complete, 0 peer closed, -2 deadline (CLOCK_MONOTONIC ns) reached,
+ * -1 error / malformed frame / frame larger than cap.
+ */
+int frame_recv(int fd, char *buf, size_t cap, frame_view_t views[FRAME_FIELDS], uint64_t deadline_ns);
+
+/*
+ * client-side sanity check of a parsed frame against what the servers send:
+ * lengths summing to msg_size and field i filled with 'A' + i (a 1-byte field may
+ * also be the '\0' that A1/A3 write over the last byte of every field).
+ * Returns the number of fields that do not match (0 = frame is good).
+ */
+int frame_views_check(const frame_view_t views[FRAME_FIELDS], size_t msg_size);
+
+#endif
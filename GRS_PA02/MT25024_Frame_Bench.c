@@ -0,0 +1,258 @@
+/*
+ * MT25024 – micro-benchmark for the framed 8-field format (MT25024_Frame.h).
+ *
+ * Usage: ./frame_bench [msgSize] [seconds_per_case] [w0,..,w7]
+ *
+ * For each field-size profile (even, geometric, skewed and an optional custom one):
+ *   parse  – frame_parse() over a buffer of back-to-back frames, then a checksum of
+ *            every field read in place through its view (zero-copy) vs read from
+ *            a copy in its own heap buffer (what a fixed-iovec A2-style receive
+ *            ends up with); both read every payload byte, so GB/s compares
+ *   server – one response per call over an AF_UNIX socketpair drained by another
+ *            thread: A1-style pack into one buffer + send() vs A2-style sendmsg()
+ *            with the frame header and 8 field iovecs
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "MT25024_Frame.h"
+#include "MT25024_Proto.h"
+
+#define RING_FRAMES 64
+
+typedef struct {
+    const char *name;
+    unsigned w[FRAME_FIELDS];
+} profile_t;
+
+static double g_secs = 1.0;
+static volatile unsigned long long g_sink;   // keeps the parse loops from being optimised away
+
+/* ---------- parse ---------- */
+
+/* stands in for the application reading the field */
+static unsigned long long field_sum(const char *p, size_t n) {
+    unsigned long long s = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t w;
+        memcpy(&w, p + i, 8);
+        s += w;
+    }
+    for (; i < n; i++) s += (unsigned char)p[i];
+    return s;
+}
+
+static void bench_parse(const char *name, const size_t flen[FRAME_FIELDS], size_t msgSize) {
+    size_t frameLen = FRAME_HDR_LEN + msgSize;
+    char *ring = (char*)malloc(frameLen * RING_FRAMES);
+    char *out[FRAME_FIELDS];
+    for (int i = 0; i < FRAME_FIELDS; i++) out[i] = (char*)malloc(flen[i]);
+    if (!ring) { perror("malloc ring"); exit(1); }
+    for (int i = 0; i < FRAME_FIELDS; i++) if (!out[i]) { perror("malloc field"); exit(1); }
+
+    for (size_t f = 0; f < RING_FRAMES; f++) {
+        char *p = ring + f * frameLen;
+        frame_encode_hdr((unsigned char*)p, flen);
+        p += FRAME_HDR_LEN;
+        for (int i = 0; i < FRAME_FIELDS; i++) {
+            memset(p, 'A' + i, flen[i]);
+            p += flen[i];
+        }
+    }
+
+    for (int copy = 0; copy <= 1; copy++) {
+        unsigned long long frames = 0, sink = 0;
+        uint64_t t0 = mono_ns(), limit = t0 + (uint64_t)(g_secs * 1e9), now;
+        do {
+            for (size_t f = 0; f < RING_FRAMES; f++) {
+                frame_view_t v[FRAME_FIELDS];
+                size_t used;
+                if (frame_parse(ring + f * frameLen, frameLen, v, &used) != 1) {
+                    fprintf(stderr, "frame_parse failed\n");
+                    exit(1);
+                }
+                for (int i = 0; i < FRAME_FIELDS; i++) {
+                    if (copy) {
+                        memcpy(out[i], v[i].ptr, v[i].len);
+                        sink += field_sum(out[i], v[i].len);
+                    } else {
+                        sink += field_sum(v[i].ptr, v[i].len);
+                    }
+                }
+            }
+            frames += RING_FRAMES;
+            now = mono_ns();
+        } while (now < limit);
+
+        double secs = (double)(now - t0) / 1e9;
+        g_sink += sink;
+        printf("parse  %-9s %-6s frames/s=%.0f ns/frame=%.1f GB/s=%.2f\n",
+               name, copy ? "copy" : "views", (double)frames / secs, secs * 1e9 / (double)frames,
+               (double)frames * (double)msgSize / secs / 1e9);
+    }
+
+    for (int i = 0; i < FRAME_FIELDS; i++) free(out[i]);
+    free(ring);
+}
+
+/* ---------- server cost ---------- */
+
+static void *drain(void *arg) {
+    int fd = *(int*)arg;
+    static char buf[1 << 20];
+    for (;;) {
+        ssize_t r = recv(fd, buf, sizeof(buf), 0);
+        if (r == 0) break;
+        if (r < 0 && errno != EINTR) break;
+    }
+    return NULL;
+}
+
+static int send_all(int fd, const char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, buf, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        buf += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+static int sendmsg_all(int fd, struct iovec *iov, int iovcnt) {
+    while (iovcnt > 0) {
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = (size_t)iovcnt;
+        ssize_t n = sendmsg(fd, &msg, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        size_t left = (size_t)n;
+        while (iovcnt > 0 && left >= iov->iov_len) {
+            left -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (char*)iov->iov_base + left;
+            iov->iov_len -= left;
+        }
+    }
+    return 0;
+}
+
+static void bench_server(const char *name, const size_t flen[FRAME_FIELDS], size_t msgSize) {
+    unsigned char hdr[FRAME_HDR_LEN];
+    frame_encode_hdr(hdr, flen);
+
+    char *field[FRAME_FIELDS];
+    for (int i = 0; i < FRAME_FIELDS; i++) {
+        field[i] = (char*)malloc(flen[i]);
+        if (!field[i]) { perror("malloc field"); exit(1); }
+        memset(field[i], 'A' + i, flen[i]);
+    }
+    char *msgBuf = (char*)malloc(FRAME_HDR_LEN + msgSize);
+    if (!msgBuf) { perror("malloc msgBuf"); exit(1); }
+    memcpy(msgBuf, hdr, FRAME_HDR_LEN);
+
+    for (int mode = 0; mode <= 1; mode++) {
+        int sv[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) { perror("socketpair"); exit(1); }
+        pthread_t tid;
+        pthread_create(&tid, NULL, drain, &sv[1]);
+
+        unsigned long long msgs = 0;
+        uint64_t t0 = mono_ns(), limit = t0 + (uint64_t)(g_secs * 1e9), now;
+        do {
+            int rc;
+            if (mode == 0) {
+                // A1: pack the 8 fields behind the constant header, one send
+                size_t off = FRAME_HDR_LEN;
+                for (int i = 0; i < FRAME_FIELDS; i++) {
+                    memcpy(msgBuf + off, field[i], flen[i]);
+                    off += flen[i];
+                }
+                rc = send_all(sv[0], msgBuf, off);
+            } else {
+                // A2: header + 8 field iovecs, one sendmsg
+                struct iovec iov[1 + FRAME_FIELDS];
+                iov[0].iov_base = hdr;
+                iov[0].iov_len = sizeof(hdr);
+                for (int i = 0; i < FRAME_FIELDS; i++) {
+                    iov[1 + i].iov_base = field[i];
+                    iov[1 + i].iov_len = flen[i];
+                }
+                rc = sendmsg_all(sv[0], iov, 1 + FRAME_FIELDS);
+            }
+            if (rc != 0) { perror("send"); exit(1); }
+            msgs++;
+            now = mono_ns();
+        } while (now < limit);
+
+        shutdown(sv[0], SHUT_WR);
+        pthread_join(tid, NULL);
+        close(sv[0]);
+        close(sv[1]);
+
+        double secs = (double)(now - t0) / 1e9;
+        printf("server %-9s %-6s msgs/s=%.0f ns/response=%.1f GB/s=%.2f\n",
+               name, mode ? "iov" : "pack", (double)msgs / secs, secs * 1e9 / (double)msgs,
+               (double)msgs * (double)msgSize / secs / 1e9);
+    }
+
+    free(msgBuf);
+    for (int i = 0; i < FRAME_FIELDS; i++) free(field[i]);
+}
+
+int main(int argc, char **argv) {
+    size_t msgSize = 65536;
+    if (argc >= 2) msgSize = (size_t)strtoull(argv[1], NULL, 10);
+    if (argc >= 3) g_secs = atof(argv[2]);
+    if (msgSize < FRAME_FIELDS || msgSize > 0xffffffffu || g_secs <= 0) {
+        fprintf(stderr, "Usage: %s [msgSize (8..4294967295)] [seconds_per_case] [w0,..,w7]\n", argv[0]);
+        return 1;
+    }
+
+    profile_t profiles[4] = {
+        { "even",      { 1, 1, 1, 1, 1, 1, 1, 1 } },
+        { "geometric", { 1, 2, 4, 8, 16, 32, 64, 128 } },
+        { "skewed",    { 1, 1, 1, 1, 1, 1, 1, 1000 } },
+        { "custom",    { 0 } },
+    };
+    int nprof = 3;
+    if (argc >= 4) {
+        if (frame_parse_weights(argv[3], profiles[3].w) != 0) {
+            fprintf(stderr, "bad weights '%s' (8 comma-separated values, 1..1000000)\n", argv[3]);
+            return 1;
+        }
+        nprof = 4;
+    }
+
+    printf("# msgSize=%zu header=%d bytes, %.1f s per case\n", msgSize, FRAME_HDR_LEN, g_secs);
+    for (int p = 0; p < nprof; p++) {
+        size_t flen[FRAME_FIELDS];
+        if (frame_split(msgSize, profiles[p].w, flen) != 0) {
+            fprintf(stderr, "msgSize %zu too small for profile %s\n", msgSize, profiles[p].name);
+            continue;
+        }
+        printf("# %s fields:", profiles[p].name);
+        for (int i = 0; i < FRAME_FIELDS; i++) printf(" %zu", flen[i]);
+        printf("\n");
+        bench_parse(profiles[p].name, flen, msgSize);
+        bench_server(profiles[p].name, flen, msgSize);
+    }
+    return 0;
+}
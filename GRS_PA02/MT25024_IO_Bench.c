@@ -0,0 +1,558 @@
+/*
+ * MT25024 – micro-benchmark for the socket I/O helpers of the A1/A2/A3 programs.
+ *
+ * Usage: ./io_bench [seconds_per_case] [sizes] [iovcnts]
+ *        e.g. ./io_bench 0.5 4096,65536,1048576 1,8,64
+ *
+ * The helpers are static in each program, so the copies below follow them line for
+ * line (pacing and SO_SNDTIMEO handling left out, a syscall counter added):
+ *   send_all         A1/A2/A3 clients, A1 server   one buffer, send() until done
+ *   recv_all         A1/A2/A3 servers              one buffer, recv() until done
+ *   recv_all_until   A1 client                     recv_all plus a deadline check per call
+ *   sendmsg_all      A2 server                     copies the iovecs, consumes with memmove
+ *   recvmsg_all      A2/A3 clients                 the same on the receive side (<= 10 iovecs)
+ * next to the candidate
+ *   *_inplace        consumes the caller's iovec array in place: no copy, no memmove
+ *
+ * Every case runs over an AF_UNIX socketpair and over loopback TCP, with a second
+ * thread on the other end that drains (send cases) or sends flat out (recv cases).
+ *   ns/op        wall time per helper call; one call moves `size` bytes
+ *   syscalls/op  send/recv/sendmsg/recvmsg calls per helper call
+ *   bytes/cycle  size / CPU cycles of the calling thread (perf_event_open; user-space
+ *                cycles only if perf_event_paranoid forbids kernel counting)
+ * "consume" times the iovec bookkeeping alone, for transfers that stop every MSS bytes.
+ */
+#define _GNU_SOURCE
+#include <arpa/inet.h>
+#include <errno.h>
+#include <limits.h>
+#include <linux/perf_event.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "MT25024_Proto.h"
+
+#define MAX_LIST     16
+#define PEER_CHUNK   (1u << 20)
+#define CONSUME_STEP 1448   // one Ethernet MSS
+
+static double g_secs = 0.5;
+static unsigned long long g_calls;           // socket syscalls made by the measured thread
+static volatile unsigned long long g_sink;   // keeps the consume loops from being optimised away
+
+/* ---------- helpers as in the programs ---------- */
+
+static int send_all(int fd, const void *buf, size_t len) {
+    size_t sent = 0;
+    while (sent < len) {
+        ssize_t n = send(fd, (const char*)buf + sent, len - sent, MSG_NOSIGNAL);
+        g_calls++;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (n == 0) return -1;
+        sent += (size_t)n;
+    }
+    return 0;
+}
+
+static int recv_all(int fd, void *buf, size_t len) {
+    size_t got = 0;
+    while (got < len) {
+        ssize_t r = recv(fd, (char*)buf + got, len - got, 0);
+        g_calls++;
+        if (r == 0) return 0;
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        got += (size_t)r;
+    }
+    return 1;
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int recv_all_until(int fd, void *buf, size_t len, double deadline_sec) {
+    size_t got = 0;
+    while (got < len) {
+        if (now_sec() >= deadline_sec) return -2;
+
+        ssize_t r = recv(fd, (char *)buf + got, len - got, 0);
+        g_calls++;
+        if (r == 0) return 0; // peer closed
+
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) continue; // bounded by deadline check
+            return -1;
+        }
+
+        got += (size_t)r;
+    }
+    return 1;
+}
+
+static int sendmsg_all(int fd, const struct iovec *iov_in, int iovcnt_in) {
+    if (iovcnt_in > IOV_MAX) return -1;
+
+    struct iovec iov[IOV_MAX];
+    memcpy(iov, iov_in, (size_t)iovcnt_in * sizeof(struct iovec));
+    int iovcnt = iovcnt_in;
+
+    while (iovcnt > 0) {
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = (size_t)iovcnt;
+
+        ssize_t n = sendmsg(fd, &msg, MSG_NOSIGNAL);
+        g_calls++;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (n == 0) return -1;
+
+        size_t left = (size_t)n;
+        int idx = 0;
+        while (idx < iovcnt && left > 0) {
+            if (left >= iov[idx].iov_len) {
+                left -= iov[idx].iov_len;
+                idx++;
+            } else {
+                iov[idx].iov_base = (char*)iov[idx].iov_base + left;
+                iov[idx].iov_len -= left;
+                left = 0;
+            }
+        }
+        if (idx > 0) {
+            memmove(iov, iov + idx, (size_t)(iovcnt - idx) * sizeof(struct iovec));
+            iovcnt -= idx;
+        }
+    }
+    return 0;
+}
+
+static int recvmsg_all(int fd, const struct iovec *iov_in, int iovcnt_in) {
+    if (iovcnt_in > 10) return -1;
+
+    struct iovec iov[10];
+    memcpy(iov, iov_in, (size_t)iovcnt_in * sizeof(struct iovec));
+    int iovcnt = iovcnt_in;
+
+    while (iovcnt > 0) {
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = (size_t)iovcnt;
+
+        ssize_t n = recvmsg(fd, &msg, 0);
+        g_calls++;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (n == 0) return 0; // closed
+
+        size_t left = (size_t)n;
+        int idx = 0;
+        while (idx < iovcnt && left > 0) {
+            if (left >= iov[idx].iov_len) {
+                left -= iov[idx].iov_len;
+                idx++;
+            } else {
+                iov[idx].iov_base = (char*)iov[idx].iov_base + left;
+                iov[idx].iov_len -= left;
+                left = 0;
+            }
+        }
+        if (idx > 0) {
+            memmove(iov, iov + idx, (size_t)(iovcnt - idx) * sizeof(struct iovec));
+            iovcnt -= idx;
+        }
+    }
+    return 1;
+}
+
+/* ---------- in-place candidates ---------- */
+
+/* drop `left` bytes from the front of *iovp: advance the pointer, trim the first partial entry */
+static inline void consume_inplace(struct iovec **iovp, int *iovcnt, size_t left) {
+    struct iovec *iov = *iovp;
+    int cnt = *iovcnt;
+    while (cnt > 0 && left >= iov->iov_len) {
+        left -= iov->iov_len;
+        iov++;
+        cnt--;
+    }
+    if (cnt > 0) {
+        iov->iov_base = (char*)iov->iov_base + left;
+        iov->iov_len -= left;
+    }
+    *iovp = iov;
+    *iovcnt = cnt;
+}
+
+/* like sendmsg_all, but iov is the caller's scratch array and is consumed */
+static int sendmsg_all_inplace(int fd, struct iovec *iov, int iovcnt) {
+    while (iovcnt > 0) {
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = (size_t)(iovcnt > IOV_MAX ? IOV_MAX : iovcnt);
+
+        ssize_t n = sendmsg(fd, &msg, MSG_NOSIGNAL);
+        g_calls++;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (n == 0) return -1;
+        consume_inplace(&iov, &iovcnt, (size_t)n);
+    }
+    return 0;
+}
+
+static int recvmsg_all_inplace(int fd, struct iovec *iov, int iovcnt) {
+    while (iovcnt > 0) {
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = (size_t)(iovcnt > IOV_MAX ? IOV_MAX : iovcnt);
+
+        ssize_t n = recvmsg(fd, &msg, 0);
+        g_calls++;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (n == 0) return 0;
+        consume_inplace(&iov, &iovcnt, (size_t)n);
+    }
+    return 1;
+}
+
+/* ---------- harness ---------- */
+
+typedef enum {
+    H_SEND_ALL, H_RECV_ALL, H_RECV_ALL_UNTIL,
+    H_SENDMSG_ALL, H_SENDMSG_INPLACE, H_RECVMSG_ALL, H_RECVMSG_INPLACE,
+    H_COUNT
+} helper_t;
+
+static const struct {
+    const char *name;
+    bool recv;      // the peer feeds, the measured thread receives
+    bool vec;       // takes iovecs (run for every iovcnt)
+    int max_iov;
+} g_helpers[H_COUNT] = {
+    { "send_all",         false, false, 1 },
+    { "recv_all",         true,  false, 1 },
+    { "recv_all_until",   true,  false, 1 },
+    { "sendmsg_all",      false, true,  IOV_MAX },
+    { "sendmsg_inplace",  false, true,  INT_MAX },
+    { "recvmsg_all",      true,  true,  10 },
+    { "recvmsg_inplace",  true,  true,  INT_MAX },
+};
+
+typedef struct {
+    int fd;
+    bool feed;
+    char *buf;
+} peer_t;
+
+/* the other end: drain everything, or send flat out, until the measured side goes away */
+static void *peer_main(void *arg) {
+    peer_t *p = (peer_t*)arg;
+    for (;;) {
+        ssize_t r = p->feed ? send(p->fd, p->buf, PEER_CHUNK, MSG_NOSIGNAL) : recv(p->fd, p->buf, PEER_CHUNK, 0);
+        if (r == 0) break;
+        if (r < 0 && errno != EINTR) break;
+    }
+    return NULL;
+}
+
+static int make_pair(bool tcp, int sv[2]) {
+    if (!tcp) return socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+
+    int lfd = socket(AF_INET, SOCK_STREAM, 0);
+    if (lfd < 0) return -1;
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t alen = sizeof(addr);
+    if (bind(lfd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(lfd, 1) != 0 ||
+        getsockname(lfd, (struct sockaddr*)&addr, &alen) != 0) {
+        close(lfd);
+        return -1;
+    }
+    sv[0] = socket(AF_INET, SOCK_STREAM, 0);
+    if (sv[0] < 0 || connect(sv[0], (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        if (sv[0] >= 0) close(sv[0]);
+        close(lfd);
+        return -1;
+    }
+    sv[1] = accept(lfd, NULL, NULL);
+    close(lfd);
+    if (sv[1] < 0) {
+        close(sv[0]);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(sv[0], IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    setsockopt(sv[1], IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return 0;
+}
+
+/* cycles of the calling thread, kernel included if allowed; -1 if perf is unavailable */
+static int open_cycles(bool *user_only) {
+    struct perf_event_attr pe;
+    memset(&pe, 0, sizeof(pe));
+    pe.type = PERF_TYPE_HARDWARE;
+    pe.size = sizeof(pe);
+    pe.config = PERF_COUNT_HW_CPU_CYCLES;
+    pe.exclude_hv = 1;
+    pe.disabled = 1;
+
+    *user_only = false;
+    int fd = (int)syscall(SYS_perf_event_open, &pe, 0, -1, -1, 0);
+    if (fd < 0) {
+        pe.exclude_kernel = 1;
+        *user_only = true;
+        fd = (int)syscall(SYS_perf_event_open, &pe, 0, -1, -1, 0);
+    }
+    return fd;
+}
+
+/* split buf into iovcnt slices, the last one taking the remainder */
+static void fill_iov(struct iovec *iov, int iovcnt, char *buf, size_t size) {
+    size_t each = size / (size_t)iovcnt;
+    for (int i = 0; i < iovcnt; i++) {
+        iov[i].iov_base = buf + (size_t)i * each;
+        iov[i].iov_len = (i == iovcnt - 1) ? size - (size_t)i * each : each;
+    }
+}
+
+static int one_op(helper_t h, int fd, char *buf, size_t size, struct iovec *iov, int iovcnt) {
+    switch (h) {
+    case H_SEND_ALL:        return send_all(fd, buf, size) == 0 ? 0 : -1;
+    case H_RECV_ALL:        return recv_all(fd, buf, size) == 1 ? 0 : -1;
+    case H_RECV_ALL_UNTIL:  return recv_all_until(fd, buf, size, now_sec() + 1.0) == 1 ? 0 : -1;
+    case H_SENDMSG_ALL:
+        fill_iov(iov, iovcnt, buf, size);
+        return sendmsg_all(fd, iov, iovcnt);
+    case H_SENDMSG_INPLACE:
+        fill_iov(iov, iovcnt, buf, size);
+        return sendmsg_all_inplace(fd, iov, iovcnt);
+    case H_RECVMSG_ALL:
+        fill_iov(iov, iovcnt, buf, size);
+        return recvmsg_all(fd, iov, iovcnt) == 1 ? 0 : -1;
+    case H_RECVMSG_INPLACE:
+        fill_iov(iov, iovcnt, buf, size);
+        return recvmsg_all_inplace(fd, iov, iovcnt) == 1 ? 0 : -1;
+    default:
+        return -1;
+    }
+}
+
+static void run_case(bool tcp, helper_t h, size_t size, int iovcnt) {
+    int sv[2];
+    if (make_pair(tcp, sv) != 0) { perror(tcp ? "loopback tcp" : "socketpair"); exit(1); }
+
+    char *buf = (char*)malloc(size);
+    char *pbuf = (char*)malloc(PEER_CHUNK);
+    struct iovec *iov = (struct iovec*)malloc((size_t)iovcnt * sizeof(struct iovec));
+    if (!buf || !pbuf || !iov) { perror("malloc"); exit(1); }
+    memset(buf, 'A', size);
+    memset(pbuf, 'B', PEER_CHUNK);
+
+    peer_t peer = { .fd = sv[1], .feed = g_helpers[h].recv, .buf = pbuf };
+    pthread_t tid;
+    if (pthread_create(&tid, NULL, peer_main, &peer) != 0) { perror("pthread_create"); exit(1); }
+
+    // one untimed call so the socket buffers and page tables are warm
+    if (one_op(h, sv[0], buf, size, iov, iovcnt) != 0) { perror(g_helpers[h].name); exit(1); }
+
+    bool user_only = false;
+    int cfd = open_cycles(&user_only);
+    if (cfd >= 0) {
+        ioctl(cfd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(cfd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    unsigned long long ops = 0;
+    g_calls = 0;
+    uint64_t t0 = mono_ns(), limit = t0 + (uint64_t)(g_secs * 1e9), now;
+    do {
+        if (one_op(h, sv[0], buf, size, iov, iovcnt) != 0) { perror(g_helpers[h].name); exit(1); }
+        ops++;
+        now = mono_ns();
+    } while (now < limit);
+
+    long long cycles = -1;
+    if (cfd >= 0) {
+        ioctl(cfd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(cfd, &cycles, sizeof(cycles)) != (ssize_t)sizeof(cycles)) cycles = -1;
+        close(cfd);
+    }
+
+    // let the peer finish: EOF for a drainer, EPIPE / reset for a feeder
+    if (g_helpers[h].recv) {
+        close(sv[0]);
+    } else {
+        shutdown(sv[0], SHUT_WR);
+    }
+    pthread_join(tid, NULL);
+    if (!g_helpers[h].recv) close(sv[0]);
+    close(sv[1]);
+
+    char cyc[64];
+    if (cycles > 0)
+        snprintf(cyc, sizeof(cyc), "%s=%.3f", user_only ? "user_bytes_per_cycle" : "bytes_per_cycle",
+                 (double)ops * (double)size / (double)cycles);
+    else
+        snprintf(cyc, sizeof(cyc), "bytes_per_cycle=n/a");
+
+    char iovs[16];
+    if (g_helpers[h].vec) snprintf(iovs, sizeof(iovs), "%d", iovcnt);
+    else snprintf(iovs, sizeof(iovs), "-");
+
+    double secs = (double)(now - t0) / 1e9;
+    printf("%-4s %-16s size=%-8zu iov=%-4s ops/s=%.0f ns/op=%.1f syscalls/op=%.2f GB/s=%.2f %s\n",
+           tcp ? "tcp" : "unix", g_helpers[h].name, size, iovs, (double)ops / secs, secs * 1e9 / (double)ops,
+           (double)g_calls / (double)ops, (double)ops * (double)size / secs / 1e9, cyc);
+
+    free(iov);
+    free(pbuf);
+    free(buf);
+}
+
+/* iovec bookkeeping only: a transfer of size bytes that stops every CONSUME_STEP bytes */
+static void bench_consume(size_t size, int iovcnt) {
+    struct iovec *src = (struct iovec*)malloc((size_t)iovcnt * sizeof(struct iovec));
+    struct iovec *iov = (struct iovec*)malloc((size_t)iovcnt * sizeof(struct iovec));
+    char *buf = (char*)malloc(size);
+    if (!src || !iov || !buf) { perror("malloc"); exit(1); }
+    fill_iov(src, iovcnt, buf, size);
+
+    for (int inplace = 0; inplace <= 1; inplace++) {
+        unsigned long long ops = 0, sink = 0;
+        uint64_t t0 = mono_ns(), limit = t0 + (uint64_t)(g_secs * 1e9), now;
+        do {
+            int cnt = iovcnt;
+            size_t total = size;
+            if (inplace) {
+                fill_iov(iov, iovcnt, buf, size);
+                struct iovec *p = iov;
+                while (cnt > 0) {
+                    size_t step = total < CONSUME_STEP ? total : CONSUME_STEP;
+                    consume_inplace(&p, &cnt, step);
+                    total -= step;
+                }
+                sink += (uintptr_t)p;
+            } else {
+                // sendmsg_all: copy the caller's array, then index + memmove per partial transfer
+                fill_iov(src, iovcnt, buf, size);
+                memcpy(iov, src, (size_t)iovcnt * sizeof(struct iovec));
+                while (cnt > 0) {
+                    size_t step = total < CONSUME_STEP ? total : CONSUME_STEP;
+                    size_t left = step;
+                    int idx = 0;
+                    while (idx < cnt && left > 0) {
+                        if (left >= iov[idx].iov_len) {
+                            left -= iov[idx].iov_len;
+                            idx++;
+                        } else {
+                            iov[idx].iov_base = (char*)iov[idx].iov_base + left;
+                            iov[idx].iov_len -= left;
+                            left = 0;
+                        }
+                    }
+                    if (idx > 0) {
+                        memmove(iov, iov + idx, (size_t)(cnt - idx) * sizeof(struct iovec));
+                        cnt -= idx;
+                    }
+                    total -= step;
+                }
+                sink += (uintptr_t)iov[0].iov_base;
+            }
+            ops++;
+            now = mono_ns();
+        } while (now < limit);
+
+        double secs = (double)(now - t0) / 1e9;
+        g_sink += sink;
+        printf("-    %-16s size=%-8zu iov=%-4d steps/op=%zu ns/op=%.1f\n",
+               inplace ? "consume_inplace" : "consume_memmove", size, iovcnt,
+               (size + CONSUME_STEP - 1) / CONSUME_STEP, secs * 1e9 / (double)ops);
+    }
+
+    free(buf);
+    free(iov);
+    free(src);
+}
+
+/* comma-separated positive integers; returns the count or -1 */
+static int parse_list(const char *s, size_t *out, size_t lo, size_t hi) {
+    int n = 0;
+    while (*s) {
+        char *end;
+        errno = 0;
+        unsigned long long v = strtoull(s, &end, 10);
+        if (end == s || errno || v < lo || v > hi || n == MAX_LIST) return -1;
+        out[n++] = (size_t)v;
+        if (*end == ',') end++;
+        else if (*end) return -1;
+        s = end;
+    }
+    return n;
+}
+
+int main(int argc, char **argv) {
+    size_t sizes[MAX_LIST] = { 64, 4096, 65536, 1048576 };
+    size_t iovcnts[MAX_LIST] = { 1, 8, 64 };
+    int nsizes = 4, niov = 3;
+
+    if (argc >= 2) g_secs = atof(argv[1]);
+    if (argc >= 3) nsizes = parse_list(argv[2], sizes, 1, (size_t)1 << 30);
+    if (argc >= 4) niov = parse_list(argv[3], iovcnts, 1, IOV_MAX);
+    if (argc > 4 || g_secs <= 0 || nsizes <= 0 || niov <= 0) {
+        fprintf(stderr, "Usage: %s [seconds_per_case] [sizes (1..%zu, comma-separated)] "
+                        "[iovcnts (1..%d, comma-separated)]\n", argv[0], (size_t)1 << 30, IOV_MAX);
+        return 1;
+    }
+
+    printf("# %.2f s per case; recvmsg_all takes at most 10 iovecs, sendmsg_all at most IOV_MAX\n", g_secs);
+    for (int tcp = 0; tcp <= 1; tcp++) {
+        for (int h = 0; h < H_COUNT; h++) {
+            for (int s = 0; s < nsizes; s++) {
+                for (int v = 0; v < (g_helpers[h].vec ? niov : 1); v++) {
+                    int iovcnt = g_helpers[h].vec ? (int)iovcnts[v] : 1;
+                    if (iovcnt > g_helpers[h].max_iov || (size_t)iovcnt > sizes[s]) continue;
+                    run_case(tcp, (helper_t)h, sizes[s], iovcnt);
+                }
+            }
+        }
+    }
+    for (int s = 0; s < nsizes; s++)
+        for (int v = 0; v < niov; v++)
+            if (iovcnts[v] > 1 && iovcnts[v] <= sizes[s]) bench_consume(sizes[s], (int)iovcnts[v]);
+    return 0;
+}
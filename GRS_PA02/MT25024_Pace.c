@@ -0,0 +1,104 @@
+#include "MT25024_Pace.h"
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include "MT25024_Proto.h"
+
+#ifndef TCP_NOTSENT_LOWAT
+#define TCP_NOTSENT_LOWAT 25
+#endif
+#ifndef SO_MAX_PACING_RATE
+#define SO_MAX_PACING_RATE 47
+#endif
+
+int pace_init(pace_conn_t *p, int fd, size_t lowat, unsigned long long rate_mbps) {
+    memset(p, 0, sizeof(*p));
+    p->epfd = -1;
+    p->lowat = lowat;
+    p->rate_mbps = rate_mbps;
+
+    if (rate_mbps) {
+        // 64-bit rate where the kernel takes it, else the older 32-bit form (caps at ~34 Gbit/s)
+        unsigned long long bps = rate_mbps * 1000000ULL / 8ULL;
+        unsigned long lrate = (unsigned long)bps;
+        if (setsockopt(fd, SOL_SOCKET, SO_MAX_PACING_RATE, &lrate, sizeof(lrate)) != 0) {
+            uint32_t rate32 = bps > 0xffffffffULL ? 0xffffffffu : (uint32_t)bps;
+            if (setsockopt(fd, SOL_SOCKET, SO_MAX_PACING_RATE, &rate32, sizeof(rate32)) != 0) {
+                fprintf(stderr, "pace: SO_MAX_PACING_RATE: %s\n", strerror(errno));
+                return -1;
+            }
+        }
+    }
+
+    if (lowat) {
+        int v = lowat > 0x7fffffff ? 0x7fffffff : (int)lowat;
+        if (setsockopt(fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT, &v, sizeof(v)) != 0) {
+            fprintf(stderr, "pace: TCP_NOTSENT_LOWAT: %s\n", strerror(errno));
+            return -1;
+        }
+        p->epfd = epoll_create1(EPOLL_CLOEXEC);
+        if (p->epfd < 0) {
+            fprintf(stderr, "pace: epoll_create1: %s\n", strerror(errno));
+            return -1;
+        }
+        // level-triggered: EPOLLOUT is reported whenever unsent data is below lowat
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLOUT;
+        ev.data.fd = fd;
+        if (epoll_ctl(p->epfd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            fprintf(stderr, "pace: epoll_ctl: %s\n", strerror(errno));
+            close(p->epfd);
+            p->epfd = -1;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int pace_wait(pace_conn_t *p) {
+    uint64_t t0 = mono_ns();
+    struct epoll_event ev;
+    int n;
+    do {
+        n = epoll_wait(p->epfd, &ev, 1, PACE_WAIT_MS);
+    } while (n < 0 && errno == EINTR);
+
+    uint64_t dt = mono_ns() - t0;
+    p->waits++;
+    p->wait_ns += dt;
+    if (dt > p->max_wait_ns) p->max_wait_ns = dt;
+
+    if (n == 0) errno = EAGAIN;   // client stopped reading: same outcome as SO_SNDTIMEO
+    if (n <= 0) return -1;
+    if (ev.events & EPOLLERR) {
+        // a pending MSG_ZEROCOPY completion also raises EPOLLERR; only SO_ERROR is fatal
+        int err = 0;
+        socklen_t len = sizeof(err);
+        if (getsockopt(ev.data.fd, SOL_SOCKET, SO_ERROR, &err, &len) == 0 && err == 0) return 0;
+        errno = err ? err : EPIPE;
+        return -1;
+    }
+    if (ev.events & EPOLLHUP) {
+        errno = EPIPE;
+        return -1;
+    }
+    return 0;
+}
+
+void pace_print(FILE *fp, const char *tag, const pace_conn_t *p) {
+    if (!p->lowat && !p->rate_mbps) return;
+    fprintf(fp, "%s pace lowat=%zu pacing=%llu Mbps epollout_waits=%llu avg_wait=%.2f us max_wait=%.2f us\n",
+            tag, p->lowat, p->rate_mbps, p->waits,
+            p->waits ? (double)p->wait_ns / (double)p->waits / 1e3 : 0.0, (double)p->max_wait_ns / 1e3);
+}
+
+void pace_close(pace_conn_t *p) {
+    if (p->epfd >= 0) close(p->epfd);
+    p->epfd = -1;
+}
@@ -0,0 +1,56 @@
+/*
+ * MT25024 – paced send path for large responses (--lowat / --pacing on the servers).
+ *
+ * By default a server pushes a whole response into the socket as fast as send()
+ * accepts it, so up to a full send buffer of unsent data sits in front of the
+ * next response on that connection.
+ *   --lowat=BYTES  TCP_NOTSENT_LOWAT: the socket only reports writable while fewer
+ *                  than BYTES are queued but not yet sent. Sends use MSG_DONTWAIT and,
+ *                  on EAGAIN, the thread waits for EPOLLOUT on a per-connection epoll.
+ *   --pacing=MBPS  SO_MAX_PACING_RATE: the kernel spaces this connection's packets
+ *                  to at most MBPS Mbit/s (TCP internal pacing, or the fq qdisc).
+ */
+#ifndef MT25024_PACE_H
+#define MT25024_PACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/socket.h>
+
+#define PACE_WAIT_MS 1000   // same bound as the A1 server's SO_SNDTIMEO
+
+typedef struct {
+    int epfd;                     // -1: plain blocking sends
+    size_t lowat;                 // 0 = off
+    unsigned long long rate_mbps; // 0 = off
+    unsigned long long waits;     // EPOLLOUT waits
+    unsigned long long wait_ns;   // time spent in them
+    uint64_t max_wait_ns;
+} pace_conn_t;
+
+/*
+ * apply the options to a connected socket; with lowat == 0 and rate_mbps == 0 it
+ * only marks p as off. Returns -1 (with a message printed) if a socket option fails.
+ */
+int pace_init(pace_conn_t *p, int fd, size_t lowat, unsigned long long rate_mbps);
+
+/* extra send flags: MSG_DONTWAIT when the EPOLLOUT path is on (p may be NULL) */
+static inline int pace_flags(const pace_conn_t *p) {
+    return (p && p->epfd >= 0) ? MSG_DONTWAIT : 0;
+}
+
+/*
+ * a send with pace_flags() returned EAGAIN: wait until the socket is writable
+ * (unsent bytes below lowat). Returns 0 to retry the send, -1 on timeout or error.
+ * Also returns 0 when only the MSG_ZEROCOPY error queue is pending; the caller must
+ * drain it before waiting again, or the wait returns at once.
+ */
+int pace_wait(pace_conn_t *p);
+
+/* one line: lowat, pacing rate, number / average / max of the EPOLLOUT waits */
+void pace_print(FILE *fp, const char *tag, const pace_conn_t *p);
+
+void pace_close(pace_conn_t *p);
+
+#endif
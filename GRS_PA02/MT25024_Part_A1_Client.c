@@ -28,6 +28,7 @@ and debugging support.
 #include <errno.h>
 #include <netinet/tcp.h>   // TCP_NODELAY
 #include <pthread.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -36,13 +37,55 @@ and debugging support.
 #include <time.h>
 #include <unistd.h>
 
+#include "MT25024_Proto.h"
+#include "MT25024_Stats.h"
+#include "MT25024_TcpInfo.h"
+#include "MT25024_Stream.h"
+#include "MT25024_Frame.h"
+#include "MT25024_Verify.h"
+#include "MT25024_Capture.h"
+#include "MT25024_Soak.h"
+
 typedef struct {
     char server_ip[64];
     int port;
     size_t msgSize;
     int duration;   // seconds
+    int pipeline;   // triggers sent back-to-back before reading their responses (default 1)
+    bool timestamps; // --timestamps: server stamps each response, per-phase latency is reported
+    int tcpinfo_ms;  // --tcpinfo[=ms]: TCP_INFO sampling interval, 0 = off
+    int qos_class;   // --class=N: tag triggers with a QoS class for a --qos server (-1 = untagged)
+    size_t stream_chunk;// --stream=BYTES: request chunked, credit-paced responses (0 = off)
+    unsigned credits;// --credits=N: stream window in chunks
+    bool framed;     // --framed: length-prefixed responses, fields parsed as views into msgBuf
+    bool verify;     // --verify: check the sequence number + CRC32C trailer of every response
+    const char *capture_dir;   // --capture=DIR: per-thread ring file of per-request records
+    uint64_t capture_records;  // --capture-records=N: ring capacity
 } client_args_t;
 
+/* --timestamps: per-thread phase histograms are merged here and printed by main() */
+static ts_phases_t g_phases;
+static pthread_mutex_t g_phases_mu = PTHREAD_MUTEX_INITIALIZER;
+
+/* --tcpinfo: per-thread TCP_INFO summaries, merged the same way */
+static tcpinfo_stats_t g_tcpinfo;
+static pthread_mutex_t g_tcpinfo_mu = PTHREAD_MUTEX_INITIALIZER;
+
+/* --stream: TTFB / chunk gap / jitter / TTLB of all threads */
+static stream_stats_t g_stream_stats;
+static pthread_mutex_t g_stream_mu = PTHREAD_MUTEX_INITIALIZER;
+
+/* --verify: sequence / CRC32C check results of all threads */
+static verify_stats_t g_verify;
+static pthread_mutex_t g_verify_mu = PTHREAD_MUTEX_INITIALIZER;
+
+/* --class: RTT distribution of all threads, so per-class tail latency can be compared */
+static lat_hist_t g_rtt;
+static pthread_mutex_t g_rtt_mu = PTHREAD_MUTEX_INITIALIZER;
+
+/* --capture: threads whose ring file could not be created (exit status 1) */
+static int g_capture_failed = 0;
+
 /* monotonic clock in seconds */
 static double now_sec(void) {
     struct timespec ts;
@@ -133,52 +176,194 @@ static void *client_thread(void *arg) {
         return NULL;
     }
 
-    char *msgBuf = (char *)malloc(cfg->msgSize);
+    // timestamps mode: ts_header_t + payload + ts_trailer_t arrive as one unit;
+    // framed mode: frame header + payload
+    size_t hdrLen = cfg->timestamps ? sizeof(ts_header_t) : cfg->framed ? FRAME_HDR_LEN : 0;
+    size_t rxLen = hdrLen + cfg->msgSize + (cfg->timestamps ? sizeof(ts_trailer_t) : 0) +
+                   (cfg->verify ? VERIFY_TRAILER_LEN : 0);
+
+    ts_phases_t *phases = NULL;
+    if (cfg->timestamps) {
+        phases = (ts_phases_t *)calloc(1, sizeof(ts_phases_t));
+        if (!phases) {
+            perror("calloc phases");
+            close(sock);
+            return NULL;
+        }
+    }
+
+    char *msgBuf = (char *)malloc(rxLen);
     if (!msgBuf) {
+        free(phases);
         perror("malloc msgBuf");
         close(sock);
         return NULL;
     }
 
-    const char trigger[8] = {'P','I','N','G','P','I','N','G'};
+    // pipeline triggers go out in one send(); the responses are then read in order
+    size_t trig_len = 8 * (size_t)cfg->pipeline;
+    char *triggers = (char *)malloc(trig_len);
+    if (!triggers) {
+        perror("malloc triggers");
+        free(phases);
+        free(msgBuf);
+        close(sock);
+        return NULL;
+    }
+    for (size_t off = 0; off < trig_len; off += 8) memcpy(triggers + off, "PINGPING", 8);
+    if (cfg->qos_class >= 0) {
+        for (size_t off = 0; off < trig_len; off += 8)
+            qos_trigger_encode((unsigned char *)triggers + off, (unsigned)cfg->qos_class, cfg->msgSize);
+    }
+    if (cfg->stream_chunk) stream_req_encode(triggers, cfg->stream_chunk, cfg->credits); // pipeline is 1
 
     double start = now_sec();
     double end = start + (double)cfg->duration;
 
     unsigned long long bytes_tx = 0, bytes_rx = 0;
     unsigned long long msg_count = 0;
+    unsigned long long bad_fields = 0;
     double total_rtt_us = 0.0, max_rtt_us = 0.0;
+    frame_view_t views[FRAME_FIELDS];
+
+    // verify mode: the whole payload is one "field" for verify_check()
+    verify_stats_t vst;
+    memset(&vst, 0, sizeof(vst));
+    uint64_t vseq = 0;
+    char *vfield[8] = { msgBuf };
+    size_t vflen[8] = { cfg->msgSize };
+
+    lat_hist_t rtt_hist;
+    memset(&rtt_hist, 0, sizeof(rtt_hist));
+    stream_stats_t sst;
+    memset(&sst, 0, sizeof(sst));
+
+    tcpinfo_stats_t tinfo;
+    tcpinfo_init(&tinfo, (unsigned)cfg->tcpinfo_ms);
+
+    capture_ring_t cap;
+    memset(&cap, 0, sizeof(cap));
+    if (cfg->capture_dir && capture_open(&cap, cfg->capture_dir, "a1_client", cfg->capture_records, sock) != 0) {
+        fprintf(stderr, "[A1 client thread] --capture: no ring, this thread's requests are not recorded\n");
+        __atomic_add_fetch(&g_capture_failed, 1, __ATOMIC_RELAXED);
+    }
 
+    uint64_t t_loop = mono_ns();
     while (now_sec() < end) {
+        tcpinfo_maybe_sample(&tinfo, sock);
+
         struct timespec t1, t2;
         clock_gettime(CLOCK_MONOTONIC, &t1);
+        uint64_t t_send = (uint64_t)t1.tv_sec * 1000000000ULL + (uint64_t)t1.tv_nsec;
+
+        if (cfg->timestamps) {
+            uint64_t ts = mono_ns();
+            for (size_t off = 0; off < trig_len; off += 8) memcpy(triggers + off, &ts, 8);
+        }
 
-        int sret = send_all(sock, trigger, sizeof(trigger));
+        int sret = send_all(sock, triggers, trig_len);
         if (sret == -2) continue;          // timed out, retry until duration expires
         if (sret < 0) { perror("send"); break; }
-        bytes_tx += sizeof(trigger);
-
-        int rc = recv_all_until(sock, msgBuf, cfg->msgSize, end);
-        if (rc == -2) continue;            // deadline bounded
+        bytes_tx += trig_len;
+
+        // with pipeline > 1, RTT of each response is measured from the shared send time
+        int rc = 1;
+        for (int k = 0; k < cfg->pipeline; k++) {
+            if (cfg->stream_chunk)
+                rc = stream_recv(sock, cfg->msgSize, cfg->stream_chunk, cfg->credits, msgBuf, rxLen,
+                                 t_send, (uint64_t)(end * 1e9), &sst);
+            else if (cfg->framed)
+                rc = frame_recv(sock, msgBuf, rxLen, views, (uint64_t)(end * 1e9));
+            else
+                rc = recv_all_until(sock, msgBuf, rxLen, end);
+            if (rc != 1) break;
+
+            clock_gettime(CLOCK_MONOTONIC, &t2);
+            uint64_t t_done = (uint64_t)t2.tv_sec * 1000000000ULL + (uint64_t)t2.tv_nsec;
+
+            int bad = 0;
+            if (cfg->framed) {
+                int nbad = frame_views_check(views, cfg->msgSize);
+                bad_fields += (unsigned long long)nbad;
+                bad = nbad != 0;
+            }
+            if (cfg->verify)
+                bad = verify_check(vfield, vflen, (const unsigned char *)msgBuf + cfg->msgSize, &vseq, &vst) != 0;
+            capture_add(&cap, t_send, t_done, cfg->msgSize, bad ? EBADMSG : 0);
+
+            if (phases) {
+                ts_header_t h;
+                ts_trailer_t t;
+                memcpy(&h, msgBuf, sizeof(h));
+                memcpy(&t, msgBuf + hdrLen + cfg->msgSize, sizeof(t));
+                ts_phases_add(phases, &h, &t, t_done);
+            }
+
+            double rtt_us =
+                (t2.tv_sec - t1.tv_sec) * 1e6 +
+                (t2.tv_nsec - t1.tv_nsec) / 1e3;
+
+            total_rtt_us += rtt_us;
+            lat_hist_add(&rtt_hist, (unsigned long long)(rtt_us * 1e3));
+            msg_count++;
+            if (rtt_us > max_rtt_us) max_rtt_us = rtt_us;
+
+            bytes_rx += (unsigned long long)cfg->msgSize;
+        }
+        if (rc == -2) {            // deadline bounded
+            capture_add(&cap, t_send, mono_ns(), 0, ETIMEDOUT);
+            continue;
+        }
+        if (rc <= 0) capture_add(&cap, t_send, mono_ns(), 0, rc == 0 ? ECONNRESET : errno);
         if (rc == 0) break;                // server closed
         if (rc < 0) { perror("recv"); break; }
+    }
+    capture_close(&cap);
 
-        clock_gettime(CLOCK_MONOTONIC, &t2);
-
-        double rtt_us =
-            (t2.tv_sec - t1.tv_sec) * 1e6 +
-            (t2.tv_nsec - t1.tv_nsec) / 1e3;
+    if (cfg->stream_chunk) {
+        pthread_mutex_lock(&g_stream_mu);
+        stream_stats_merge(&g_stream_stats, &sst);
+        pthread_mutex_unlock(&g_stream_mu);
+    }
+    if (cfg->qos_class >= 0) {
+        pthread_mutex_lock(&g_rtt_mu);
+        lat_hist_merge(&g_rtt, &rtt_hist);
+        pthread_mutex_unlock(&g_rtt_mu);
+    }
 
-        total_rtt_us += rtt_us;
-        msg_count++;
-        if (rtt_us > max_rtt_us) max_rtt_us = rtt_us;
+    char framebuf[96] = "";
+    if (cfg->framed)
+        snprintf(framebuf, sizeof(framebuf), " frames=%llu bad_fields=%llu", msg_count, bad_fields);
+
+    char vbuf[96] = "";
+    if (cfg->verify) {
+        vst.loop_ns = mono_ns() - t_loop;
+        snprintf(vbuf, sizeof(vbuf), " seq_errors=%llu crc_errors=%llu", vst.seq_errors, vst.crc_errors);
+        pthread_mutex_lock(&g_verify_mu);
+        verify_stats_merge(&g_verify, &vst);
+        pthread_mutex_unlock(&g_verify_mu);
+    }
 
-        bytes_rx += (unsigned long long)cfg->msgSize;
+    char tcpbuf[2048] = "";
+    if (cfg->tcpinfo_ms > 0) {
+        tcpinfo_sample(&tinfo, sock);
+        tcpinfo_format(tcpbuf, sizeof(tcpbuf), &tinfo);
+        pthread_mutex_lock(&g_tcpinfo_mu);
+        tcpinfo_merge(&g_tcpinfo, &tinfo);
+        pthread_mutex_unlock(&g_tcpinfo_mu);
     }
 
     shutdown(sock, SHUT_WR);
     close(sock);
     free(msgBuf);
+    free(triggers);
+
+    if (phases) {
+        pthread_mutex_lock(&g_phases_mu);
+        ts_phases_merge(&g_phases, phases);
+        pthread_mutex_unlock(&g_phases_mu);
+        free(phases);
+    }
 
     double elapsed = now_sec() - start;
     if (elapsed <= 0) elapsed = 1e-9;
@@ -188,17 +373,39 @@ static void *client_thread(void *arg) {
 
     fprintf(stderr,
         "[A1 client thread] rx_bytes=%llu tx_bytes=%llu msgs=%llu time=%.2f sec "
-        "rx_throughput=%.3f Gbps avg_rtt=%.2f us max_rtt=%.2f us\n",
-        bytes_rx, bytes_tx, msg_count, elapsed, gbps_rx, avg_rtt_us, max_rtt_us);
+        "rx_throughput=%.3f Gbps avg_rtt=%.2f us max_rtt=%.2f us%s%s%s\n",
+        bytes_rx, bytes_tx, msg_count, elapsed, gbps_rx, avg_rtt_us, max_rtt_us, framebuf, vbuf, tcpbuf);
 
     return NULL;
 }
 
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "Usage: %s <server_ip> <port> <msgSize> <threads> <duration_sec> [pipeline_depth] [options]\n"
+        "  --timestamps   server must also run with --timestamps; prints per-phase latency\n"
+        "  --tcpinfo[=ms] sample TCP_INFO every ms (default %d) and append it to the output\n"
+        "  --class=N      tag requests with QoS class N (0..%d) for a server run with --qos;\n"
+        "                 prints the RTT percentiles of this class at the end\n"
+        "  --stream=BYTES server must run with --stream; responses arrive in BYTES chunks\n"
+        "                 paced by credits, prints TTFB / chunk gap / jitter / TTLB\n"
+        "  --credits=N    stream window in chunks (default %d)\n"
+        "  --framed       server must run with --framed; fields are located from the frame\n"
+        "                 header and checked in place, prints frames / bad_fields per thread\n"
+        "  --verify       server must run with --verify; checks each response's sequence\n"
+        "                 number and CRC32C, prints errors and the verification overhead\n"
+        "  --capture=DIR  each thread appends one record per request to a ring file in DIR\n"
+        "                 (read it back with capture_read)\n"
+        "  --capture-records=N  ring capacity per thread (default %u)\n"
+        "  --churn=SEC    reconnect every SEC seconds with fresh threads until duration_sec\n"
+        "                 has passed (long soak runs)\n"
+        "  --soak=MS      sample RSS / fds / threads / VmPin every MS ms into a CSV and flag\n"
+        "                 steady growth (see MT25024_Soak.h)\n",
+        prog, TCPINFO_DEFAULT_MS, QOS_MAX_CLASSES - 1, STREAM_DEFAULT_CREDITS, CAPTURE_DEFAULT_RECORDS);
+}
+
 int main(int argc, char **argv) {
-    if (argc != 6) {
-        fprintf(stderr,
-            "Usage: %s <server_ip> <port> <msgSize> <threads> <duration_sec>\n",
-            argv[0]);
+    if (argc < 6) {
+        usage(argv[0]);
         return 1;
     }
 
@@ -207,10 +414,88 @@ int main(int argc, char **argv) {
     size_t msgSize = (size_t)strtoull(argv[3], NULL, 10);
     int threads = atoi(argv[4]);
     int duration = atoi(argv[5]);
+    int pipeline = 1;
+    bool timestamps = false;
+    int tcpinfo_ms = 0;
+    int qos_class = -1;
+    size_t stream_chunk = 0;
+    unsigned credits = STREAM_DEFAULT_CREDITS;
+    bool framed = false;
+    bool verify = false;
+    const char *capture_dir = NULL;
+    uint64_t capture_records = CAPTURE_DEFAULT_RECORDS;
+    int soak_ms = 0;
+    int churn = 0;
+
+    for (int i = 6; i < argc; i++) {
+        int tcpinfo = tcpinfo_parse_opt(argv[i]);
+        if (strcmp(argv[i], "--timestamps") == 0) {
+            timestamps = true;
+        } else if (tcpinfo >= 0) {
+            tcpinfo_ms = tcpinfo;
+        } else if (strncmp(argv[i], "--class=", 8) == 0) {
+            qos_class = atoi(argv[i] + 8);
+        } else if (strncmp(argv[i], "--stream=", 9) == 0) {
+            stream_chunk = (size_t)strtoull(argv[i] + 9, NULL, 10);
+        } else if (strncmp(argv[i], "--credits=", 10) == 0) {
+            credits = (unsigned)atoi(argv[i] + 10);
+        } else if (strcmp(argv[i], "--framed") == 0) {
+            framed = true;
+        } else if (strcmp(argv[i], "--verify") == 0) {
+            verify = true;
+        } else if (strncmp(argv[i], "--capture=", 10) == 0) {
+            capture_dir = argv[i] + 10;
+        } else if (strncmp(argv[i], "--capture-records=", 18) == 0) {
+            capture_records = strtoull(argv[i] + 18, NULL, 10);
+        } else if (strncmp(argv[i], "--soak=", 7) == 0) {
+            soak_ms = atoi(argv[i] + 7);
+        } else if (strncmp(argv[i], "--churn=", 8) == 0) {
+            churn = atoi(argv[i] + 8);
+            if (churn <= 0) { usage(argv[0]); return 1; }
+        } else if (i == 6 && argv[i][0] != '-') {
+            pipeline = atoi(argv[i]);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
 
     if (threads <= 0) { fprintf(stderr, "threads must be > 0\n"); return 1; }
     if (duration <= 0) { fprintf(stderr, "duration must be > 0\n"); return 1; }
     if (msgSize < 8) { fprintf(stderr, "msgSize must be >= 8 bytes\n"); return 1; }
+    if (pipeline <= 0) { fprintf(stderr, "pipeline_depth must be > 0\n"); return 1; }
+    if (qos_class >= QOS_MAX_CLASSES) { fprintf(stderr, "--class must be 0..%d\n", QOS_MAX_CLASSES - 1); return 1; }
+    if (qos_class >= 0 && timestamps) { fprintf(stderr, "--class and --timestamps cannot be combined\n"); return 1; }
+    if (stream_chunk && (stream_chunk > 0xffffffffu || credits == 0 || credits > 0xffffu)) {
+        fprintf(stderr, "--stream chunk must be 1..4294967295 bytes and --credits 1..65535\n");
+        return 1;
+    }
+    if (stream_chunk && (pipeline > 1 || timestamps || qos_class >= 0)) {
+        fprintf(stderr, "--stream cannot be combined with pipelining, --timestamps or --class\n");
+        return 1;
+    }
+
+    if (framed && (timestamps || stream_chunk || qos_class >= 0)) {
+        fprintf(stderr, "--framed cannot be combined with --timestamps, --stream or --class\n");
+        return 1;
+    }
+    if (verify && (timestamps || stream_chunk || qos_class >= 0 || framed)) {
+        fprintf(stderr, "--verify cannot be combined with --timestamps, --stream, --class or --framed\n");
+        return 1;
+    }
+
+    if (capture_dir && (capture_records == 0 || capture_records > (1ULL << 32) || access(capture_dir, W_OK) != 0)) {
+        fprintf(stderr, "--capture needs a writable directory and --capture-records 1..4294967296\n");
+        return 1;
+    }
+    if (soak_ms && (soak_ms < SOAK_MIN_MS || soak_ms > SOAK_MAX_MS)) {
+        fprintf(stderr, "--soak must be %d..%d ms\n", SOAK_MIN_MS, SOAK_MAX_MS);
+        return 1;
+    }
+    if (churn && capture_dir) {
+        fprintf(stderr, "--churn cannot be combined with --capture (one ring file per thread per round)\n");
+        return 1;
+    }
 
     pthread_t *tids = (pthread_t *)malloc(sizeof(pthread_t) * (size_t)threads);
     if (!tids) { perror("malloc tids"); return 1; }
@@ -221,19 +506,56 @@ int main(int argc, char **argv) {
     cfg.port = port;
     cfg.msgSize = msgSize;
     cfg.duration = duration;
+    cfg.pipeline = pipeline;
+    cfg.timestamps = timestamps;
+    cfg.tcpinfo_ms = tcpinfo_ms;
+    cfg.qos_class = qos_class;
+    cfg.stream_chunk = stream_chunk;
+    cfg.credits = credits;
+    cfg.framed = framed;
+    cfg.verify = verify;
+    cfg.capture_dir = capture_dir;
+    cfg.capture_records = capture_records;
+
+    if (soak_ms && soak_start("[A1 client]", "a1_client", (unsigned)soak_ms) != 0) {
+        free(tids);
+        return 1;
+    }
 
-    for (int i = 0; i < threads; i++) {
-        if (pthread_create(&tids[i], NULL, client_thread, &cfg) != 0) {
-            perror("pthread_create");
-            free(tids);
-            return 1;
+    // --churn: fresh threads and connections every churn seconds until duration has passed
+    for (int done = 0; done < duration; done += cfg.duration) {
+        cfg.duration = (churn && duration - done > churn) ? churn : duration - done;
+        for (int i = 0; i < threads; i++) {
+            if (pthread_create(&tids[i], NULL, client_thread, &cfg) != 0) {
+                perror("pthread_create");
+                free(tids);
+                return 1;
+            }
+        }
+
+        for (int i = 0; i < threads; i++) {
+            pthread_join(tids[i], NULL);
         }
     }
+    soak_stop();
 
-    for (int i = 0; i < threads; i++) {
-        pthread_join(tids[i], NULL);
+    if (timestamps) ts_phases_print(stderr, "[A1 client]", &g_phases);
+    if (tcpinfo_ms > 0) {
+        char buf[2048];
+        fprintf(stderr, "[A1 client] tcp_info:%s\n", tcpinfo_format(buf, sizeof(buf), &g_tcpinfo));
+    }
+    if (stream_chunk) stream_stats_print(stderr, "[A1 client]", &g_stream_stats);
+    if (verify) verify_stats_print(stderr, "[A1 client]", &g_verify);
+    if (qos_class >= 0) {
+        char label[64];
+        snprintf(label, sizeof(label), "[A1 client] class=%d rtt", qos_class);
+        lat_hist_print(stderr, label, &g_rtt);
     }
 
     free(tids);
+    if (g_capture_failed) {
+        fprintf(stderr, "[A1 client] --capture: %d thread(s) ran without a ring\n", g_capture_failed);
+        return 1;
+    }
     return 0;
 }
@@ -22,8 +22,10 @@ and debugging support.
 
 #include <arpa/inet.h>
 #include <errno.h>
+#include <limits.h>        // IOV_MAX
 #include <netinet/tcp.h>   // TCP_NODELAY (optional)
 #include <pthread.h>
+#include <signal.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -32,6 +34,20 @@ and debugging support.
 #include <sys/time.h>      // timeval
 #include <unistd.h>
 
+#include "MT25024_Proto.h"
+#include "MT25024_Stats.h"
+#include "MT25024_TcpInfo.h"
+#include "MT25024_Sched.h"
+#include "MT25024_Stream.h"
+#include "MT25024_Frame.h"
+#include "MT25024_Verify.h"
+#include "MT25024_Pace.h"
+#include "MT25024_Soak.h"
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
 #define SERVERPORT 8989
 #define BUFSIZE 4096
 #define SERVER_BACKLOG 128
@@ -40,6 +56,27 @@ typedef struct sockaddr_in SA_IN;
 typedef struct sockaddr SA;
 
 static size_t g_msgSize = BUFSIZE;   // runtime message size (bytes)
+static bool g_batch = false;         // --batch: drain queued triggers, one send per batch
+static bool g_timestamps = false;    // --timestamps: ts_header_t before / ts_trailer_t after payload
+static int g_tcpinfo_ms = 0;         // --tcpinfo[=ms]: sample TCP_INFO per connection (0 = off)
+static bool g_qos = false;           // --qos[=w0,w1,..]: DRR send scheduling across trigger classes
+static const char *g_qos_weights = NULL; // per-class weights (default 1 each)
+static unsigned g_qos_slots = 1;     // --qos-slots=N: responses allowed to send at once
+static bool g_stream = false;        // --stream: serve stream requests in credit-paced chunks
+static bool g_framed = false;        // --framed[=w0,..,w7]: length-prefixed response, weighted field sizes
+static const char *g_frame_weights = NULL; // per-field weights (default even split)
+static size_t g_flen[FRAME_FIELDS];  // field lengths, split once in main
+static bool g_verify = false;        // --verify: sequence number + CRC32C trailer on every response
+static int g_port = SERVERPORT;      // --port=N: listen port (several instances for fan-out)
+static size_t g_lowat = 0;           // --lowat=BYTES: TCP_NOTSENT_LOWAT + EPOLLOUT-driven sends (0 = off)
+static unsigned long long g_pacing_mbps = 0; // --pacing=MBPS: SO_MAX_PACING_RATE per connection (0 = off)
+static unsigned g_soak_ms = 0;               // --soak=MS: sample RSS/fds/threads/VmPin until SIGINT/SIGTERM (0 = off)
+static volatile sig_atomic_t g_stop = 0;     // --soak/--qos: set by SIGINT/SIGTERM to end the accept loop
+static qos_sched_t g_sched;
+
+/* batch mode limits: same message cap as A2/A3 (IOV_MAX/8) and ~4MB per pack buffer */
+#define BATCH_MAX_MSGS  (IOV_MAX / 8)
+#define BATCH_MAX_BYTES (4ULL * 1024ULL * 1024ULL)
 
 /* recv exactly len bytes into buf (handles partial recv) */
 static int recv_all(int fd, void *buf, size_t len) {
@@ -60,13 +97,17 @@ static int recv_all(int fd, void *buf, size_t len) {
  * send entire buffer (handles partial send)
  * Uses MSG_NOSIGNAL so server is not killed by SIGPIPE.
  * Also handles SO_SNDTIMEO timeout as a graceful failure.
+ * If calls != NULL, the number of send() syscalls is added to it.
+ * With --lowat, sends do not block; a full socket waits for EPOLLOUT in pace_wait().
  */
-static int send_all(int fd, const void *buf, size_t len) {
+static int send_all(int fd, const void *buf, size_t len, unsigned long long *calls, pace_conn_t *pc) {
     size_t sent = 0;
     while (sent < len) {
-        ssize_t n = send(fd, (const char*)buf + sent, len - sent, MSG_NOSIGNAL);
+        ssize_t n = send(fd, (const char*)buf + sent, len - sent, MSG_NOSIGNAL | pace_flags(pc));
+        if (calls) (*calls)++;
         if (n < 0) {
             if (errno == EINTR) continue;
+            if ((errno == EAGAIN || errno == EWOULDBLOCK) && pace_flags(pc) && pace_wait(pc) == 0) continue;
             if (errno == EAGAIN || errno == EWOULDBLOCK) return -1; // timed out
             return -1;
         }
@@ -90,16 +131,12 @@ static void free_msg8(msg8_t *m) {
     }
 }
 
-static int alloc_msg8(msg8_t *m, size_t total) {
+/* flen[] comes from frame_split(): the even base/rem split unless --framed weights it */
+static int alloc_msg8(msg8_t *m, const size_t flen[8]) {
     memset(m, 0, sizeof(*m));
-    if (total < 8) return -1;
-
-    size_t base = total / 8;
-    size_t rem  = total % 8;
 
     for (int i = 0; i < 8; i++) {
-        m->flen[i] = base + ((i == 7) ? rem : 0);
-        if (m->flen[i] == 0) m->flen[i] = 1;
+        m->flen[i] = flen[i];
 
         m->field[i] = (char*)malloc(m->flen[i]);
         if (!m->field[i]) {
@@ -117,6 +154,92 @@ static void fill_msg8(msg8_t *m) {
     }
 }
 
+/* qos / stream mode: the packed response goes out one chunk at a time */
+typedef struct {
+    int fd;
+    const char *buf;
+    pace_conn_t *pace;
+} chunk_ctx_t;
+
+static int send_chunk(void *arg, size_t off, size_t len) {
+    const chunk_ctx_t *c = (const chunk_ctx_t*)arg;
+    return send_all(c->fd, c->buf + off, len, NULL, c->pace) < 0 ? -1 : 0;
+}
+
+/* --tcpinfo: one last sample, then the per-connection summary */
+static void print_tcpinfo(int fd, tcpinfo_stats_t *ti) {
+    if (ti->interval_ns == 0) return;
+    tcpinfo_sample(ti, fd);
+    char buf[2048];
+    fprintf(stderr, "[A1 server] tcp_info:%s\n", tcpinfo_format(buf, sizeof(buf), ti));
+}
+
+/*
+ * Batch mode: a single recv() into a large buffer returns every trigger already
+ * queued on the socket. All of their responses are packed (still one copy per
+ * response, as in the normal A1 path) into one buffer and sent with one send_all().
+ * Bytes that do not fit in this batch (a partial trigger, or more than the batch
+ * cap) stay in rx[] for the next round.
+ */
+static void serve_batched(int fd, msg8_t *m, tcpinfo_stats_t *ti, pace_conn_t *pc) {
+    size_t cap = (size_t)(BATCH_MAX_BYTES / g_msgSize);
+    if (cap < 1) cap = 1;
+    if (cap > BATCH_MAX_MSGS) cap = BATCH_MAX_MSGS;
+
+    char *batchBuf = (char*)malloc(cap * g_msgSize);
+    if (!batchBuf) {
+        perror("malloc batchBuf");
+        return;
+    }
+
+    char rx[BATCH_MAX_MSGS * 8];
+    size_t have = 0;
+
+    batch_stats_t st;
+    memset(&st, 0, sizeof(st));
+
+    bool open = true;
+    while (open) {
+        while (have < 8) {
+            ssize_t r = recv(fd, rx + have, sizeof(rx) - have, 0);
+            if (r == 0) { open = false; break; }    // client closed
+            if (r < 0) {
+                if (errno == EINTR) continue;
+                perror("recv");
+                open = false;
+                break;
+            }
+            st.recv_calls++;
+            have += (size_t)r;
+        }
+        if (!open) break;
+
+        size_t k = have / 8;
+        if (k > cap) k = cap;
+
+        // pack 8 heap fields -> contiguous buffer, once per queued trigger
+        size_t off = 0;
+        for (size_t j = 0; j < k; j++) {
+            for (int i = 0; i < 8; i++) {
+                memcpy(batchBuf + off, m->field[i], m->flen[i]);
+                off += m->flen[i];
+            }
+        }
+
+        if (send_all(fd, batchBuf, off, &st.send_calls, pc) < 0) break;
+        tcpinfo_maybe_sample(ti, fd);
+
+        st.msgs += k;
+        log2_hist_add(&st.batch, k);
+
+        have -= k * 8;
+        memmove(rx, rx + k * 8, have);
+    }
+
+    batch_stats_print(stderr, "[A1 server]", &st);
+    free(batchBuf);
+}
+
 static void *handle_connection(void *arg) {
     int clientSocket = *(int*)arg;
     free(arg);
@@ -125,6 +248,9 @@ static void *handle_connection(void *arg) {
     int one = 1;
     setsockopt(clientSocket, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
 
+    tcpinfo_stats_t tinfo;
+    tcpinfo_init(&tinfo, (unsigned)g_tcpinfo_ms);
+
     // Prevent a stuck send() if client stops reading
     struct timeval tv;
     tv.tv_sec = 1;
@@ -133,14 +259,16 @@ static void *handle_connection(void *arg) {
 
     // Allocate 8 heap fields once per connection (requirement satisfied)
     msg8_t m;
-    if (alloc_msg8(&m, g_msgSize) != 0) {
+    if (alloc_msg8(&m, g_flen) != 0) {
         perror("alloc_msg8");
         close(clientSocket);
         return NULL;
     }
 
-    // Single contiguous buffer used for A1 send()
-    char *msgBuf = (char*)malloc(g_msgSize);
+    // Single contiguous buffer used for A1 send() (room for the timestamp / frame header in front)
+    size_t hdrLen = g_timestamps ? sizeof(ts_header_t) : g_framed ? FRAME_HDR_LEN : 0;
+    size_t tlrLen = g_verify ? VERIFY_TRAILER_LEN : 0;
+    char *msgBuf = (char*)malloc(hdrLen + g_msgSize + tlrLen);
     if (!msgBuf) {
         perror("malloc msgBuf");
         free_msg8(&m);
@@ -150,36 +278,136 @@ static void *handle_connection(void *arg) {
 
     fill_msg8(&m);
 
+    // framed mode: field lengths never change, so the header is written once
+    if (g_framed) frame_encode_hdr((unsigned char*)msgBuf, m.flen);
+
+    pace_conn_t pace;
+    if (pace_init(&pace, clientSocket, g_lowat, g_pacing_mbps) != 0) {
+        pace_close(&pace);
+        free(msgBuf);
+        free_msg8(&m);
+        close(clientSocket);
+        return NULL;
+    }
+
+    if (g_batch) {
+        serve_batched(clientSocket, &m, &tinfo, &pace);
+        print_tcpinfo(clientSocket, &tinfo);
+        pace_print(stderr, "[A1 server]", &pace);
+        pace_close(&pace);
+        free(msgBuf);
+        free_msg8(&m);
+        close(clientSocket);
+        return NULL;
+    }
+
+    stream_srv_stats_t sst;
+    memset(&sst, 0, sizeof(sst));
+    verify_stats_t vst;
+    memset(&vst, 0, sizeof(vst));
+    uint64_t vseq = 0;
+    uint64_t t_loop = mono_ns();
+
     char trigger[8];
 
     while (true) {
         int rc = recv_all(clientSocket, trigger, sizeof(trigger));
         if (rc == 0) break;                // client closed
         if (rc < 0) { perror("recv"); break; }
+        tcpinfo_maybe_sample(&tinfo, clientSocket);
+        uint64_t t_recv = (g_timestamps || g_qos) ? mono_ns() : 0;
+
+        // qos mode: a tagged trigger carries its class and may ask for fewer bytes
+        unsigned cls = 0;
+        size_t respLen = g_msgSize;
+        if (g_qos && qos_parse_trigger(trigger, g_msgSize, &cls, &respLen) != 0) {
+            fprintf(stderr, "[A1 server] bad qos trigger (class or size out of range)\n");
+            break;
+        }
+
+        // stream mode: a stream request gets the response in credit-paced chunks
+        size_t chunk = 0;
+        unsigned credits = 0;
+        bool streamed = g_stream && stream_req_decode(trigger, &chunk, &credits);
+        if (streamed && (chunk == 0 || credits == 0)) {
+            fprintf(stderr, "[A1 server] bad stream request (chunk=%zu credits=%u)\n", chunk, credits);
+            break;
+        }
 
         // pack 8 heap fields -> one contiguous buffer EVERY trigger
         size_t off = 0;
-        for (int i = 0; i < 8; i++) {
-            memcpy(msgBuf + off, m.field[i], m.flen[i]);
-            off += m.flen[i];
+        for (int i = 0; i < 8 && off < respLen; i++) {
+            size_t n = m.flen[i] < respLen - off ? m.flen[i] : respLen - off;
+            memcpy(msgBuf + hdrLen + off, m.field[i], n);
+            off += n;
         }
-        if (off != g_msgSize) {
-            fprintf(stderr, "[A1 server] pack error: off=%zu msgSize=%zu\n", off, g_msgSize);
+        if (off != respLen) {
+            fprintf(stderr, "[A1 server] pack error: off=%zu msgSize=%zu\n", off, respLen);
             break;
         }
 
-        if (send_all(clientSocket, msgBuf, g_msgSize) < 0) {
+        // verify mode: the sequence number overwrites the first payload bytes of this
+        // pack, and the CRC covers exactly what goes on the wire
+        if (g_verify) {
+            uint64_t t0 = mono_ns();
+            char *payload = msgBuf + hdrLen;
+            wire_put_be64(payload, vseq++);
+            verify_trailer_encode((unsigned char*)payload + respLen, crc32c(0, payload, respLen));
+            vst.verify_ns += mono_ns() - t0;
+            vst.msgs++;
+            vst.bytes += respLen;
+        }
+
+        // timestamps mode: send_start is taken after the pack, so the pack copy shows up
+        // in the client's server-side phase
+        if (g_timestamps) {
+            ts_header_t h;
+            memcpy(&h.client_send_ns, trigger, sizeof(h.client_send_ns));
+            h.server_recv_ns = t_recv;
+            h.send_start_ns = mono_ns();
+            memcpy(msgBuf, &h, sizeof(h));
+        }
+
+        int src;
+        if (streamed) {
+            chunk_ctx_t ch = { clientSocket, msgBuf, &pace };
+            src = stream_send(clientSocket, respLen, chunk, credits, send_chunk, &ch, &sst);
+        } else if (g_qos) {
+            chunk_ctx_t ch = { clientSocket, msgBuf, &pace };
+            src = qos_send(&g_sched, cls, respLen, t_recv, send_chunk, &ch);
+        } else {
+            src = send_all(clientSocket, msgBuf, hdrLen + respLen + tlrLen, NULL, &pace);
+        }
+        if (src < 0) {
             // client may have stopped reading / closed; exit this thread cleanly
             break;
         }
+
+        if (g_timestamps) {
+            ts_trailer_t t = { .send_complete_ns = mono_ns() };
+            if (send_all(clientSocket, &t, sizeof(t), NULL, &pace) < 0) break;
+        }
     }
 
+    print_tcpinfo(clientSocket, &tinfo);
+    if (g_stream) stream_srv_print(stderr, "[A1 server]", &sst);
+    if (g_verify) {
+        vst.loop_ns = mono_ns() - t_loop;
+        verify_stats_print(stderr, "[A1 server]", &vst);
+    }
+    pace_print(stderr, "[A1 server]", &pace);
+    pace_close(&pace);
     free(msgBuf);
     free_msg8(&m);
     close(clientSocket);
     return NULL;
 }
 
+static void on_stop(int sig) {
+    (void)sig;
+    g_stop = 1;
+}
+
 int main(int argc, char **argv) {
     int serverSocket;
     SA_IN server_addr, client_addr;
@@ -189,6 +417,76 @@ int main(int argc, char **argv) {
         if (v > 0) g_msgSize = (size_t)v;
     }
 
+    for (int i = 2; i < argc; i++) {
+        int tcpinfo = tcpinfo_parse_opt(argv[i]);
+        if (strcmp(argv[i], "--batch") == 0) {
+            g_batch = true;
+        } else if (strcmp(argv[i], "--timestamps") == 0) {
+            g_timestamps = true;
+        } else if (tcpinfo >= 0) {
+            g_tcpinfo_ms = tcpinfo;
+        } else if (strcmp(argv[i], "--qos") == 0 || strncmp(argv[i], "--qos=", 6) == 0) {
+            g_qos = true;
+            if (argv[i][5] == '=') g_qos_weights = argv[i] + 6;
+        } else if (strncmp(argv[i], "--qos-slots=", 12) == 0) {
+            g_qos_slots = (unsigned)atoi(argv[i] + 12);
+        } else if (strcmp(argv[i], "--stream") == 0) {
+            g_stream = true;
+        } else if (strcmp(argv[i], "--framed") == 0 || strncmp(argv[i], "--framed=", 9) == 0) {
+            g_framed = true;
+            if (argv[i][8] == '=') g_frame_weights = argv[i] + 9;
+        } else if (strcmp(argv[i], "--verify") == 0) {
+            g_verify = true;
+        } else if (strncmp(argv[i], "--port=", 7) == 0) {
+            g_port = atoi(argv[i] + 7);
+        } else if (strncmp(argv[i], "--lowat=", 8) == 0) {
+            g_lowat = (size_t)strtoull(argv[i] + 8, NULL, 10);
+            if (g_lowat == 0) { fprintf(stderr, "ERROR: --lowat must be > 0 bytes\n"); return 1; }
+        } else if (strncmp(argv[i], "--pacing=", 9) == 0) {
+            g_pacing_mbps = strtoull(argv[i] + 9, NULL, 10);
+            if (g_pacing_mbps == 0) { fprintf(stderr, "ERROR: --pacing must be > 0 Mbit/s\n"); return 1; }
+        } else if (strncmp(argv[i], "--soak=", 7) == 0) {
+            g_soak_ms = (unsigned)strtoul(argv[i] + 7, NULL, 10);
+            if (g_soak_ms < SOAK_MIN_MS || g_soak_ms > SOAK_MAX_MS) {
+                fprintf(stderr, "ERROR: --soak must be %d..%d ms\n", SOAK_MIN_MS, SOAK_MAX_MS);
+                return 1;
+            }
+        } else {
+            fprintf(stderr, "Usage: %s <msg_size> [--batch] [--timestamps] [--tcpinfo[=ms]] "
+                            "[--qos[=w0,w1,w2,w3]] [--qos-slots=N] [--stream] [--framed[=w0,..,w7]] [--verify] "
+                            "[--port=N] [--lowat=BYTES] [--pacing=MBPS] [--soak=MS]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+
+    if (g_batch && g_timestamps) {
+        fprintf(stderr, "ERROR: --batch and --timestamps cannot be combined\n");
+        return 1;
+    }
+
+    if (g_qos && (g_batch || g_timestamps)) {
+        fprintf(stderr, "ERROR: --qos cannot be combined with --batch or --timestamps\n");
+        return 1;
+    }
+    if (g_stream && (g_batch || g_timestamps || g_qos)) {
+        fprintf(stderr, "ERROR: --stream cannot be combined with --batch, --timestamps or --qos\n");
+        return 1;
+    }
+    if (g_framed && (g_batch || g_timestamps || g_qos || g_stream)) {
+        fprintf(stderr, "ERROR: --framed cannot be combined with --batch, --timestamps, --qos or --stream\n");
+        return 1;
+    }
+    if (g_verify && (g_batch || g_timestamps || g_qos || g_stream || g_framed)) {
+        fprintf(stderr, "ERROR: --verify cannot be combined with --batch, --timestamps, --qos, --stream or --framed\n");
+        return 1;
+    }
+    if (g_qos && (g_qos_slots == 0 || qos_init(&g_sched, g_qos_weights, g_qos_slots) != 0)) {
+        fprintf(stderr, "ERROR: bad --qos weights or --qos-slots (weights: 1..1000, up to %d classes)\n",
+                QOS_MAX_CLASSES);
+        return 1;
+    }
+
     if (g_msgSize < 8) {
         fprintf(stderr, "ERROR: Message size must be at least 8 bytes (got %zu)\n", g_msgSize);
         return 1;
@@ -200,6 +498,21 @@ int main(int argc, char **argv) {
         return 1;
     }
 
+    if (g_port <= 0 || g_port > 65535) {
+        fprintf(stderr, "ERROR: --port must be 1..65535\n");
+        return 1;
+    }
+
+    unsigned weights[FRAME_FIELDS];
+    if (g_frame_weights && frame_parse_weights(g_frame_weights, weights) != 0) {
+        fprintf(stderr, "ERROR: bad --framed weights (8 comma-separated values, 1..1000000)\n");
+        return 1;
+    }
+    if (frame_split(g_msgSize, g_frame_weights ? weights : NULL, g_flen) != 0) {
+        fprintf(stderr, "ERROR: Message size %zu too small for the --framed weights\n", g_msgSize);
+        return 1;
+    }
+
     serverSocket = socket(AF_INET, SOCK_STREAM, 0);
     if (serverSocket < 0) {
         perror("socket");
@@ -212,7 +525,7 @@ int main(int argc, char **argv) {
     memset(&server_addr, 0, sizeof(server_addr));
     server_addr.sin_family = AF_INET;
     server_addr.sin_addr.s_addr = htonl(INADDR_ANY);
-    server_addr.sin_port = htons(SERVERPORT);
+    server_addr.sin_port = htons((uint16_t)g_port);
 
     if (bind(serverSocket, (SA*)&server_addr, sizeof(server_addr)) < 0) {
         perror("bind");
@@ -226,12 +539,30 @@ int main(int argc, char **argv) {
         return 1;
     }
 
-    fprintf(stderr, "[A1 server] listening on port %d, msgSize=%zu bytes\n", SERVERPORT, g_msgSize);
+    fprintf(stderr, "[A1 server] listening on port %d, msgSize=%zu bytes%s%s%s%s\n",
+            g_port, g_msgSize, g_batch ? " (batch mode)" : "",
+            g_timestamps ? " (timestamps)" : "",
+            g_qos ? " (qos)" : g_stream ? " (stream)" : g_framed ? " (framed)" : "",
+            g_verify ? " (verify)" : "");
+
+    if (g_soak_ms || g_qos) {
+        // no SA_RESTART: the signal interrupts accept() so the loop ends and the
+        // soak trend / qos totals are printed once
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = on_stop;
+        sigaction(SIGINT, &sa, NULL);
+        sigaction(SIGTERM, &sa, NULL);
+    }
+    if (g_soak_ms) {
+        if (soak_start("[A1 server]", "a1_server", g_soak_ms) != 0) return 1;
+    }
 
-    while (true) {
+    while (!g_stop) {
         socklen_t addr_size = sizeof(SA_IN);
         int clientSocket = accept(serverSocket, (SA*)&client_addr, &addr_size);
         if (clientSocket < 0) {
+            if (errno == EINTR) continue;
             perror("accept");
             continue;
         }
@@ -254,6 +585,8 @@ int main(int argc, char **argv) {
         pthread_detach(tid);
     }
 
+    soak_stop();
+    if (g_qos) qos_print(stderr, "[A1 server]", &g_sched);
     close(serverSocket);
     return 0;
 }
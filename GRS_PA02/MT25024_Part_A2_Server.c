@@ -17,8 +17,10 @@ All code in this file was written, reviewed, and fully understood.
 
 #include <arpa/inet.h>
 #include <errno.h>
+#include <limits.h>        // IOV_MAX
 #include <netinet/tcp.h>   // TCP_NODELAY (optional)
 #include <pthread.h>
+#include <signal.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -27,6 +29,20 @@ All code in this file was written, reviewed, and fully understood.
 #include <sys/uio.h>
 #include <unistd.h>
 
+#include "MT25024_Proto.h"
+#include "MT25024_Stats.h"
+#include "MT25024_TcpInfo.h"
+#include "MT25024_Sched.h"
+#include "MT25024_Stream.h"
+#include "MT25024_Frame.h"
+#include "MT25024_Verify.h"
+#include "MT25024_Pace.h"
+#include "MT25024_Soak.h"
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
 #define SERVERPORT 8989
 #define SERVER_BACKLOG 128
 
@@ -39,6 +55,25 @@ typedef struct {
 } msg8_t;
 
 static size_t g_msgSize = 65536;   // total bytes across 8 fields
+static bool g_batch = false;       // --batch: drain queued triggers, one sendmsg per batch
+static bool g_timestamps = false;  // --timestamps: ts_header_t before / ts_trailer_t after payload
+static int g_tcpinfo_ms = 0;       // --tcpinfo[=ms]: sample TCP_INFO per connection (0 = off)
+static bool g_qos = false;         // --qos[=w0,w1,..]: DRR send scheduling across trigger classes
+static const char *g_qos_weights = NULL; // per-class weights (default 1 each)
+static unsigned g_qos_slots = 1;   // --qos-slots=N: responses allowed to send at once
+static bool g_stream = false;      // --stream: serve stream requests in credit-paced chunks
+static bool g_framed = false;      // --framed[=w0,..,w7]: length-prefixed response, weighted field sizes
+static const char *g_frame_weights = NULL; // per-field weights (default even split)
+static size_t g_flen[FRAME_FIELDS]; // field lengths, split once in main
+static bool g_verify = false;      // --verify: sequence number + CRC32C trailer on every response
+static int g_port = SERVERPORT;    // --port=N: listen port (several instances for fan-out)
+static size_t g_lowat = 0;         // --lowat=BYTES: TCP_NOTSENT_LOWAT + EPOLLOUT-driven sends (0 = off)
+static unsigned long long g_pacing_mbps = 0; // --pacing=MBPS: SO_MAX_PACING_RATE per connection (0 = off)
+static unsigned g_soak_ms = 0;               // --soak=MS: sample RSS/fds/threads/VmPin until SIGINT/SIGTERM (0 = off)
+static volatile sig_atomic_t g_stop = 0;     // --soak/--qos: set by SIGINT/SIGTERM to end the accept loop
+static qos_sched_t g_sched;
+
+#define BATCH_MAX_MSGS (IOV_MAX / 8)  // 8 iovecs (fields) per response
 
 static void free_msg8(msg8_t *m) {
     for (int i = 0; i < 8; i++) {
@@ -48,16 +83,12 @@ static void free_msg8(msg8_t *m) {
     }
 }
 
-static int alloc_msg8(msg8_t *m, size_t total) {
+/* flen[] comes from frame_split(): the even base/rem split unless --framed weights it */
+static int alloc_msg8(msg8_t *m, const size_t flen[8]) {
     memset(m, 0, sizeof(*m));
-    if (total < 8) return -1;
-
-    size_t base = total / 8;
-    size_t rem  = total % 8;
 
     for (int i = 0; i < 8; i++) {
-        m->flen[i] = base + (i == 7 ? rem : 0);
-        if (m->flen[i] == 0) m->flen[i] = 1;
+        m->flen[i] = flen[i];
 
         m->field[i] = (char*)malloc(m->flen[i]);
         if (!m->field[i]) {
@@ -74,11 +105,16 @@ static void fill_msg8(msg8_t *m) {
     }
 }
 
-/* sendmsg() until all bytes across iovecs are sent */
-static int sendmsg_all(int fd, const struct iovec *iov_in, int iovcnt_in) {
-    if (iovcnt_in > 8) return -1;
-
-    struct iovec iov[8];
+/*
+ * sendmsg() until all bytes across iovecs are sent (up to IOV_MAX iovecs).
+ * If calls != NULL, the number of sendmsg() syscalls is added to it.
+ * With --lowat, sends do not block; a full socket waits for EPOLLOUT in pace_wait().
+ */
+static int sendmsg_all(int fd, const struct iovec *iov_in, int iovcnt_in, unsigned long long *calls,
+                       pace_conn_t *pc) {
+    if (iovcnt_in > IOV_MAX) return -1;
+
+    struct iovec iov[IOV_MAX];
     memcpy(iov, iov_in, (size_t)iovcnt_in * sizeof(struct iovec));
     int iovcnt = iovcnt_in;
 
@@ -88,9 +124,12 @@ static int sendmsg_all(int fd, const struct iovec *iov_in, int iovcnt_in) {
         msg.msg_iov = iov;
         msg.msg_iovlen = (size_t)iovcnt;
 
-        ssize_t n = sendmsg(fd, &msg, 0);
+        // MSG_NOSIGNAL: a client closing mid-response must not kill the server with SIGPIPE
+        ssize_t n = sendmsg(fd, &msg, MSG_NOSIGNAL | pace_flags(pc));
+        if (calls) (*calls)++;
         if (n < 0) {
             if (errno == EINTR) continue;
+            if ((errno == EAGAIN || errno == EWOULDBLOCK) && pace_flags(pc) && pace_wait(pc) == 0) continue;
             return -1;
         }
         if (n == 0) return -1;
@@ -133,6 +172,118 @@ static int recv_all(int fd, void *buf, size_t len) {
     return 1;
 }
 
+/* --tcpinfo: one last sample, then the per-connection summary */
+static void print_tcpinfo(int fd, tcpinfo_stats_t *ti) {
+    if (ti->interval_ns == 0) return;
+    tcpinfo_sample(ti, fd);
+    char buf[2048];
+    fprintf(stderr, "[A2 server] tcp_info:%s\n", tcpinfo_format(buf, sizeof(buf), ti));
+}
+
+/*
+ * Batch mode: a single recv() into a large buffer returns every trigger already
+ * queued on the socket, and all of their responses go out in one sendmsg() whose
+ * iovec repeats the 8 field buffers once per trigger (up to IOV_MAX entries).
+ * Bytes beyond this batch (partial trigger or more than the cap) stay in rx[].
+ */
+static void serve_batched(int fd, const struct iovec *fields, tcpinfo_stats_t *ti, pace_conn_t *pc) {
+    struct iovec *biov = (struct iovec*)malloc(sizeof(struct iovec) * BATCH_MAX_MSGS * 8);
+    if (!biov) {
+        perror("malloc batch iov");
+        return;
+    }
+    for (int j = 0; j < BATCH_MAX_MSGS; j++) {
+        memcpy(biov + (size_t)j * 8, fields, 8 * sizeof(struct iovec));
+    }
+
+    char rx[BATCH_MAX_MSGS * 8];
+    size_t have = 0;
+
+    batch_stats_t st;
+    memset(&st, 0, sizeof(st));
+
+    bool open = true;
+    while (open) {
+        while (have < 8) {
+            ssize_t r = recv(fd, rx + have, sizeof(rx) - have, 0);
+            if (r == 0) { open = false; break; }    // client closed
+            if (r < 0) {
+                if (errno == EINTR) continue;
+                perror("recv");
+                open = false;
+                break;
+            }
+            st.recv_calls++;
+            have += (size_t)r;
+        }
+        if (!open) break;
+
+        size_t k = have / 8;
+        if (k > BATCH_MAX_MSGS) k = BATCH_MAX_MSGS;
+
+        if (sendmsg_all(fd, biov, (int)(k * 8), &st.send_calls, pc) != 0) {
+            perror("sendmsg");
+            break;
+        }
+        tcpinfo_maybe_sample(ti, fd);
+
+        st.msgs += k;
+        log2_hist_add(&st.batch, k);
+
+        have -= k * 8;
+        memmove(rx, rx + k * 8, have);
+    }
+
+    batch_stats_print(stderr, "[A2 server]", &st);
+    free(biov);
+}
+
+/*
+ * timestamps mode: the header goes in an extra iovec in front of the 8 fields (one
+ * sendmsg_all), then the trailer carries the time the payload send returned
+ */
+static int sendmsg_timestamped(int fd, const struct iovec *fields, const char *trigger, uint64_t t_recv,
+                               pace_conn_t *pc) {
+    ts_header_t h;
+    memcpy(&h.client_send_ns, trigger, sizeof(h.client_send_ns));
+    h.server_recv_ns = t_recv;
+
+    struct iovec tiov[9];
+    tiov[0].iov_base = &h;
+    tiov[0].iov_len  = sizeof(h);
+    memcpy(tiov + 1, fields, 8 * sizeof(struct iovec));
+
+    h.send_start_ns = mono_ns();
+    if (sendmsg_all(fd, tiov, 9, NULL, pc) != 0) return -1;
+
+    ts_trailer_t t = { .send_complete_ns = mono_ns() };
+    struct iovec tr = { .iov_base = &t, .iov_len = sizeof(t) };
+    return sendmsg_all(fd, &tr, 1, NULL, pc);
+}
+
+/* qos / stream mode: bytes [off, off + len) of the 8 fields, one chunk at a time */
+typedef struct {
+    int fd;
+    const struct iovec *fields;
+    pace_conn_t *pace;
+} chunk_ctx_t;
+
+static int send_chunk(void *arg, size_t off, size_t len) {
+    const chunk_ctx_t *c = (const chunk_ctx_t*)arg;
+    struct iovec iov[8];
+    int n = 0;
+    for (int i = 0; i < 8 && len > 0; i++) {
+        size_t flen = c->fields[i].iov_len;
+        if (off >= flen) { off -= flen; continue; }
+        iov[n].iov_base = (char*)c->fields[i].iov_base + off;
+        iov[n].iov_len  = flen - off < len ? flen - off : len;
+        len -= iov[n].iov_len;
+        off = 0;
+        n++;
+    }
+    return sendmsg_all(c->fd, iov, n, NULL, c->pace);
+}
+
 static void *handle_connection(void *arg) {
     int clientSocket = *(int*)arg;
     free(arg);
@@ -141,47 +292,223 @@ static void *handle_connection(void *arg) {
     int one = 1;
     setsockopt(clientSocket, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
 
+    tcpinfo_stats_t tinfo;
+    tcpinfo_init(&tinfo, (unsigned)g_tcpinfo_ms);
+
     msg8_t m;
-    if (alloc_msg8(&m, g_msgSize) != 0) {
+    if (alloc_msg8(&m, g_flen) != 0) {
         perror("alloc_msg8");
         close(clientSocket);
         return NULL;
     }
 
-    // Build iov pointing to the 8 heap fields
-    struct iovec iov[8];
+    // Build iov pointing to the 8 heap fields; framed mode sends the frame header
+    // from fiov[0], verify mode the trailer from fiov[9], in the same sendmsg
+    unsigned char fhdr[FRAME_HDR_LEN];
+    unsigned char vtrailer[VERIFY_TRAILER_LEN];
+    struct iovec fiov[10];
+    struct iovec *iov = fiov + 1;
+    fiov[0].iov_base = fhdr;
+    fiov[0].iov_len  = sizeof(fhdr);
     for (int i = 0; i < 8; i++) {
         iov[i].iov_base = m.field[i];
         iov[i].iov_len  = m.flen[i];
     }
+    fiov[9].iov_base = vtrailer;
+    fiov[9].iov_len  = sizeof(vtrailer);
+    if (g_framed) frame_encode_hdr(fhdr, m.flen);
 
     // fill once per connection (no 64KB memset per trigger)
     fill_msg8(&m);
 
+    pace_conn_t pace;
+    if (pace_init(&pace, clientSocket, g_lowat, g_pacing_mbps) != 0) {
+        pace_close(&pace);
+        free_msg8(&m);
+        close(clientSocket);
+        return NULL;
+    }
+
+    if (g_batch) {
+        serve_batched(clientSocket, iov, &tinfo, &pace);
+        print_tcpinfo(clientSocket, &tinfo);
+        pace_print(stderr, "[A2 server]", &pace);
+        pace_close(&pace);
+        free_msg8(&m);
+        close(clientSocket);
+        return NULL;
+    }
+
+    stream_srv_stats_t sst;
+    memset(&sst, 0, sizeof(sst));
+    verify_stats_t vst;
+    memset(&vst, 0, sizeof(vst));
+    uint64_t vseq = 0;
+    uint64_t t_loop = mono_ns();
+
     char trigger[8];
 
     while (true) {
         int rc = recv_all(clientSocket, trigger, sizeof(trigger));
         if (rc == 0) break;
         if (rc < 0) { perror("recv"); break; }
+        tcpinfo_maybe_sample(&tinfo, clientSocket);
+
+        if (g_timestamps) {
+            if (sendmsg_timestamped(clientSocket, iov, trigger, mono_ns(), &pace) != 0) {
+                perror("sendmsg");
+                break;
+            }
+            continue;
+        }
 
-        if (sendmsg_all(clientSocket, iov, 8) != 0) {
+        size_t chunk;
+        unsigned credits;
+        if (g_stream && stream_req_decode(trigger, &chunk, &credits)) {
+            // stream request: the 8 fields go out in credit-paced chunks
+            if (chunk == 0 || credits == 0) {
+                fprintf(stderr, "[A2 server] bad stream request (chunk=%zu credits=%u)\n", chunk, credits);
+                break;
+            }
+            chunk_ctx_t ch = { clientSocket, iov, &pace };
+            if (stream_send(clientSocket, g_msgSize, chunk, credits, send_chunk, &ch, &sst) != 0) {
+                perror("stream send");
+                break;
+            }
+            continue;
+        }
+
+        if (g_qos) {
+            // tagged trigger: class picks the scheduler queue, size trims the response
+            uint64_t t_recv = mono_ns();
+            unsigned cls;
+            size_t respLen;
+            if (qos_parse_trigger(trigger, g_msgSize, &cls, &respLen) != 0) {
+                fprintf(stderr, "[A2 server] bad qos trigger (class or size out of range)\n");
+                break;
+            }
+            chunk_ctx_t ch = { clientSocket, iov, &pace };
+            if (qos_send(&g_sched, cls, respLen, t_recv, send_chunk, &ch) != 0) {
+                perror("sendmsg");
+                break;
+            }
+            continue;
+        }
+
+        // verify mode: stamp the sequence number into the shared fields (sendmsg copies
+        // them before returning) and CRC what is about to be sent
+        if (g_verify) {
+            uint64_t t0 = mono_ns();
+            verify_put_seq(m.field, m.flen, vseq++);
+            verify_trailer_encode(vtrailer, verify_crc_fields(m.field, m.flen));
+            vst.verify_ns += mono_ns() - t0;
+            vst.msgs++;
+            vst.bytes += g_msgSize;
+        }
+
+        int src = g_framed ? sendmsg_all(clientSocket, fiov, 9, NULL, &pace)
+                : g_verify ? sendmsg_all(clientSocket, iov, 9, NULL, &pace)
+                           : sendmsg_all(clientSocket, iov, 8, NULL, &pace);
+        if (src != 0) {
             perror("sendmsg");
             break;
         }
     }
 
+    print_tcpinfo(clientSocket, &tinfo);
+    if (g_stream) stream_srv_print(stderr, "[A2 server]", &sst);
+    if (g_verify) {
+        vst.loop_ns = mono_ns() - t_loop;
+        verify_stats_print(stderr, "[A2 server]", &vst);
+    }
+    pace_print(stderr, "[A2 server]", &pace);
+    pace_close(&pace);
     free_msg8(&m);
     close(clientSocket);
     return NULL;
 }
 
+static void on_stop(int sig) {
+    (void)sig;
+    g_stop = 1;
+}
+
 int main(int argc, char **argv) {
     if (argc >= 2) {
         long v = strtol(argv[1], NULL, 10);
         if (v > 0) g_msgSize = (size_t)v;
     }
 
+    for (int i = 2; i < argc; i++) {
+        int tcpinfo = tcpinfo_parse_opt(argv[i]);
+        if (strcmp(argv[i], "--batch") == 0) {
+            g_batch = true;
+        } else if (strcmp(argv[i], "--timestamps") == 0) {
+            g_timestamps = true;
+        } else if (tcpinfo >= 0) {
+            g_tcpinfo_ms = tcpinfo;
+        } else if (strcmp(argv[i], "--qos") == 0 || strncmp(argv[i], "--qos=", 6) == 0) {
+            g_qos = true;
+            if (argv[i][5] == '=') g_qos_weights = argv[i] + 6;
+        } else if (strncmp(argv[i], "--qos-slots=", 12) == 0) {
+            g_qos_slots = (unsigned)atoi(argv[i] + 12);
+        } else if (strcmp(argv[i], "--stream") == 0) {
+            g_stream = true;
+        } else if (strcmp(argv[i], "--framed") == 0 || strncmp(argv[i], "--framed=", 9) == 0) {
+            g_framed = true;
+            if (argv[i][8] == '=') g_frame_weights = argv[i] + 9;
+        } else if (strcmp(argv[i], "--verify") == 0) {
+            g_verify = true;
+        } else if (strncmp(argv[i], "--port=", 7) == 0) {
+            g_port = atoi(argv[i] + 7);
+        } else if (strncmp(argv[i], "--lowat=", 8) == 0) {
+            g_lowat = (size_t)strtoull(argv[i] + 8, NULL, 10);
+            if (g_lowat == 0) { fprintf(stderr, "ERROR: --lowat must be > 0 bytes\n"); return 1; }
+        } else if (strncmp(argv[i], "--pacing=", 9) == 0) {
+            g_pacing_mbps = strtoull(argv[i] + 9, NULL, 10);
+            if (g_pacing_mbps == 0) { fprintf(stderr, "ERROR: --pacing must be > 0 Mbit/s\n"); return 1; }
+        } else if (strncmp(argv[i], "--soak=", 7) == 0) {
+            g_soak_ms = (unsigned)strtoul(argv[i] + 7, NULL, 10);
+            if (g_soak_ms < SOAK_MIN_MS || g_soak_ms > SOAK_MAX_MS) {
+                fprintf(stderr, "ERROR: --soak must be %d..%d ms\n", SOAK_MIN_MS, SOAK_MAX_MS);
+                return 1;
+            }
+        } else {
+            fprintf(stderr, "Usage: %s <msg_size> [--batch] [--timestamps] [--tcpinfo[=ms]] "
+                            "[--qos[=w0,w1,w2,w3]] [--qos-slots=N] [--stream] [--framed[=w0,..,w7]] [--verify] "
+                            "[--port=N] [--lowat=BYTES] [--pacing=MBPS] [--soak=MS]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+
+    if (g_batch && g_timestamps) {
+        fprintf(stderr, "ERROR: --batch and --timestamps cannot be combined\n");
+        return 1;
+    }
+
+    if (g_qos && (g_batch || g_timestamps)) {
+        fprintf(stderr, "ERROR: --qos cannot be combined with --batch or --timestamps\n");
+        return 1;
+    }
+    if (g_stream && (g_batch || g_timestamps || g_qos)) {
+        fprintf(stderr, "ERROR: --stream cannot be combined with --batch, --timestamps or --qos\n");
+        return 1;
+    }
+    if (g_framed && (g_batch || g_timestamps || g_qos || g_stream)) {
+        fprintf(stderr, "ERROR: --framed cannot be combined with --batch, --timestamps, --qos or --stream\n");
+        return 1;
+    }
+    if (g_verify && (g_batch || g_timestamps || g_qos || g_stream || g_framed)) {
+        fprintf(stderr, "ERROR: --verify cannot be combined with --batch, --timestamps, --qos, --stream or --framed\n");
+        return 1;
+    }
+    if (g_qos && (g_qos_slots == 0 || qos_init(&g_sched, g_qos_weights, g_qos_slots) != 0)) {
+        fprintf(stderr, "ERROR: bad --qos weights or --qos-slots (weights: 1..1000, up to %d classes)\n",
+                QOS_MAX_CLASSES);
+        return 1;
+    }
+
     if (g_msgSize < 8) {
         fprintf(stderr, "ERROR: msgSize must be >= 8 bytes (got %zu)\n", g_msgSize);
         return 1;
@@ -193,6 +520,21 @@ int main(int argc, char **argv) {
         return 1;
     }
 
+    if (g_port <= 0 || g_port > 65535) {
+        fprintf(stderr, "ERROR: --port must be 1..65535\n");
+        return 1;
+    }
+
+    unsigned weights[FRAME_FIELDS];
+    if (g_frame_weights && frame_parse_weights(g_frame_weights, weights) != 0) {
+        fprintf(stderr, "ERROR: bad --framed weights (8 comma-separated values, 1..1000000)\n");
+        return 1;
+    }
+    if (frame_split(g_msgSize, g_frame_weights ? weights : NULL, g_flen) != 0) {
+        fprintf(stderr, "ERROR: msgSize %zu too small for the --framed weights\n", g_msgSize);
+        return 1;
+    }
+
     int serverSocket = socket(AF_INET, SOCK_STREAM, 0);
     if (serverSocket < 0) { perror("socket"); return 1; }
 
@@ -203,7 +545,7 @@ int main(int argc, char **argv) {
     memset(&server_addr, 0, sizeof(server_addr));
     server_addr.sin_family = AF_INET;
     server_addr.sin_addr.s_addr = htonl(INADDR_ANY);
-    server_addr.sin_port = htons(SERVERPORT);
+    server_addr.sin_port = htons((uint16_t)g_port);
 
     if (bind(serverSocket, (SA*)&server_addr, sizeof(server_addr)) < 0) {
         perror("bind");
@@ -217,13 +559,33 @@ int main(int argc, char **argv) {
         return 1;
     }
 
-    fprintf(stderr, "[A2 server] listening on %d, msgSize=%zu bytes (8 fields)\n",
-            SERVERPORT, g_msgSize);
+    fprintf(stderr, "[A2 server] listening on %d, msgSize=%zu bytes (8 fields)%s%s%s%s\n",
+            g_port, g_msgSize, g_batch ? " (batch mode)" : "",
+            g_timestamps ? " (timestamps)" : "",
+            g_qos ? " (qos)" : g_stream ? " (stream)" : g_framed ? " (framed)" : "",
+            g_verify ? " (verify)" : "");
+
+    if (g_soak_ms || g_qos) {
+        // no SA_RESTART: the signal interrupts accept() so the loop ends and the
+        // soak trend / qos totals are printed once
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = on_stop;
+        sigaction(SIGINT, &sa, NULL);
+        sigaction(SIGTERM, &sa, NULL);
+    }
+    if (g_soak_ms) {
+        if (soak_start("[A2 server]", "a2_server", g_soak_ms) != 0) return 1;
+    }
 
-    while (true) {
+    while (!g_stop) {
         socklen_t addr_size = sizeof(SA_IN);
         int clientSocket = accept(serverSocket, (SA*)&client_addr, &addr_size);
-        if (clientSocket < 0) { perror("accept"); continue; }
+        if (clientSocket < 0) {
+            if (errno == EINTR) continue;
+            perror("accept");
+            continue;
+        }
 
         pthread_t tid;
         int *pfd = (int*)malloc(sizeof(int));
@@ -238,4 +600,9 @@ int main(int argc, char **argv) {
         }
         pthread_detach(tid);
     }
+
+    soak_stop();
+    if (g_qos) qos_print(stderr, "[A2 server]", &g_sched);
+    close(serverSocket);
+    return 0;
 }
\ No newline at end of file
@@ -19,9 +19,11 @@ All code in this file was written, reviewed, and fully understood.
 
 #include <arpa/inet.h>
 #include <errno.h>
+#include <limits.h>         // IOV_MAX
 #include <netinet/in.h>     // SOL_IP, IP_RECVERR
 #include <poll.h>
 #include <pthread.h>
+#include <signal.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -33,6 +35,16 @@ All code in this file was written, reviewed, and fully understood.
 
 #include <linux/errqueue.h> // sock_extended_err, SO_EE_ORIGIN_ZEROCOPY
 
+#include "MT25024_Proto.h"
+#include "MT25024_Stats.h"
+#include "MT25024_TcpInfo.h"
+#include "MT25024_Sched.h"
+#include "MT25024_Stream.h"
+#include "MT25024_Frame.h"
+#include "MT25024_Verify.h"
+#include "MT25024_Pace.h"
+#include "MT25024_Soak.h"
+
 #ifndef SO_ZEROCOPY
 // Some distros expose SO_ZEROCOPY via <linux/socket.h>. If it's missing, we gracefully fall back.
 #include <linux/socket.h>
@@ -47,11 +59,34 @@ All code in this file was written, reviewed, and fully understood.
 #define MSG_NOSIGNAL 0x4000
 #endif
 
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
 #define SERVERPORT 8989
 #define SERVER_BACKLOG 128
+#define BATCH_MAX_MSGS (IOV_MAX / 8)                        // 8 iovecs (fields) per response
+#define ZC_FLUSH_MS 2000                                    // connection teardown: wait this long for completions
 
 static size_t g_msgSize = 65536;                            // total bytes across 8 fields
 static const size_t MaxMsgSize = 10ULL * 1024ULL * 1024ULL; // 10MB
+static bool g_batch = false;                                // --batch: one sendmsg per batch of triggers
+static bool g_timestamps = false;                           // --timestamps: ts_header_t/ts_trailer_t around payload
+static int g_tcpinfo_ms = 0;                                // --tcpinfo[=ms]: sample TCP_INFO per connection (0 = off)
+static bool g_qos = false;                                  // --qos[=w0,w1,..]: DRR send scheduling across trigger classes
+static const char *g_qos_weights = NULL;                    // per-class weights (default 1 each)
+static unsigned g_qos_slots = 1;                            // --qos-slots=N: responses allowed to send at once
+static bool g_stream = false;                               // --stream: serve stream requests in credit-paced chunks
+static bool g_framed = false;                               // --framed[=w0,..,w7]: length-prefixed response, weighted field sizes
+static const char *g_frame_weights = NULL;                  // per-field weights (default even split)
+static size_t g_flen[FRAME_FIELDS];                         // field lengths, split once in main
+static bool g_verify = false;                               // --verify: sequence number + CRC32C trailer on every response
+static int g_port = SERVERPORT;                             // --port=N: listen port (several instances for fan-out)
+static size_t g_lowat = 0;                                  // --lowat=BYTES: TCP_NOTSENT_LOWAT + EPOLLOUT-driven sends (0 = off)
+static unsigned long long g_pacing_mbps = 0;                // --pacing=MBPS: SO_MAX_PACING_RATE per connection (0 = off)
+static unsigned g_soak_ms = 0;                              // --soak=MS: sample RSS/fds/threads/VmPin until SIGINT/SIGTERM (0 = off)
+static volatile sig_atomic_t g_stop = 0;                    // --soak/--qos: set by SIGINT/SIGTERM to end the accept loop
+static qos_sched_t g_sched;
 
 typedef struct sockaddr_in SA_IN;
 typedef struct sockaddr SA;
@@ -60,6 +95,10 @@ typedef struct MsgSlot {
     char *field[8];
     size_t flen[8];
     struct MsgSlot *next; // used in lists (free/pending)
+    size_t group;         // batch mode: extra slots after this one covered by the same completion
+    size_t extra_ids;     // qos mode: completions still owed for chunks after the first
+    ts_header_t ts_hdr;   // timestamps mode: lives in the slot so zerocopy can reference it until completion
+    unsigned char vtrailer[VERIFY_TRAILER_LEN]; // verify mode: same reason
 } MsgSlot;
 
 typedef struct ConnCtx {
@@ -71,8 +110,12 @@ typedef struct ConnCtx {
     MsgSlot *pending_tail;
     size_t pending_count;
 
-    size_t base;
-    size_t rem;
+    unsigned char frame_hdr[FRAME_HDR_LEN]; // framed mode: constant, so zerocopy can reference it
+
+    tcpinfo_stats_t tinfo; // --tcpinfo sampling for this connection
+    pace_conn_t pace;      // --lowat / --pacing state for this connection
+    bool in_send;          // --lowat: a response is part-sent and its slot not yet pending
+    size_t deferred_ids;   // completions read while in_send, applied once the slot is queued
 } ConnCtx;
 
 /* recv exactly len bytes into buf */
@@ -112,14 +155,13 @@ static int enable_zerocopy(int fd) {
 #endif
 }
 
-/* Allocate one slot: 8 heap buffers that sum to g_msgSize */
-static MsgSlot *alloc_slot(size_t base, size_t rem) {
+/* Allocate one slot: 8 heap buffers of flen[i] bytes (they sum to g_msgSize) */
+static MsgSlot *alloc_slot(const size_t flen[8]) {
     MsgSlot *s = (MsgSlot*)calloc(1, sizeof(MsgSlot));
     if (!s) return NULL;
 
     for (int i = 0; i < 8; i++) {
-        s->flen[i] = base + ((i == 7) ? rem : 0);
-        if (s->flen[i] == 0) s->flen[i] = 1;
+        s->flen[i] = flen[i];
 
         s->field[i] = (char*)malloc(s->flen[i]);
         if (!s->field[i]) {
@@ -164,16 +206,30 @@ static void enqueue_pending(ConnCtx *c, MsgSlot *s) {
     c->pending_count++;
 }
 
-/* Pop N slots from pending FIFO and push them back to free list */
+/*
+Pop N completions from pending FIFO and push their slots back to free list.
+One completion covers 1 slot, or 1 + group slots when a batch went out in one sendmsg.
+A slot sent in qos chunks first absorbs one completion per extra chunk.
+*/
 static void pop_completed_n(ConnCtx *c, size_t n) {
     while (n > 0 && c->pending_head) {
-        MsgSlot *tmp = c->pending_head;
-        c->pending_head = tmp->next;
-        if (!c->pending_head) c->pending_tail = NULL;
-        c->pending_count--;
+        if (c->pending_head->extra_ids > 0) {
+            c->pending_head->extra_ids--;
+            n--;
+            continue;
+        }
+        size_t take = 1 + c->pending_head->group;
+        while (take > 0 && c->pending_head) {
+            MsgSlot *tmp = c->pending_head;
+            c->pending_head = tmp->next;
+            if (!c->pending_head) c->pending_tail = NULL;
+            c->pending_count--;
 
-        tmp->next = NULL;
-        push_free(c, tmp);
+            tmp->next = NULL;
+            tmp->group = 0;
+            push_free(c, tmp);
+            take--;
+        }
         n--;
     }
 }
@@ -187,18 +243,31 @@ Kernel reports completion id ranges:
 
 We do NOT assume our own IDs match kernel IDs. Instead we treat pending as FIFO:
 completed_count = (last-first+1), and recycle that many slots.
+
+block: wait until one notification is read or nothing is pending. Returns -1 (errno
+set) on a hangup / socket error, or when nothing arrives within ZC_FLUSH_MS.
 */
-static void drain_zerocopy_errqueue(ConnCtx *c, bool block) {
+static int drain_zerocopy_errqueue(ConnCtx *c, bool block) {
+    if (!c->in_send && c->deferred_ids) {
+        pop_completed_n(c, c->deferred_ids);
+        c->deferred_ids = 0;
+    }
+    // block: bounded by ZC_FLUSH_MS here too, since a reset peer keeps poll() returning at once
+    uint64_t deadline = block ? mono_ns() + (uint64_t)ZC_FLUSH_MS * 1000000ULL : 0;
+    bool hup = false;
     for (;;) {
         if (block) {
+            if (c->pending_count == 0) return 0;
+            if (mono_ns() >= deadline) { errno = ETIMEDOUT; return -1; }
             struct pollfd pfd = { .fd = c->fd, .events = POLLERR };
             int prc = poll(&pfd, 1, 100); // 100ms ticks
             if (prc < 0) {
                 if (errno == EINTR) continue;
                 perror("[a3_server] poll");
-                return;
+                return -1;
             }
             if (prc == 0) continue;
+            hup = (pfd.revents & (POLLERR | POLLHUP)) != 0;
         }
 
         char cbuf[256];
@@ -217,11 +286,13 @@ static void drain_zerocopy_errqueue(ConnCtx *c, bool block) {
         if (n < 0) {
             if (errno == EINTR) continue;
             if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                if (!block) return;
+                // POLLERR/POLLHUP with an empty error queue: a socket error or hangup, not a completion
+                if (!block) return 0;
+                if (hup) { errno = ECONNRESET; return -1; }
                 continue;
             }
             perror("[a3_server] recvmsg(MSG_ERRQUEUE)");
-            return;
+            return -1;
         }
 
         for (struct cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
@@ -235,26 +306,48 @@ static void drain_zerocopy_errqueue(ConnCtx *c, bool block) {
 
                     if (last >= first) {
                         size_t completed = (size_t)(last - first + 1);
-                        pop_completed_n(c, completed);
+                        if (c->in_send) c->deferred_ids += completed;
+                        else pop_completed_n(c, completed);
                     }
                 }
             }
         }
+        return 0;
+    }
+}
 
-        if (!block) return;
+/* zerocopy pool empty: wait for completions; -1 closes the connection (peer gone or stuck) */
+static int wait_free_slot(ConnCtx *c) {
+    while (!c->free_head) {
+        if (drain_zerocopy_errqueue(c, true) < 0) {
+            fprintf(stderr, "[a3_server] no zerocopy completion to free a slot: %s\n", strerror(errno));
+            return -1;
+        }
     }
+    return 0;
 }
 
-/* send iovecs; if zerocopy_enabled -> MSG_ZEROCOPY else normal sendmsg */
-static int sendmsg_maybe_zerocopy(ConnCtx *c, MsgSlot *s) {
-    struct iovec iov[8];
-    for (int i = 0; i < 8; i++) {
-        iov[i].iov_base = s->field[i];
-        iov[i].iov_len  = s->flen[i];
+/*
+--lowat: a send hit EAGAIN. Completions queued meanwhile keep EPOLLERR raised, so read
+them first; the response being sent is not pending yet, so they are only counted here
+and recycled by the next drain after it is queued (pending stays in kernel id order).
+*/
+static int wait_writable(ConnCtx *c) {
+    if (c->zerocopy_enabled) {
+        c->in_send = true;
+        drain_zerocopy_errqueue(c, false);
+        c->in_send = false;
     }
+    return pace_wait(&c->pace);
+}
 
-    int iovcnt = 8;
-    size_t total_left = g_msgSize;
+/*
+send iovecs (consumed in place); if zerocopy_enabled -> MSG_ZEROCOPY else normal sendmsg.
+If calls != NULL, the number of sendmsg() syscalls is added to it.
+With --lowat, sends do not block; a full socket waits for EPOLLOUT in wait_writable().
+*/
+static int sendmsg_iov_maybe_zerocopy(ConnCtx *c, struct iovec *iov, int iovcnt,
+                                      size_t total_left, unsigned long long *calls) {
 
     // MSG_ZEROCOPY only when enabled; otherwise normal sendmsg.
     int zc_flags = c->zerocopy_enabled ? MSG_ZEROCOPY : 0;
@@ -266,9 +359,12 @@ static int sendmsg_maybe_zerocopy(ConnCtx *c, MsgSlot *s) {
         msg.msg_iovlen = (size_t)iovcnt;
 
         // MSG_NOSIGNAL avoids SIGPIPE killing server on client close
-        ssize_t n = sendmsg(c->fd, &msg, zc_flags | MSG_NOSIGNAL);
+        ssize_t n = sendmsg(c->fd, &msg, zc_flags | MSG_NOSIGNAL | pace_flags(&c->pace));
+        if (calls) (*calls)++;
         if (n < 0) {
             if (errno == EINTR) continue;
+            if ((errno == EAGAIN || errno == EWOULDBLOCK) && pace_flags(&c->pace) && wait_writable(c) == 0)
+                continue;
             return -1;
         }
         if (n == 0) {
@@ -305,6 +401,180 @@ static int sendmsg_maybe_zerocopy(ConnCtx *c, MsgSlot *s) {
     return 0;
 }
 
+/* send one slot's 8 fields (preceded by its timestamp header or the frame header,
+ * followed by its verify trailer) */
+static int sendmsg_maybe_zerocopy(ConnCtx *c, MsgSlot *s) {
+    struct iovec iov[10];
+    int iovcnt = 0;
+    size_t total = g_msgSize;
+
+    if (g_timestamps) {
+        iov[iovcnt].iov_base = &s->ts_hdr;
+        iov[iovcnt].iov_len  = sizeof(s->ts_hdr);
+        iovcnt++;
+        total += sizeof(s->ts_hdr);
+    } else if (g_framed) {
+        iov[iovcnt].iov_base = c->frame_hdr;
+        iov[iovcnt].iov_len  = sizeof(c->frame_hdr);
+        iovcnt++;
+        total += sizeof(c->frame_hdr);
+    }
+    for (int i = 0; i < 8; i++) {
+        iov[iovcnt].iov_base = s->field[i];
+        iov[iovcnt].iov_len  = s->flen[i];
+        iovcnt++;
+    }
+    if (g_verify) {
+        iov[iovcnt].iov_base = s->vtrailer;
+        iov[iovcnt].iov_len  = sizeof(s->vtrailer);
+        iovcnt++;
+        total += sizeof(s->vtrailer);
+    }
+    return sendmsg_iov_maybe_zerocopy(c, iov, iovcnt, total, NULL);
+}
+
+/*
+qos / stream mode: bytes [off, off + len) of a slot go out one chunk at a time.
+Every chunk is its own MSG_ZEROCOPY sendmsg and so its own completion id; the ids
+after the first are counted in extra_ids so the slot is only recycled after all.
+*/
+typedef struct {
+    ConnCtx *c;
+    MsgSlot *s;
+    size_t chunks;   // chunks sent so far for this slot
+} chunk_ctx_t;
+
+static int send_slot_chunk(void *arg, size_t off, size_t len) {
+    chunk_ctx_t *ch = (chunk_ctx_t*)arg;
+    struct iovec iov[8];
+    int n = 0;
+    size_t total = len;
+    for (int i = 0; i < 8 && len > 0; i++) {
+        size_t flen = ch->s->flen[i];
+        if (off >= flen) { off -= flen; continue; }
+        iov[n].iov_base = ch->s->field[i] + off;
+        iov[n].iov_len  = flen - off < len ? flen - off : len;
+        len -= iov[n].iov_len;
+        off = 0;
+        n++;
+    }
+    int rc = sendmsg_iov_maybe_zerocopy(ch->c, iov, n, total, NULL);
+    if (rc == 0 && ch->c->zerocopy_enabled && ch->chunks++ > 0) ch->s->extra_ids++;
+    return rc;
+}
+
+/* timestamps mode: the trailer is tiny and on the stack, so it is always copied (no MSG_ZEROCOPY) */
+static int send_ts_trailer(ConnCtx *c) {
+    ts_trailer_t t = { .send_complete_ns = mono_ns() };
+    size_t sent = 0;
+    while (sent < sizeof(t)) {
+        ssize_t n = send(c->fd, (char*)&t + sent, sizeof(t) - sent, MSG_NOSIGNAL | pace_flags(&c->pace));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if ((errno == EAGAIN || errno == EWOULDBLOCK) && pace_flags(&c->pace) && wait_writable(c) == 0)
+                continue;
+            return -1;
+        }
+        sent += (size_t)n;
+    }
+    return 0;
+}
+
+/* --tcpinfo: one last sample, then the per-connection summary */
+static void print_tcpinfo(int fd, tcpinfo_stats_t *ti) {
+    if (ti->interval_ns == 0) return;
+    tcpinfo_sample(ti, fd);
+    char buf[2048];
+    fprintf(stderr, "[a3_server] tcp_info:%s\n", tcpinfo_format(buf, sizeof(buf), ti));
+}
+
+/*
+Batch mode: a single recv() into a large buffer returns every trigger already queued
+on the socket. One free slot is taken per trigger (as many as are free) and all of
+them go out in one sendmsg(), so a single zerocopy completion id covers the whole
+batch; the first slot's 'group' records how many more slots that id releases.
+*/
+static void serve_batched(ConnCtx *c) {
+    struct iovec *biov = (struct iovec*)malloc(sizeof(struct iovec) * BATCH_MAX_MSGS * 8);
+    MsgSlot **batch = (MsgSlot**)malloc(sizeof(MsgSlot*) * BATCH_MAX_MSGS);
+    if (!biov || !batch) {
+        perror("[a3_server] malloc batch");
+        free(biov);
+        free(batch);
+        return;
+    }
+
+    char rx[BATCH_MAX_MSGS * 8];
+    size_t have = 0;
+
+    batch_stats_t st;
+    memset(&st, 0, sizeof(st));
+
+    bool open = true;
+    while (open) {
+        while (have < 8) {
+            ssize_t r = recv(c->fd, rx + have, sizeof(rx) - have, 0);
+            if (r == 0) { open = false; break; }    // client closed
+            if (r < 0) {
+                if (errno == EINTR) continue;
+                perror("[a3_server] recv");
+                open = false;
+                break;
+            }
+            st.recv_calls++;
+            have += (size_t)r;
+        }
+        if (!open) break;
+        tcpinfo_maybe_sample(&c->tinfo, c->fd);
+
+        size_t want = have / 8;
+        if (want > BATCH_MAX_MSGS) want = BATCH_MAX_MSGS;
+
+        // If zerocopy enabled, wait for completions when pool is empty.
+        if (c->zerocopy_enabled && wait_free_slot(c) < 0) break;
+
+        size_t k = 0;
+        MsgSlot *s;
+        while (k < want && (s = pop_free(c)) != NULL) {
+            for (int i = 0; i < 8; i++) {
+                biov[k * 8 + (size_t)i].iov_base = s->field[i];
+                biov[k * 8 + (size_t)i].iov_len  = s->flen[i];
+            }
+            batch[k++] = s;
+        }
+        if (k == 0) {
+            fprintf(stderr, "[a3_server] ERROR: no free slot available\n");
+            break;
+        }
+
+        if (sendmsg_iov_maybe_zerocopy(c, biov, (int)(k * 8), k * g_msgSize, &st.send_calls) < 0) {
+            fprintf(stderr, "[a3_server] sendmsg(%s) failed: %s\n",
+                    c->zerocopy_enabled ? "MSG_ZEROCOPY" : "normal",
+                    strerror(errno));
+            for (size_t j = 0; j < k; j++) push_free(c, batch[j]);
+            break;
+        }
+
+        if (c->zerocopy_enabled) {
+            batch[0]->group = k - 1;
+            for (size_t j = 0; j < k; j++) enqueue_pending(c, batch[j]);
+            drain_zerocopy_errqueue(c, false);
+        } else {
+            for (size_t j = 0; j < k; j++) push_free(c, batch[j]);
+        }
+
+        st.msgs += k;
+        log2_hist_add(&st.batch, k);
+
+        have -= k * 8;
+        memmove(rx, rx + k * 8, have);
+    }
+
+    batch_stats_print(stderr, "[a3_server]", &st);
+    free(biov);
+    free(batch);
+}
+
 static void *handle_connection(void *arg) {
     int client_fd = *(int*)arg;
     free(arg);
@@ -313,18 +583,22 @@ static void *handle_connection(void *arg) {
     memset(&ctx, 0, sizeof(ctx));
     ctx.fd = client_fd;
 
-    // Decide 8 field lengths that sum to g_msgSize
-    ctx.base = g_msgSize / 8;
-    ctx.rem  = g_msgSize % 8;
-    if (ctx.base == 0) ctx.base = 1;
+    // 8 field lengths (summing to g_msgSize) were decided once in main
+    if (g_framed) frame_encode_hdr(ctx.frame_hdr, g_flen);
 
     // Enable zerocopy if supported (non-fatal if not)
     ctx.zerocopy_enabled = (enable_zerocopy(client_fd) == 0);
+    tcpinfo_init(&ctx.tinfo, (unsigned)g_tcpinfo_ms);
+    if (pace_init(&ctx.pace, client_fd, g_lowat, g_pacing_mbps) != 0) {
+        pace_close(&ctx.pace);
+        close(client_fd);
+        return NULL;
+    }
 
     // Pre-allocate a small pool of slots (each has 8 heap buffers).
     const size_t POOL_SLOTS = 64;
     for (size_t i = 0; i < POOL_SLOTS; i++) {
-        MsgSlot *s = alloc_slot(ctx.base, ctx.rem);
+        MsgSlot *s = alloc_slot(g_flen);
         if (!s) break;
         fill_slot(s);
         push_free(&ctx, s);
@@ -332,31 +606,84 @@ static void *handle_connection(void *arg) {
 
     if (!ctx.free_head) {
         fprintf(stderr, "[a3_server] ERROR: could not allocate any message slots\n");
+        pace_close(&ctx.pace);
         close(client_fd);
         return NULL;
     }
 
+    stream_srv_stats_t sst;
+    memset(&sst, 0, sizeof(sst));
+    verify_stats_t vst;
+    memset(&vst, 0, sizeof(vst));
+    uint64_t vseq = 0;
+    uint64_t t_loop = mono_ns();
+
     char trigger[8];
 
-    while (true) {
+    // normal mode: one trigger -> one response (batch mode is served by serve_batched below)
+    while (!g_batch) {
         int rr = recv_all(client_fd, trigger, sizeof(trigger));
         if (rr == 0) break;
         if (rr < 0) { perror("[a3_server] recv"); break; }
+        tcpinfo_maybe_sample(&ctx.tinfo, client_fd);
+        uint64_t t_recv = (g_timestamps || g_qos) ? mono_ns() : 0;
+
+        // qos mode: a tagged trigger carries its class and may ask for fewer bytes
+        unsigned cls = 0;
+        size_t respLen = g_msgSize;
+        if (g_qos && qos_parse_trigger(trigger, g_msgSize, &cls, &respLen) != 0) {
+            fprintf(stderr, "[a3_server] bad qos trigger (class or size out of range)\n");
+            break;
+        }
 
-        // If zerocopy enabled, wait for completions when pool is empty.
-        if (ctx.zerocopy_enabled) {
-            while (!ctx.free_head) {
-                drain_zerocopy_errqueue(&ctx, true);
-            }
+        // stream mode: a stream request gets the response in credit-paced chunks
+        size_t chunk = 0;
+        unsigned credits = 0;
+        bool streamed = g_stream && stream_req_decode(trigger, &chunk, &credits);
+        if (streamed && (chunk == 0 || credits == 0)) {
+            fprintf(stderr, "[a3_server] bad stream request (chunk=%zu credits=%u)\n", chunk, credits);
+            break;
         }
 
+        // If zerocopy enabled, wait for completions when pool is empty.
+        if (ctx.zerocopy_enabled && wait_free_slot(&ctx) < 0) break;
+
         MsgSlot *s = pop_free(&ctx);
         if (!s) {
             fprintf(stderr, "[a3_server] ERROR: no free slot available\n");
             break;
         }
 
-        if (sendmsg_maybe_zerocopy(&ctx, s) < 0) {
+        // verify mode: the sequence number goes into this slot's own bytes, so a slot
+        // reused before its zerocopy completion corrupts a response the client checks
+        if (g_verify) {
+            uint64_t t0 = mono_ns();
+            verify_put_seq(s->field, s->flen, vseq++);
+            verify_trailer_encode(s->vtrailer, verify_crc_fields(s->field, s->flen));
+            vst.verify_ns += mono_ns() - t0;
+            vst.msgs++;
+            vst.bytes += g_msgSize;
+        }
+
+        // timestamps mode: send_start is taken after waiting for a free slot, so
+        // completion handling shows up in the client's server-side phase
+        if (g_timestamps) {
+            memcpy(&s->ts_hdr.client_send_ns, trigger, sizeof(s->ts_hdr.client_send_ns));
+            s->ts_hdr.server_recv_ns = t_recv;
+            s->ts_hdr.send_start_ns = mono_ns();
+        }
+
+        int src;
+        if (streamed) {
+            chunk_ctx_t ch = { &ctx, s, 0 };
+            src = stream_send(client_fd, respLen, chunk, credits, send_slot_chunk, &ch, &sst);
+        } else if (g_qos) {
+            chunk_ctx_t ch = { &ctx, s, 0 };
+            src = qos_send(&g_sched, cls, respLen, t_recv, send_slot_chunk, &ch);
+        } else {
+            src = sendmsg_maybe_zerocopy(&ctx, s);
+        }
+        if (src < 0) {
             fprintf(stderr, "[a3_server] sendmsg(%s) failed: %s\n",
                     ctx.zerocopy_enabled ? "MSG_ZEROCOPY" : "normal",
                     strerror(errno));
@@ -372,14 +699,33 @@ static void *handle_connection(void *arg) {
             // No completions expected; immediately reuse slot
             push_free(&ctx, s);
         }
+
+        if (g_timestamps && send_ts_trailer(&ctx) < 0) {
+            fprintf(stderr, "[a3_server] send(trailer) failed: %s\n", strerror(errno));
+            break;
+        }
+    }
+
+    if (g_batch) serve_batched(&ctx);
+
+    print_tcpinfo(client_fd, &ctx.tinfo);
+    if (g_stream) stream_srv_print(stderr, "[a3_server]", &sst);
+    if (g_verify) {
+        vst.loop_ns = mono_ns() - t_loop;
+        verify_stats_print(stderr, "[a3_server]", &vst);
     }
+    pace_print(stderr, "[a3_server]", &ctx.pace);
 
-    // Best-effort drain completions before exit
+    // Wait (bounded) for the outstanding completions, so no slot is freed while the
+    // kernel may still send from it
     if (ctx.zerocopy_enabled) {
-        int spins = 0;
-        while (ctx.pending_count > 0 && spins++ < 20) {
-            drain_zerocopy_errqueue(&ctx, true);
+        uint64_t deadline = mono_ns() + (uint64_t)ZC_FLUSH_MS * 1000000ULL;
+        while (ctx.pending_count > 0 && mono_ns() < deadline) {
+            if (drain_zerocopy_errqueue(&ctx, true) < 0) break;
         }
+        if (ctx.pending_count > 0)
+            fprintf(stderr, "[a3_server] %zu slots still pending at close (hangup or %d ms), freeing them\n",
+                    ctx.pending_count, ZC_FLUSH_MS);
         // Move remaining pending to free so we can free all slots below
         while (ctx.pending_head) {
             MsgSlot *tmp = ctx.pending_head;
@@ -398,16 +744,92 @@ static void *handle_connection(void *arg) {
         free_slot(tmp);
     }
 
+    pace_close(&ctx.pace);
     close(client_fd);
     return NULL;
 }
 
+static void on_stop(int sig) {
+    (void)sig;
+    g_stop = 1;
+}
+
 int main(int argc, char **argv) {
     if (argc >= 2) {
         long v = strtol(argv[1], NULL, 10);
         if (v > 0) g_msgSize = (size_t)v;
     }
 
+    for (int i = 2; i < argc; i++) {
+        int tcpinfo = tcpinfo_parse_opt(argv[i]);
+        if (strcmp(argv[i], "--batch") == 0) {
+            g_batch = true;
+        } else if (strcmp(argv[i], "--timestamps") == 0) {
+            g_timestamps = true;
+        } else if (tcpinfo >= 0) {
+            g_tcpinfo_ms = tcpinfo;
+        } else if (strcmp(argv[i], "--qos") == 0 || strncmp(argv[i], "--qos=", 6) == 0) {
+            g_qos = true;
+            if (argv[i][5] == '=') g_qos_weights = argv[i] + 6;
+        } else if (strncmp(argv[i], "--qos-slots=", 12) == 0) {
+            g_qos_slots = (unsigned)atoi(argv[i] + 12);
+        } else if (strcmp(argv[i], "--stream") == 0) {
+            g_stream = true;
+        } else if (strcmp(argv[i], "--framed") == 0 || strncmp(argv[i], "--framed=", 9) == 0) {
+            g_framed = true;
+            if (argv[i][8] == '=') g_frame_weights = argv[i] + 9;
+        } else if (strcmp(argv[i], "--verify") == 0) {
+            g_verify = true;
+        } else if (strncmp(argv[i], "--port=", 7) == 0) {
+            g_port = atoi(argv[i] + 7);
+        } else if (strncmp(argv[i], "--lowat=", 8) == 0) {
+            g_lowat = (size_t)strtoull(argv[i] + 8, NULL, 10);
+            if (g_lowat == 0) { fprintf(stderr, "ERROR: --lowat must be > 0 bytes\n"); return 1; }
+        } else if (strncmp(argv[i], "--pacing=", 9) == 0) {
+            g_pacing_mbps = strtoull(argv[i] + 9, NULL, 10);
+            if (g_pacing_mbps == 0) { fprintf(stderr, "ERROR: --pacing must be > 0 Mbit/s\n"); return 1; }
+        } else if (strncmp(argv[i], "--soak=", 7) == 0) {
+            g_soak_ms = (unsigned)strtoul(argv[i] + 7, NULL, 10);
+            if (g_soak_ms < SOAK_MIN_MS || g_soak_ms > SOAK_MAX_MS) {
+                fprintf(stderr, "ERROR: --soak must be %d..%d ms\n", SOAK_MIN_MS, SOAK_MAX_MS);
+                return 1;
+            }
+        } else {
+            fprintf(stderr, "Usage: %s <msg_size> [--batch] [--timestamps] [--tcpinfo[=ms]] "
+                            "[--qos[=w0,w1,w2,w3]] [--qos-slots=N] [--stream] [--framed[=w0,..,w7]] [--verify] "
+                            "[--port=N] [--lowat=BYTES] [--pacing=MBPS] [--soak=MS]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+
+    if (g_batch && g_timestamps) {
+        fprintf(stderr, "ERROR: --batch and --timestamps cannot be combined\n");
+        return 1;
+    }
+
+    if (g_qos && (g_batch || g_timestamps)) {
+        fprintf(stderr, "ERROR: --qos cannot be combined with --batch or --timestamps\n");
+        return 1;
+    }
+    if (g_stream && (g_batch || g_timestamps || g_qos)) {
+        fprintf(stderr, "ERROR: --stream cannot be combined with --batch, --timestamps or --qos\n");
+        return 1;
+    }
+    if (g_framed && (g_batch || g_timestamps || g_qos || g_stream)) {
+        fprintf(stderr, "ERROR: --framed cannot be combined with --batch, --timestamps, --qos or --stream\n");
+        return 1;
+    }
+    if (g_verify && (g_batch || g_timestamps || g_qos || g_stream || g_framed)) {
+        fprintf(stderr, "ERROR: --verify cannot be combined with --batch, --timestamps, --qos, --stream or --framed\n");
+        return 1;
+    }
+    if (g_qos && (g_qos_slots == 0 || qos_init(&g_sched, g_qos_weights, g_qos_slots) != 0)) {
+        fprintf(stderr, "ERROR: bad --qos weights or --qos-slots (weights: 1..1000, up to %d classes)\n",
+                QOS_MAX_CLASSES);
+        return 1;
+    }
+
     if (g_msgSize < 8) {
         fprintf(stderr, "ERROR: msgSize must be >= 8 bytes\n");
         return 1;
@@ -417,6 +839,21 @@ int main(int argc, char **argv) {
         return 1;
     }
 
+    if (g_port <= 0 || g_port > 65535) {
+        fprintf(stderr, "ERROR: --port must be 1..65535\n");
+        return 1;
+    }
+
+    unsigned weights[FRAME_FIELDS];
+    if (g_frame_weights && frame_parse_weights(g_frame_weights, weights) != 0) {
+        fprintf(stderr, "ERROR: bad --framed weights (8 comma-separated values, 1..1000000)\n");
+        return 1;
+    }
+    if (frame_split(g_msgSize, g_frame_weights ? weights : NULL, g_flen) != 0) {
+        fprintf(stderr, "ERROR: msgSize %zu too small for the --framed weights\n", g_msgSize);
+        return 1;
+    }
+
     int server_fd = socket(AF_INET, SOCK_STREAM, 0);
     if (server_fd < 0) { perror("socket"); return 1; }
 
@@ -427,7 +864,7 @@ int main(int argc, char **argv) {
     memset(&addr, 0, sizeof(addr));
     addr.sin_family = AF_INET;
     addr.sin_addr.s_addr = htonl(INADDR_ANY);
-    addr.sin_port = htons(SERVERPORT);
+    addr.sin_port = htons((uint16_t)g_port);
 
     if (bind(server_fd, (SA*)&addr, sizeof(addr)) < 0) {
         perror("bind");
@@ -440,14 +877,34 @@ int main(int argc, char **argv) {
         return 1;
     }
 
-    fprintf(stderr, "[a3_server] listening on %d, msgSize=%zu bytes (8 fields)\n",
-            SERVERPORT, g_msgSize);
+    fprintf(stderr, "[a3_server] listening on %d, msgSize=%zu bytes (8 fields)%s%s%s%s\n",
+            g_port, g_msgSize, g_batch ? " (batch mode)" : "",
+            g_timestamps ? " (timestamps)" : "",
+            g_qos ? " (qos)" : g_stream ? " (stream)" : g_framed ? " (framed)" : "",
+            g_verify ? " (verify)" : "");
+
+    if (g_soak_ms || g_qos) {
+        // no SA_RESTART: the signal interrupts accept() so the loop ends and the
+        // soak trend / qos totals are printed once
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = on_stop;
+        sigaction(SIGINT, &sa, NULL);
+        sigaction(SIGTERM, &sa, NULL);
+    }
+    if (g_soak_ms) {
+        if (soak_start("[a3_server]", "a3_server", g_soak_ms) != 0) return 1;
+    }
 
-    while (true) {
+    while (!g_stop) {
         SA_IN caddr;
         socklen_t clen = sizeof(caddr);
         int cfd = accept(server_fd, (SA*)&caddr, &clen);
-        if (cfd < 0) { perror("accept"); continue; }
+        if (cfd < 0) {
+            if (errno == EINTR) continue;
+            perror("accept");
+            continue;
+        }
 
         pthread_t tid;
         int *pfd = (int*)malloc(sizeof(int));
@@ -463,6 +920,8 @@ int main(int argc, char **argv) {
         pthread_detach(tid);
     }
 
+    soak_stop();
+    if (g_qos) qos_print(stderr, "[a3_server]", &g_sched);
     close(server_fd);
     return 0;
 }
@@ -0,0 +1,181 @@
+#!/usr/bin/env bash
+# Roll No- MT25024
+# GRS PA02 - Part C: paced send path for large messages (--lowat / --pacing)
+# For every part and msg size in 1..10 MB, run the server four ways:
+#   default | --lowat=LOWAT | --pacing=PACING_MBPS | both
+# and record throughput, the client RTT tail (from --capture) and the server's
+# EPOLLOUT wait statistics.
+
+set -euo pipefail
+
+############################
+# Config
+############################
+SERVER_IP="10.200.1.1"
+PORT="8989"
+
+DUR="${DUR:-10}"
+THREADS="${THREADS:-4}"
+
+LOWAT="${LOWAT:-131072}"
+PACING_MBPS="${PACING_MBPS:-2000}"
+
+OUTDIR="results_pacing"
+CSV="MT25024_Part_C_Pacing_CSV.csv"
+
+PARTS=(1 2 3)
+MSG_SIZES=(1048576 2097152 4194304 8388608 10485760)
+VARIANTS=(default lowat pacing both)
+
+############################
+# Netns helpers
+############################
+cleanup_netns() {
+  sudo ip netns del ns_s 2>/dev/null || true
+  sudo ip netns del ns_c 2>/dev/null || true
+  sudo ip link del veth_s 2>/dev/null || true
+  sudo ip link del veth_c 2>/dev/null || true
+}
+
+setup_netns() {
+  cleanup_netns
+
+  sudo ip netns add ns_s
+  sudo ip netns add ns_c
+
+  sudo ip link add veth_s type veth peer name veth_c
+  sudo ip link set veth_s netns ns_s
+  sudo ip link set veth_c netns ns_c
+
+  sudo ip netns exec ns_s ip addr add 10.200.1.1/24 dev veth_s
+  sudo ip netns exec ns_c ip addr add 10.200.1.2/24 dev veth_c
+
+  sudo ip netns exec ns_s ip link set lo up
+  sudo ip netns exec ns_c ip link set lo up
+  sudo ip netns exec ns_s ip link set veth_s up
+  sudo ip netns exec ns_c ip link set veth_c up
+
+  sudo ip netns exec ns_c ping -c 1 -W 1 10.200.1.1 >/dev/null
+}
+
+variant_opts() {
+  case "$1" in
+    default) echo "" ;;
+    lowat)   echo "--lowat=${LOWAT}" ;;
+    pacing)  echo "--pacing=${PACING_MBPS}" ;;
+    both)    echo "--lowat=${LOWAT} --pacing=${PACING_MBPS}" ;;
+  esac
+}
+
+start_server() {
+  local part="$1"
+  local msg="$2"
+  local opts="$3"
+  local log="$4"
+  sudo ip netns exec ns_s bash -lc "./a${part}_server ${msg} ${opts} > /dev/null 2> ${log} & echo \$!"
+}
+
+stop_server() {
+  local pid="$1"
+  sudo ip netns exec ns_s kill -9 "$pid" >/dev/null 2>&1 || true
+}
+
+############################
+# Parsing helpers
+############################
+parse_throughput() {
+  awk '
+    function v(name,   i){ i = index($0, " " name "="); return i ? substr($0, i + length(name) + 2) + 0 : 0; }
+    /\[A[123] client thread\]/{ sum += v("rx_throughput"); }
+    END{ printf "%.3f\n", sum; }
+  ' "$1"
+}
+
+# capture_read: "rtt count=N avg=.. p50=.. p90=.. p99=.. p999=.. max=.. us" and "... stalls=N"
+parse_capture() {
+  awk '
+    function v(name,   i){ i = index($0, " " name "="); return i ? substr($0, i + length(name) + 2) + 0 : 0; }
+    /^rtt /{ n = v("count"); p50 = v("p50"); p99 = v("p99"); p999 = v("p999"); mx = v("max"); }
+    /^windows=/{ stalls = v("stalls"); }
+    END{ printf "%.0f,%.2f,%.2f,%.2f,%.2f,%.0f\n", n, p50, p99, p999, mx, stalls; }
+  ' "$1"
+}
+
+# one "pace" line per connection: total waits, wait-weighted average, largest max
+parse_pace() {
+  awk '
+    function v(name,   i){ i = index($0, " " name "="); return i ? substr($0, i + length(name) + 2) + 0 : 0; }
+    / pace /{
+      waits += v("epollout_waits");
+      wsum += v("epollout_waits") * v("avg_wait");
+      if (v("max_wait") > wmax) wmax = v("max_wait");
+    }
+    END{ printf "%.0f,%.2f,%.2f\n", waits, (waits > 0 ? wsum / waits : 0), wmax; }
+  ' "$1"
+}
+
+############################
+# One run helper
+############################
+do_one_run() {
+  local part="$1"
+  local msg="$2"
+  local variant="$3"
+  local tag="A${part}_${variant}_msg${msg}_th${THREADS}_dur${DUR}"
+
+  printf "\n[RUN] %s\n" "$tag"
+
+  local server_log="${OUTDIR}/server_${tag}.log"
+  local app_log="${OUTDIR}/app_${tag}.log"
+  local cap_dir="${OUTDIR}/cap_${tag}"
+  rm -rf "$cap_dir"
+  mkdir -p "$cap_dir"
+
+  local spid
+  spid="$(start_server "$part" "$msg" "$(variant_opts "$variant")" "$server_log")"
+  sleep 1
+
+  sudo ip netns exec ns_c "./a${part}_client" "$SERVER_IP" "$PORT" "$msg" "$THREADS" "$DUR" \
+    --capture="$cap_dir" > "$app_log" 2>&1 || true
+
+  # "pace" lines are printed as each connection closes
+  sleep 0.2
+  stop_server "$spid"
+
+  ./capture_read "$cap_dir"/*.cap > "${OUTDIR}/capture_${tag}.txt" 2>&1 || true
+
+  local thr count p50 p99 p999 maxr stalls waits avg_wait max_wait
+  thr="$(parse_throughput "$app_log")"
+  IFS=',' read -r count p50 p99 p999 maxr stalls < <(parse_capture "${OUTDIR}/capture_${tag}.txt")
+  IFS=',' read -r waits avg_wait max_wait < <(parse_pace "$server_log")
+
+  echo "${part},${variant},${msg},${THREADS},${DUR},${LOWAT},${PACING_MBPS},${thr},${count},${p50},${p99},${p999},${maxr},${stalls},${waits},${avg_wait},${max_wait}" >> "$CSV"
+}
+
+############################
+# Main
+############################
+mkdir -p "$OUTDIR"
+
+echo "part,variant,msg_size,threads,duration_sec,lowat_bytes,pacing_mbps,agg_throughput_gbps,responses,rtt_p50_us,rtt_p99_us,rtt_p999_us,rtt_max_us,stall_windows,server_epollout_waits,server_avg_wait_us,server_max_wait_us" > "$CSV"
+
+printf "[INFO] Build...\n"
+make clean >/dev/null
+make -j >/dev/null
+
+printf "[INFO] Setup namespaces...\n"
+setup_netns
+
+for p in "${PARTS[@]}"; do
+  printf "\n========== PART A%d ==========\n" "$p"
+  for m in "${MSG_SIZES[@]}"; do
+    for v in "${VARIANTS[@]}"; do
+      do_one_run "$p" "$m" "$v"
+    done
+  done
+done
+
+printf "\n[DONE] CSV written to: %s\n" "$CSV"
+printf "[DONE] Logs in: %s/\n" "$OUTDIR"
+printf "[INFO] Cleanup namespaces...\n"
+cleanup_netns
@@ -50,6 +50,10 @@ WARMUP=2
 # perf must run in SERVER namespace (ns_s)
 EVENTS="cycles,context-switches,L1-dcache-load-misses,LLC-load-misses"
 
+# TCP_INFO sampling interval (ms) for server and client; off by default so the CSV
+# keeps the committed schema, TCPINFO_MS=100 adds the server_tcp_* columns
+TCPINFO_MS="${TCPINFO_MS:-0}"
+
 OUTDIR="results"
 CSV="MT25024_Part_C_CSV.csv"
 
@@ -95,11 +99,16 @@ setup_netns() {
   sudo ip netns exec ns_c ping -c 1 -W 1 10.200.1.1 >/dev/null
 }
 
+tcpinfo_opt() {
+  if [[ "$TCPINFO_MS" -gt 0 ]]; then echo "--tcpinfo=${TCPINFO_MS}"; fi
+}
+
 start_server() {
   local part="$1"
   local msg="$2"
+  local log="$3"
   local bin="a${part}_server"
-  sudo ip netns exec ns_s bash -lc "./${bin} ${msg} > /dev/null 2>&1 & echo \$!"
+  sudo ip netns exec ns_s bash -lc "./${bin} ${msg} $(tcpinfo_opt) > /dev/null 2> ${log} & echo \$!"
 }
 
 stop_server() {
@@ -128,6 +137,31 @@ parse_client() {
   ' "$f"
 }
 
+# Server prints one tcp_info line per connection: average the *_avg fields
+# across connections and keep the largest *_max.
+parse_tcpinfo() {
+  local f="$1"
+  awk '
+    function v(name,   i){ i = index($0, " " name "="); return i ? substr($0, i + length(name) + 2) + 0 : 0; }
+    BEGIN{n=0; rtt=0; rttmax=0; cwnd=0; retr=0; dlv=0; busy=0; rwnd=0; sndbuf=0;}
+    /tcp_info:/{
+      n++;
+      rtt += v("tcp_rtt_us_avg");  if (v("tcp_rtt_us_max") > rttmax) rttmax = v("tcp_rtt_us_max");
+      cwnd += v("tcp_cwnd_avg");
+      if (v("tcp_retrans_max") > retr) retr = v("tcp_retrans_max");
+      dlv += v("tcp_delivery_mbps_avg");
+      busy += v("tcp_busy_pct_avg");
+      rwnd += v("tcp_rwnd_limited_pct_avg");
+      sndbuf += v("tcp_sndbuf_limited_pct_avg");
+    }
+    END{
+      if (n == 0) { print ",,,,,,,"; exit; }
+      printf "%.2f,%.2f,%.2f,%.0f,%.2f,%.2f,%.2f,%.2f\n",
+             rtt/n, rttmax, cwnd/n, retr, dlv/n, busy/n, rwnd/n, sndbuf/n;
+    }
+  ' "$f"
+}
+
 parse_perf() {
   local f="$1"
   awk '
@@ -157,13 +191,19 @@ do_one_run() {
 
   printf "\n[RUN] %s\n" "$tag"
 
+  local server_log="${OUTDIR}/server_${tag}.log"
+
   local spid
-  spid="$(start_server "$part" "$msg")"
+  spid="$(start_server "$part" "$msg" "$server_log")"
   sleep 1
 
   # Warm-up (no perf)
   sudo ip netns exec ns_c "./a${part}_client" "$SERVER_IP" "$PORT" "$msg" "$thr" "$WARMUP" \
     > "${OUTDIR}/warm_${tag}.log" 2>&1 || true
+  sleep 0.2
+  # tcp_info lines from the warm-up connections are skipped when parsing
+  local warm_lines
+  warm_lines="$(wc -l < "$server_log" 2>/dev/null || echo 0)"
 
   local app_log="${OUTDIR}/app_${tag}.log"
   local perf_log="${OUTDIR}/perf_server_${tag}.txt"
@@ -174,10 +214,14 @@ do_one_run() {
   local perf_pid=$!
 
   # client run in ns_c
-  sudo ip netns exec ns_c "./a${part}_client" "$SERVER_IP" "$PORT" "$msg" "$thr" "$DUR" \
+  sudo ip netns exec ns_c "./a${part}_client" "$SERVER_IP" "$PORT" "$msg" "$thr" "$DUR" $(tcpinfo_opt) \
     > "$app_log" 2>&1 || true
 
   wait "$perf_pid" 2>/dev/null || true
+  sleep 0.2
+  # server peak RSS (VmHWM, kB) over warm-up + run, read before the server is killed
+  local rss
+  rss="$(sudo ip netns exec ns_s awk '/^VmHWM:/{print $2}' "/proc/${spid}/status" 2>/dev/null || true)"
   stop_server "$spid"
 
   local total_rx agg_thr avg_rtt max_rtt time_sec
@@ -186,7 +230,11 @@ do_one_run() {
   IFS=',' read -r total_rx agg_thr avg_rtt max_rtt time_sec < <(parse_client "$app_log")
   IFS=',' read -r cycles l1m llcm ctxsw < <(parse_perf "$perf_log")
 
-  echo "${part},${variant},${msg},${thr},${DUR},${total_rx},${agg_thr},${avg_rtt},${max_rtt},${time_sec},${cycles},${l1m},${llcm},${ctxsw}" >> "$CSV"
+  local row="${part},${variant},${msg},${thr},${DUR},${total_rx},${agg_thr},${avg_rtt},${max_rtt},${time_sec},${cycles},${l1m},${llcm},${ctxsw},${rss}"
+  if [[ "$TCPINFO_MS" -gt 0 ]]; then
+    row="${row},$(tail -n +"$((warm_lines + 1))" "$server_log" | parse_tcpinfo /dev/stdin)"
+  fi
+  echo "$row" >> "$CSV"
 }
 
 ############################
@@ -194,7 +242,11 @@ do_one_run() {
 ############################
 mkdir -p "$OUTDIR"
 
-echo "part,variant,msg_size,threads,duration_sec,total_rx_bytes,agg_throughput_gbps,avg_rtt_us,max_rtt_us,time_sec,server_cycles,server_L1_dcache_load_misses,server_LLC_load_misses,server_context_switches" > "$CSV"
+HEADER="part,variant,msg_size,threads,duration_sec,total_rx_bytes,agg_throughput_gbps,avg_rtt_us,max_rtt_us,time_sec,server_cycles,server_L1_dcache_load_misses,server_LLC_load_misses,server_context_switches,server_peak_rss_kb"
+if [[ "$TCPINFO_MS" -gt 0 ]]; then
+  HEADER="${HEADER},server_tcp_rtt_us_avg,server_tcp_rtt_us_max,server_tcp_cwnd_avg,server_tcp_retrans_max,server_tcp_delivery_mbps_avg,server_tcp_busy_pct_avg,server_tcp_rwnd_limited_pct_avg,server_tcp_sndbuf_limited_pct_avg"
+fi
+echo "$HEADER" > "$CSV"
 
 printf "[INFO] Build...\n"
 make clean >/dev/null
@@ -220,6 +272,12 @@ for p in "${PARTS[@]}"; do
 done
 
 printf "\n[DONE] CSV written to: %s\n" "$CSV"
+
+# Append this run to the result store (keyed by git rev + host + params) so that
+# later runs can be checked with: ../MT25024_Result_Store.py compare --base <rev> --head <rev>
+if command -v python3 >/dev/null 2>&1; then
+  python3 ../MT25024_Result_Store.py record --csv "$CSV" || true
+fi
 printf "[DONE] Logs in: %s/\n" "$OUTDIR"
 printf "[INFO] Cleanup namespaces...\n"
 cleanup_netns
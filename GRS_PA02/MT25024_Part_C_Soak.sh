@@ -0,0 +1,129 @@
+#!/usr/bin/env bash
+# Roll No- MT25024
+# GRS PA02 - Part C: soak runs (hours) with connection churn
+# For every part: server with --soak in ns_s, client with --churn --soak in ns_c for
+# SOAK_HOURS. Both processes sample RSS / fds / threads / VmPin from /proc; the final
+# trend lines are collected into one CSV, with GROWING marking a steadily rising floor.
+
+set -euo pipefail
+
+############################
+# Config
+############################
+SERVER_IP="10.200.1.1"
+PORT="8989"
+
+SOAK_HOURS="${SOAK_HOURS:-2}"
+MSG="${MSG:-65536}"
+THREADS="${THREADS:-4}"
+CHURN_SEC="${CHURN_SEC:-5}"      # each client round: fresh threads + connections
+SAMPLE_MS="${SAMPLE_MS:-1000}"
+
+OUTDIR="results_soak"
+CSV="MT25024_Part_C_Soak_CSV.csv"
+
+PARTS=(1 2 3)
+
+############################
+# Netns helpers
+############################
+cleanup_netns() {
+  sudo ip netns del ns_s 2>/dev/null || true
+  sudo ip netns del ns_c 2>/dev/null || true
+  sudo ip link del veth_s 2>/dev/null || true
+  sudo ip link del veth_c 2>/dev/null || true
+}
+
+setup_netns() {
+  cleanup_netns
+
+  sudo ip netns add ns_s
+  sudo ip netns add ns_c
+
+  sudo ip link add veth_s type veth peer name veth_c
+  sudo ip link set veth_s netns ns_s
+  sudo ip link set veth_c netns ns_c
+
+  sudo ip netns exec ns_s ip addr add 10.200.1.1/24 dev veth_s
+  sudo ip netns exec ns_c ip addr add 10.200.1.2/24 dev veth_c
+
+  sudo ip netns exec ns_s ip link set lo up
+  sudo ip netns exec ns_c ip link set lo up
+  sudo ip netns exec ns_s ip link set veth_s up
+  sudo ip netns exec ns_c ip link set veth_c up
+
+  sudo ip netns exec ns_c ping -c 1 -W 1 10.200.1.1 >/dev/null
+}
+
+############################
+# Parsing helpers
+############################
+# "<tag> soak <metric> first=.. last=.. max=.. floors=a,b,c,d slope=+x/h [GROWING]"
+# -> role,metric,first,last,max,floors,slope_per_h,growing
+parse_soak() {
+  local role="$1"
+  local f="$2"
+  awk -v role="$role" '
+    function v(name,   i, rest){ i = index($0, " " name "="); if (!i) return ""; rest = substr($0, i + length(name) + 2); sub(/ .*/, "", rest); return rest; }
+    / soak (rss_kb|fds|threads|pin_kb) /{
+      for (i = 1; i <= NF; i++) if ($i == "soak") metric = $(i + 1);
+      slope = v("slope"); sub(/\/h$/, "", slope);
+      printf "%s,%s,%s,%s,%s,\"%s\",%s,%d\n", role, metric, v("first"), v("last"), v("max"), v("floors"), slope, ($0 ~ / GROWING$/);
+    }
+  ' "$f" | tail -n 4   # only the final report
+}
+
+############################
+# One soak run
+############################
+do_one_soak() {
+  local part="$1"
+  local dur=$(( SOAK_HOURS * 3600 ))
+  local tag="A${part}_msg${MSG}_th${THREADS}_churn${CHURN_SEC}_${SOAK_HOURS}h"
+
+  printf "\n[SOAK] %s\n" "$tag"
+
+  local server_log="${OUTDIR}/server_${tag}.log"
+  local client_log="${OUTDIR}/client_${tag}.log"
+
+  local spid
+  spid="$(sudo ip netns exec ns_s bash -lc "cd ${OUTDIR} && ../a${part}_server ${MSG} --soak=${SAMPLE_MS} > /dev/null 2> ../${server_log} & echo \$!")"
+  sleep 1
+
+  # per-round client lines go to the log; the soak report is at the end of it
+  (cd "$OUTDIR" && sudo ip netns exec ns_c "../a${part}_client" "$SERVER_IP" "$PORT" "$MSG" "$THREADS" "$dur" \
+    --churn="$CHURN_SEC" --soak="$SAMPLE_MS" > /dev/null 2> "../${client_log}") || true
+
+  sleep 3   # last connections finish their teardown
+  # SIGINT ends the accept loop and prints the server's final trend
+  sudo ip netns exec ns_s kill -INT "$spid" >/dev/null 2>&1 || true
+  sleep 1
+  sudo ip netns exec ns_s kill -9 "$spid" >/dev/null 2>&1 || true
+
+  parse_soak server "$server_log" | sed "s/^/${part},/" >> "$CSV"
+  parse_soak client "$client_log" | sed "s/^/${part},/" >> "$CSV"
+  grep -h "GROWING" "$server_log" "$client_log" || true
+}
+
+############################
+# Main
+############################
+mkdir -p "$OUTDIR"
+
+echo "part,role,metric,first,last,max,floors,slope_per_hour,growing" > "$CSV"
+
+printf "[INFO] Build...\n"
+make clean >/dev/null
+make -j >/dev/null
+
+printf "[INFO] Setup namespaces...\n"
+setup_netns
+
+for p in "${PARTS[@]}"; do
+  do_one_soak "$p"
+done
+
+printf "\n[DONE] CSV written to: %s\n" "$CSV"
+printf "[DONE] Logs and per-sample soak CSVs in: %s/\n" "$OUTDIR"
+printf "[INFO] Cleanup namespaces...\n"
+cleanup_netns
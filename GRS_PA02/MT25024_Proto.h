@@ -0,0 +1,75 @@
+/*
+ * MT25024 – optional wire-protocol extensions shared by the PA02 servers and clients.
+ * The default protocol is unchanged: 8-byte trigger in, msgSize bytes out.
+ */
+#ifndef MT25024_PROTO_H
+#define MT25024_PROTO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+/* CLOCK_MONOTONIC in ns; client and server share it because both run on one host */
+static inline uint64_t mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * --timestamps mode
+ *   trigger  = client send time (uint64_t ns, host byte order; both ends are on one host)
+ *   response = ts_header_t | msgSize payload bytes | ts_trailer_t
+ * send_complete cannot be known before the payload is queued, so it travels in a
+ * trailer right after the payload.
+ */
+typedef struct {
+    uint64_t client_send_ns;   // echoed from the trigger
+    uint64_t server_recv_ns;   // trigger fully received
+    uint64_t send_start_ns;    // response ready, first send call about to be made
+} ts_header_t;
+
+typedef struct {
+    uint64_t send_complete_ns; // last send call for the payload returned
+} ts_trailer_t;
+
+/* tagged triggers / control words are big-endian on the wire */
+static inline void wire_put_be64(void *dst, uint64_t v) {
+    unsigned char *p = (unsigned char *)dst;
+    for (int i = 7; i >= 0; i--, v >>= 8) p[i] = (unsigned char)(v & 0xffu);
+}
+
+static inline uint64_t wire_get_be64(const void *src) {
+    const unsigned char *p = (const unsigned char *)src;
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v = (v << 8) | p[i];
+    return v;
+}
+
+/*
+ * --class mode (QoS): a tagged trigger
+ *   bits 63..48  QOS_TRIGGER_MAGIC
+ *   bits 47..40  priority class (0 .. QOS_MAX_CLASSES-1)
+ *   bits 39..0   requested response size in bytes (<= server msgSize)
+ * Servers started with --qos schedule each response by its class; an untagged
+ * trigger is class 0 with the server's full msgSize.
+ */
+#define QOS_MAX_CLASSES    4
+#define QOS_TRIGGER_MAGIC  0x5153u   /* "QS" */
+
+static inline void qos_trigger_encode(unsigned char *trig, unsigned cls, uint64_t size) {
+    wire_put_be64(trig, ((uint64_t)QOS_TRIGGER_MAGIC << 48) |
+                        ((uint64_t)(cls & 0xffu) << 40) |
+                        (size & 0xffffffffffULL));
+}
+
+/* returns 1 and fills cls/size for a tagged trigger, 0 for an untagged one */
+static inline int qos_trigger_decode(const unsigned char *trig, unsigned *cls, size_t *size) {
+    uint64_t v = wire_get_be64(trig);
+    if ((v >> 48) != QOS_TRIGGER_MAGIC) return 0;
+    *cls = (unsigned)((v >> 40) & 0xffu);
+    *size = (size_t)(v & 0xffffffffffULL);
+    return 1;
+}
+
+#endif
@@ -0,0 +1,319 @@
+/*
+ * MT25024 – TCP relay between the PA02 clients and servers.
+ *
+ * Usage: ./relay <listen_port> <backend_ip:port> [--mode=splice|copy] [--buf=BYTES]
+ *
+ * Thread-per-connection like the servers: every accepted client gets its own
+ * backend connection and one thread per direction.
+ *   splice (default) – socket -> pipe -> socket with splice(), the payload never
+ *                      enters user space
+ *   copy             – recv() into a user buffer, then send(), for comparison
+ *
+ * When a connection closes the relay prints, per direction: bytes, forward latency
+ * (read returned -> last byte of that chunk written), throughput while active, and
+ * the thread's CPU cost per byte (CPU time, and cycles when perf counters are allowed).
+ * The relay's added RTT is the client's avg_rtt through the relay minus avg_rtt direct.
+ */
+#define _GNU_SOURCE
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/perf_event.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "MT25024_Proto.h"
+#include "MT25024_Stats.h"
+
+#define SERVER_BACKLOG 128
+#define DEFAULT_BUF (64 * 1024)
+
+typedef struct sockaddr_in SA_IN;
+typedef struct sockaddr SA;
+
+static SA_IN g_backend;
+static bool g_splice = true;        // --mode=splice|copy
+static size_t g_buf = DEFAULT_BUF;  // --buf=BYTES: pipe size (splice) or user buffer (copy)
+
+typedef struct {
+    const char *name;               // "c2s" / "s2c"
+    int in, out;
+    unsigned long long bytes;
+    unsigned long long chunks;      // reads that returned data
+    uint64_t first_ns, last_ns;
+    uint64_t cpu_ns;
+    long long cycles;               // -1 when no counter could be opened
+    bool cycles_user_only;          // perf_event_paranoid only allowed user-space counting
+    lat_hist_t fwd;
+    int err;
+} dir_t;
+
+/* cycles of the calling thread, kernel included if allowed; -1 if perf is unavailable */
+static int open_cycles(bool *user_only) {
+    struct perf_event_attr pe;
+    memset(&pe, 0, sizeof(pe));
+    pe.type = PERF_TYPE_HARDWARE;
+    pe.size = sizeof(pe);
+    pe.config = PERF_COUNT_HW_CPU_CYCLES;
+    pe.exclude_hv = 1;
+
+    *user_only = false;
+    int fd = (int)syscall(SYS_perf_event_open, &pe, 0, -1, -1, 0);
+    if (fd < 0) {
+        pe.exclude_kernel = 1;
+        *user_only = true;
+        fd = (int)syscall(SYS_perf_event_open, &pe, 0, -1, -1, 0);
+    }
+    return fd;
+}
+
+static uint64_t thread_cpu_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int send_all(int fd, const char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, buf, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        buf += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+/* one direction until EOF or error; then half-close the other side */
+static void *forward(void *arg) {
+    dir_t *d = (dir_t*)arg;
+    int pfd[2] = { -1, -1 };
+    char *buf = NULL;
+
+    if (g_splice) {
+        if (pipe2(pfd, O_CLOEXEC) != 0) { perror("pipe2"); d->err = 1; goto out; }
+        (void)fcntl(pfd[1], F_SETPIPE_SZ, (int)g_buf);   // best effort; default is 64KB
+    } else {
+        buf = (char*)malloc(g_buf);
+        if (!buf) { perror("malloc"); d->err = 1; goto out; }
+    }
+
+    int cfd = open_cycles(&d->cycles_user_only);
+    if (cfd >= 0) ioctl(cfd, PERF_EVENT_IOC_RESET, 0);
+    uint64_t cpu0 = thread_cpu_ns();
+
+    for (;;) {
+        ssize_t n;
+        if (g_splice) n = splice(d->in, NULL, pfd[1], NULL, g_buf, SPLICE_F_MOVE);
+        else n = recv(d->in, buf, g_buf, 0);
+        if (n == 0) break;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno != ECONNRESET) perror(g_splice ? "splice in" : "recv");
+            d->err = 1;
+            break;
+        }
+
+        uint64_t t_in = mono_ns();
+        if (d->first_ns == 0) d->first_ns = t_in;
+
+        if (g_splice) {
+            ssize_t left = n;
+            while (left > 0) {
+                ssize_t m = splice(pfd[0], NULL, d->out, NULL, (size_t)left, SPLICE_F_MOVE);
+                if (m < 0 && errno == EINTR) continue;
+                if (m <= 0) { d->err = 1; break; }
+                left -= m;
+            }
+        } else if (send_all(d->out, buf, (size_t)n) != 0) {
+            d->err = 1;
+        }
+        if (d->err) break;
+
+        d->last_ns = mono_ns();
+        lat_hist_add(&d->fwd, d->last_ns - t_in);
+        d->bytes += (unsigned long long)n;
+        d->chunks++;
+    }
+
+    d->cpu_ns = thread_cpu_ns() - cpu0;
+    d->cycles = -1;
+    if (cfd >= 0) {
+        long long c;
+        if (read(cfd, &c, sizeof(c)) == (ssize_t)sizeof(c)) d->cycles = c;
+        close(cfd);
+    }
+
+out:
+    shutdown(d->out, SHUT_WR);
+    if (pfd[0] >= 0) { close(pfd[0]); close(pfd[1]); }
+    free(buf);
+    return NULL;
+}
+
+static void print_dir(const dir_t *d) {
+    double secs = d->last_ns > d->first_ns ? (double)(d->last_ns - d->first_ns) / 1e9 : 0.0;
+    double gbps = secs > 0 ? (double)d->bytes * 8.0 / (secs * 1e9) : 0.0;
+    double b = d->bytes ? (double)d->bytes : 1.0;
+
+    char cyc[64];
+    if (d->cycles >= 0)
+        snprintf(cyc, sizeof(cyc), "%s=%.3f", d->cycles_user_only ? "user_cycles_per_byte" : "cycles_per_byte",
+                 (double)d->cycles / b);
+    else
+        snprintf(cyc, sizeof(cyc), "cycles_per_byte=n/a");
+
+    fprintf(stderr, "[relay] %s bytes=%llu chunks=%llu throughput=%.3f Gbps cpu_ns_per_byte=%.4f %s\n",
+            d->name, d->bytes, d->chunks, gbps, (double)d->cpu_ns / b, cyc);
+    char label[64];
+    snprintf(label, sizeof(label), "[relay] %s forward", d->name);
+    lat_hist_print(stderr, label, &d->fwd);
+}
+
+static void *handle_connection(void *arg) {
+    int cfd = *(int*)arg;
+    free(arg);
+
+    int one = 1;
+    setsockopt(cfd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    int sfd = socket(AF_INET, SOCK_STREAM, 0);
+    if (sfd < 0) { perror("socket"); close(cfd); return NULL; }
+    setsockopt(sfd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (connect(sfd, (SA*)&g_backend, sizeof(g_backend)) < 0) {
+        perror("connect backend");
+        close(sfd);
+        close(cfd);
+        return NULL;
+    }
+
+    dir_t *d = (dir_t*)calloc(2, sizeof(dir_t));
+    if (!d) { perror("calloc"); close(sfd); close(cfd); return NULL; }
+    d[0].name = "c2s"; d[0].in = cfd; d[0].out = sfd;
+    d[1].name = "s2c"; d[1].in = sfd; d[1].out = cfd;
+
+    // client -> server on a helper thread, server -> client here
+    pthread_t tid;
+    if (pthread_create(&tid, NULL, forward, &d[0]) != 0) {
+        perror("pthread_create");
+        free(d);
+        close(sfd);
+        close(cfd);
+        return NULL;
+    }
+    forward(&d[1]);
+    pthread_join(tid, NULL);
+
+    print_dir(&d[0]);
+    print_dir(&d[1]);
+
+    free(d);
+    close(sfd);
+    close(cfd);
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    signal(SIGPIPE, SIG_IGN);
+
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <listen_port> <backend_ip:port> [--mode=splice|copy] [--buf=BYTES]\n", argv[0]);
+        return 1;
+    }
+
+    int port = atoi(argv[1]);
+    char ip[64];
+    const char *colon = strrchr(argv[2], ':');
+    if (port <= 0 || port > 65535 || !colon || (size_t)(colon - argv[2]) >= sizeof(ip)) {
+        fprintf(stderr, "ERROR: bad listen port or backend (expected ip:port)\n");
+        return 1;
+    }
+    memcpy(ip, argv[2], (size_t)(colon - argv[2]));
+    ip[colon - argv[2]] = '\0';
+
+    memset(&g_backend, 0, sizeof(g_backend));
+    g_backend.sin_family = AF_INET;
+    g_backend.sin_port = htons((uint16_t)atoi(colon + 1));
+    if (inet_pton(AF_INET, ip, &g_backend.sin_addr) != 1 || g_backend.sin_port == 0) {
+        fprintf(stderr, "ERROR: bad backend address '%s'\n", argv[2]);
+        return 1;
+    }
+
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "--mode=splice") == 0) {
+            g_splice = true;
+        } else if (strcmp(argv[i], "--mode=copy") == 0) {
+            g_splice = false;
+        } else if (strncmp(argv[i], "--buf=", 6) == 0) {
+            g_buf = (size_t)strtoull(argv[i] + 6, NULL, 10);
+            if (g_buf < 4096 || g_buf > (64u << 20)) {
+                fprintf(stderr, "ERROR: --buf must be 4096..67108864 bytes\n");
+                return 1;
+            }
+        } else {
+            fprintf(stderr, "Usage: %s <listen_port> <backend_ip:port> [--mode=splice|copy] [--buf=BYTES]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+
+    int lfd = socket(AF_INET, SOCK_STREAM, 0);
+    if (lfd < 0) { perror("socket"); return 1; }
+
+    int one = 1;
+    setsockopt(lfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    SA_IN addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons((uint16_t)port);
+
+    if (bind(lfd, (SA*)&addr, sizeof(addr)) < 0) {
+        perror("bind");
+        close(lfd);
+        return 1;
+    }
+    if (listen(lfd, SERVER_BACKLOG) < 0) {
+        perror("listen");
+        close(lfd);
+        return 1;
+    }
+
+    fprintf(stderr, "[relay] listening on %d -> %s, mode=%s buf=%zu\n",
+            port, argv[2], g_splice ? "splice" : "copy", g_buf);
+
+    while (true) {
+        int cfd = accept(lfd, NULL, NULL);
+        if (cfd < 0) { perror("accept"); continue; }
+
+        pthread_t tid;
+        int *pfd = (int*)malloc(sizeof(int));
+        if (!pfd) { perror("malloc"); close(cfd); continue; }
+        *pfd = cfd;
+
+        if (pthread_create(&tid, NULL, handle_connection, pfd) != 0) {
+            perror("pthread_create");
+            close(cfd);
+            free(pfd);
+            continue;
+        }
+        pthread_detach(tid);
+    }
+
+    close(lfd);
+    return 0;
+}
@@ -0,0 +1,446 @@
+/*
+ * MT25024 – trace-driven replay client.
+ *
+ * Usage: ./replay_client <server_ip> <port> <trace_file> [--conns=N] [--segment=SEC]
+ *                        [--speed=X] [--drain=SEC]
+ *
+ * The trace is a text file, one request per line:
+ *     <t_us> <size> <conn>        (whitespace or comma separated, '#' starts a comment)
+ *   t_us  send time relative to the start of the trace, microseconds (up to 3 decimals)
+ *   size  response size in bytes (1 .. the server's msgSize)
+ *   conn  connection id; ids are mapped onto --conns=N connections (default: max id + 1)
+ * Lines must be in time order. The file is mmap'd and parsed in place, once to
+ * validate it and once while replaying, so traces larger than memory work too.
+ *
+ * Each request goes out as a QoS tagged trigger carrying its size (class 0), so the
+ * server must run with --qos. Replay is open loop: a request is sent at its trace
+ * time whether or not earlier responses have arrived, and its latency is measured
+ * from that scheduled time, so a slow server cannot slow the offered load down.
+ * Responses on one connection come back in order.
+ *
+ * Reported: latency percentiles per trace segment (--segment, default 1 s of trace
+ * time), the whole-run distribution, and how late the client itself sent (send_lag).
+ */
+#define _GNU_SOURCE
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "MT25024_Proto.h"
+#include "MT25024_Stats.h"
+
+#define REPLAY_MAX_CONNS    512
+#define REPLAY_MAX_SEGMENTS 3600
+#define SINK_BYTES (256 * 1024)       // response bytes are read into this and dropped
+#define READ_BUDGET (4 * SINK_BYTES)  // per connection per wakeup, so one big response cannot delay sends
+
+typedef struct {
+    uint64_t t_ns;   // trace time
+    uint64_t size;
+    unsigned conn;   // already mapped onto the open connections
+} rec_t;
+
+/* cursor over the mapped trace; never reads past end (the file need not end in '\n') */
+typedef struct {
+    const char *p, *end;
+    unsigned long line;
+} trace_cur_t;
+
+typedef struct {
+    uint64_t t_sched_ns;   // start + trace time / speed
+    uint64_t size;
+    unsigned seg;
+} owed_t;
+
+/* one connection: responses come back in trigger order; the FIFO grows as needed (open loop) */
+typedef struct {
+    int fd;
+    owed_t *q;
+    size_t cap, head, len;   // cap is a power of two
+    uint64_t got;            // bytes of the head response received so far
+} conn_t;
+
+typedef struct {
+    lat_hist_t lat;          // scheduled send -> full response
+    unsigned long long bytes;
+} segment_t;
+
+static void skip_line(trace_cur_t *c) {
+    while (c->p < c->end && *c->p != '\n') c->p++;
+    if (c->p < c->end) c->p++;
+    c->line++;
+}
+
+static void skip_sep(trace_cur_t *c) {
+    while (c->p < c->end && (*c->p == ' ' || *c->p == '\t' || *c->p == ',' || *c->p == '\r')) c->p++;
+}
+
+/* unsigned decimal with up to 'frac' fractional digits, scaled by 10^frac; -1 if none */
+static int parse_fixed(trace_cur_t *c, int frac, uint64_t *out) {
+    uint64_t v = 0;
+    int digits = 0;
+    while (c->p < c->end && *c->p >= '0' && *c->p <= '9') {
+        v = v * 10 + (uint64_t)(*c->p++ - '0');
+        digits++;
+    }
+    int f = 0;
+    if (frac > 0 && c->p < c->end && *c->p == '.') {
+        c->p++;
+        while (c->p < c->end && *c->p >= '0' && *c->p <= '9') {
+            if (f < frac) { v = v * 10 + (uint64_t)(*c->p - '0'); f++; }
+            c->p++;
+            digits++;
+        }
+    }
+    for (; f < frac; f++) v *= 10;
+    *out = v;
+    return digits ? 0 : -1;
+}
+
+/* next record: 1 = got one, 0 = end of trace, -1 = malformed line (c->line says which) */
+static int trace_next(trace_cur_t *c, rec_t *r) {
+    for (;;) {
+        skip_sep(c);
+        if (c->p >= c->end) return 0;
+        if (*c->p == '\n' || *c->p == '#') { skip_line(c); continue; }
+
+        uint64_t conn;
+        if (parse_fixed(c, 3, &r->t_ns) != 0) return -1;   // us with 3 decimals == ns
+        skip_sep(c);
+        if (parse_fixed(c, 0, &r->size) != 0) return -1;
+        skip_sep(c);
+        if (parse_fixed(c, 0, &conn) != 0) return -1;
+        skip_sep(c);
+        if (c->p < c->end && *c->p == '#') skip_line(c);
+        else if (c->p < c->end && *c->p != '\n') return -1;
+        else skip_line(c);
+
+        r->conn = conn > 0xffffffffULL ? 0xffffffffu : (unsigned)conn;
+        return 1;
+    }
+}
+
+static int connect_to(const char *ip, int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) { perror("socket"); return -1; }
+
+    int one = 1;
+    (void)setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    struct sockaddr_in sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons((uint16_t)port);
+    if (inet_pton(AF_INET, ip, &sa.sin_addr) != 1) {
+        fprintf(stderr, "inet_pton failed for %s\n", ip);
+        close(fd);
+        return -1;
+    }
+    if (connect(fd, (struct sockaddr*)&sa, sizeof(sa)) < 0) {
+        fprintf(stderr, "connect %s:%d: %s\n", ip, port, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int conn_push(conn_t *c, const owed_t *o) {
+    if (c->len == c->cap) {
+        size_t ncap = c->cap ? c->cap * 2 : 64;
+        owed_t *nq = (owed_t*)malloc(ncap * sizeof(owed_t));
+        if (!nq) return -1;
+        for (size_t i = 0; i < c->len; i++) nq[i] = c->q[(c->head + i) & (c->cap - 1)];
+        free(c->q);
+        c->q = nq;
+        c->cap = ncap;
+        c->head = 0;
+    }
+    c->q[(c->head + c->len) & (c->cap - 1)] = *o;
+    c->len++;
+    return 0;
+}
+
+/* blocking 8-byte tagged trigger asking for 'size' bytes */
+static int conn_send(conn_t *c, uint64_t size) {
+    unsigned char trig[8];
+    qos_trigger_encode(trig, 0, size);
+    size_t sent = 0;
+    while (sent < sizeof(trig)) {
+        ssize_t n = send(c->fd, trig + sent, sizeof(trig) - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        sent += (size_t)n;
+    }
+    return 0;
+}
+
+/* read what is available on c (up to READ_BUDGET); returns completed responses or -1 on error / close */
+static int conn_read(conn_t *c, char *sink, segment_t *segs, lat_hist_t *all) {
+    int done = 0;
+    size_t budget = READ_BUDGET;
+    while (c->len > 0 && budget > 0) {
+        owed_t *o = &c->q[c->head];
+        uint64_t want = o->size - c->got;
+        if (want > SINK_BYTES) want = SINK_BYTES;
+        ssize_t r = recv(c->fd, sink, (size_t)want, MSG_DONTWAIT);
+        if (r == 0) return -1;
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return -1;
+        }
+        budget -= (size_t)r < budget ? (size_t)r : budget;
+        c->got += (uint64_t)r;
+        if (c->got < o->size) continue;
+
+        uint64_t lat = mono_ns() - o->t_sched_ns;
+        lat_hist_add(&segs[o->seg].lat, lat);
+        lat_hist_add(all, lat);
+        segs[o->seg].bytes += o->size;
+        c->head = (c->head + 1) & (c->cap - 1);
+        c->len--;
+        c->got = 0;
+        done++;
+    }
+    return done;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "Usage: %s <server_ip> <port> <trace_file> [options]\n"
+        "  trace lines: <t_us> <size> <conn>; the server must run with --qos and msgSize >= max size\n"
+        "  --conns=N      connections to open; trace conn ids are taken modulo N\n"
+        "                 (default: max conn id + 1, at most %d)\n"
+        "  --segment=SEC  trace time per reported segment (default 1)\n"
+        "  --speed=X      replay X times faster than recorded (default 1)\n"
+        "  --drain=SEC    how long to wait for outstanding responses after the last send (default 5)\n",
+        prog, REPLAY_MAX_CONNS);
+}
+
+int main(int argc, char **argv) {
+    signal(SIGPIPE, SIG_IGN);
+
+    if (argc < 4) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    const char *ip = argv[1];
+    int port = atoi(argv[2]);
+    const char *path = argv[3];
+    unsigned nconns = 0;
+    double seg_sec = 1.0, speed = 1.0, drain_sec = 5.0;
+
+    for (int i = 4; i < argc; i++) {
+        if (strncmp(argv[i], "--conns=", 8) == 0) {
+            nconns = (unsigned)atoi(argv[i] + 8);
+            if (nconns == 0 || nconns > REPLAY_MAX_CONNS) {
+                fprintf(stderr, "--conns must be 1..%d\n", REPLAY_MAX_CONNS);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--segment=", 10) == 0) {
+            seg_sec = atof(argv[i] + 10);
+        } else if (strncmp(argv[i], "--speed=", 8) == 0) {
+            speed = atof(argv[i] + 8);
+        } else if (strncmp(argv[i], "--drain=", 8) == 0) {
+            drain_sec = atof(argv[i] + 8);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (port <= 0 || port > 65535) { fprintf(stderr, "port must be 1..65535\n"); return 1; }
+    if (seg_sec <= 0) { fprintf(stderr, "--segment must be > 0\n"); return 1; }
+    if (speed <= 0) { fprintf(stderr, "--speed must be > 0\n"); return 1; }
+    if (drain_sec < 0) { fprintf(stderr, "--drain must be >= 0\n"); return 1; }
+
+    int tfd = open(path, O_RDONLY | O_CLOEXEC);
+    if (tfd < 0) { perror(path); return 1; }
+    struct stat stt;
+    if (fstat(tfd, &stt) != 0 || stt.st_size == 0) {
+        fprintf(stderr, "%s: empty or unreadable trace\n", path);
+        close(tfd);
+        return 1;
+    }
+    const char *map = (const char*)mmap(NULL, (size_t)stt.st_size, PROT_READ, MAP_PRIVATE, tfd, 0);
+    close(tfd);
+    if (map == MAP_FAILED) { perror("mmap trace"); return 1; }
+    (void)madvise((void*)map, (size_t)stt.st_size, MADV_SEQUENTIAL);
+
+    // pass 1: validate, and find the span, the largest size and the connection count
+    trace_cur_t cur = { map, map + stt.st_size, 1 };
+    rec_t r;
+    unsigned long long nrec = 0, total_bytes = 0;
+    uint64_t last_t = 0, max_size = 0;
+    unsigned max_conn = 0;
+    int rc;
+    while ((rc = trace_next(&cur, &r)) == 1) {
+        if (r.size == 0 || r.size > 0xffffffffffULL) {
+            fprintf(stderr, "%s:%lu: size must be 1..2^40-1\n", path, cur.line - 1);
+            return 1;
+        }
+        if (r.t_ns < last_t) {
+            fprintf(stderr, "%s:%lu: timestamps must not go backwards\n", path, cur.line - 1);
+            return 1;
+        }
+        last_t = r.t_ns;
+        if (r.size > max_size) max_size = r.size;
+        if (r.conn > max_conn) max_conn = r.conn;
+        total_bytes += r.size;
+        nrec++;
+    }
+    if (rc < 0) { fprintf(stderr, "%s:%lu: expected '<t_us> <size> <conn>'\n", path, cur.line); return 1; }
+    if (nrec == 0) { fprintf(stderr, "%s: no records\n", path); return 1; }
+    if (nconns == 0) {
+        if (max_conn >= REPLAY_MAX_CONNS) {
+            fprintf(stderr, "trace uses conn ids up to %u; pass --conns=N (at most %d)\n", max_conn, REPLAY_MAX_CONNS);
+            return 1;
+        }
+        nconns = max_conn + 1;
+    }
+
+    uint64_t seg_ns = (uint64_t)(seg_sec * 1e9);
+    if (seg_ns == 0) seg_ns = 1;
+    unsigned nseg = (unsigned)(last_t / seg_ns + 1);
+    if (last_t / seg_ns >= REPLAY_MAX_SEGMENTS) {
+        fprintf(stderr, "trace spans more than %d segments; use a larger --segment\n", REPLAY_MAX_SEGMENTS);
+        return 1;
+    }
+
+    segment_t *segs = (segment_t*)calloc(nseg, sizeof(segment_t));
+    unsigned long long *seg_reqs = (unsigned long long*)calloc(nseg, sizeof(unsigned long long));
+    conn_t *conns = (conn_t*)calloc(nconns, sizeof(conn_t));
+    struct pollfd *pfd = (struct pollfd*)calloc(nconns, sizeof(struct pollfd));
+    unsigned *pidx = (unsigned*)calloc(nconns, sizeof(unsigned));
+    char *sink = (char*)malloc(SINK_BYTES);
+    static lat_hist_t all, send_lag;
+    if (!segs || !seg_reqs || !conns || !pfd || !pidx || !sink) { perror("malloc"); return 1; }
+
+    for (unsigned i = 0; i < nconns; i++) {
+        conns[i].fd = connect_to(ip, port);
+        if (conns[i].fd < 0) return 1;
+    }
+
+    fprintf(stderr, "[replay] %s: records=%llu span=%.3f s bytes=%llu max_size=%llu conns=%u speed=%.2f\n",
+            path, nrec, (double)last_t / 1e9, total_bytes, (unsigned long long)max_size, nconns, speed);
+
+    // ppoll() timeouts would otherwise be rounded up by the default 50 us timer slack
+    (void)prctl(PR_SET_TIMERSLACK, 1UL, 0, 0, 0);
+
+    // pass 2: replay, parsing the mapping again as we go
+    cur = (trace_cur_t){ map, map + stt.st_size, 1 };
+    bool have = trace_next(&cur, &r) == 1;
+    unsigned long long sent = 0, completed = 0, outstanding = 0;
+    bool failed = false;
+    uint64_t start = mono_ns();
+    uint64_t drain_end = 0;
+
+    while (!failed) {
+        uint64_t now = mono_ns();
+
+        // everything that is due goes out now, late sends are recorded in send_lag
+        while (have) {
+            uint64_t sched = start + (uint64_t)((double)r.t_ns / speed);
+            if (sched > now) break;
+            conn_t *c = &conns[r.conn % nconns];
+            owed_t o = { sched, r.size, (unsigned)(r.t_ns / seg_ns) };
+            if (conn_send(c, r.size) != 0 || conn_push(c, &o) != 0) {
+                perror("send trigger");
+                failed = true;
+                break;
+            }
+            lat_hist_add(&send_lag, now - sched);
+            seg_reqs[o.seg]++;
+            sent++;
+            outstanding++;
+            have = trace_next(&cur, &r) == 1;
+            now = mono_ns();
+        }
+        if (failed) break;
+
+        uint64_t deadline;
+        if (have) {
+            deadline = start + (uint64_t)((double)r.t_ns / speed);
+        } else {
+            if (outstanding == 0) break;
+            if (drain_end == 0) drain_end = now + (uint64_t)(drain_sec * 1e9);
+            if (now >= drain_end) break;
+            deadline = drain_end;
+        }
+
+        unsigned n = 0;
+        for (unsigned i = 0; i < nconns; i++) {
+            if (conns[i].len == 0) continue;
+            pfd[n].fd = conns[i].fd;
+            pfd[n].events = POLLIN;
+            pidx[n++] = i;
+        }
+        uint64_t wait = deadline > now ? deadline - now : 0;
+        struct timespec ts = { (time_t)(wait / 1000000000ULL), (long)(wait % 1000000000ULL) };
+        int pr = ppoll(pfd, n, &ts, NULL);
+        if (pr < 0) {
+            if (errno == EINTR) continue;
+            perror("ppoll");
+            break;
+        }
+        for (unsigned k = 0; k < n && pr > 0; k++) {
+            if (!(pfd[k].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            int d = conn_read(&conns[pidx[k]], sink, segs, &all);
+            if (d < 0) {
+                fprintf(stderr, "[replay] connection %u closed by server (is it running with --qos and a "
+                                "msgSize >= %llu?)\n", pidx[k], (unsigned long long)max_size);
+                failed = true;
+                break;
+            }
+            completed += (unsigned long long)d;
+            outstanding -= (unsigned long long)d;
+        }
+    }
+
+    double elapsed = (double)(mono_ns() - start) / 1e9;
+    double seg_wall = (double)seg_ns / 1e9 / speed;
+    fprintf(stderr, "[replay] sent=%llu completed=%llu lost=%llu unsent=%llu time=%.2f sec\n",
+            sent, completed, sent - completed, nrec - sent, elapsed);
+
+    for (unsigned s = 0; s < nseg; s++) {
+        if (seg_reqs[s] == 0) continue;
+        char label[128];
+        fprintf(stderr, "[replay] seg=%u trace_t=[%.3f,%.3f) s reqs=%llu done=%llu offered=%.0f/s "
+                        "rx_throughput=%.3f Gbps\n",
+                s, (double)s * seg_sec, (double)(s + 1) * seg_sec, seg_reqs[s], segs[s].lat.count,
+                (double)seg_reqs[s] / seg_wall, (double)segs[s].bytes * 8.0 / (seg_wall * 1e9));
+        snprintf(label, sizeof(label), "[replay] seg=%u lat", s);
+        lat_hist_print(stderr, label, &segs[s].lat);
+    }
+    lat_hist_print(stderr, "[replay] all lat", &all);
+    lat_hist_print(stderr, "[replay] send_lag", &send_lag);
+
+    for (unsigned i = 0; i < nconns; i++) {
+        close(conns[i].fd);
+        free(conns[i].q);
+    }
+    munmap((void*)map, (size_t)stt.st_size);
+    free(sink);
+    free(pidx);
+    free(pfd);
+    free(conns);
+    free(seg_reqs);
+    free(segs);
+    return failed ? 1 : 0;
+}
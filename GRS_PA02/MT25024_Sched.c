@@ -0,0 +1,153 @@
+#include "MT25024_Sched.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+struct qos_waiter {
+    size_t bytes;
+    int granted;
+    pthread_cond_t cv;
+    qos_waiter_t *next;
+};
+
+int qos_init(qos_sched_t *s, const char *weights, unsigned slots) {
+    memset(s, 0, sizeof(*s));
+    pthread_mutex_init(&s->mu, NULL);
+    s->slots = slots ? slots : 1;
+    s->fresh = 1;
+    for (int i = 0; i < QOS_MAX_CLASSES; i++) s->cls[i].weight = 1;
+
+    if (!weights || !*weights) return 0;
+
+    const char *p = weights;
+    for (int i = 0; i < QOS_MAX_CLASSES && *p; i++) {
+        char *end;
+        unsigned long w = strtoul(p, &end, 10);
+        if (end == p || w == 0 || w > 1000) return -1;
+        s->cls[i].weight = (unsigned)w;
+        if (*end == ',') end++;
+        else if (*end != '\0') return -1;
+        p = end;
+    }
+    return *p ? -1 : 0;
+}
+
+/*
+ * Deficit round robin over the class queues, called with mu held whenever a slot
+ * frees up or a response starts waiting. On each visit a backlogged class gets
+ * weight x quantum bytes of credit and its head responses are granted while they
+ * fit; an empty class loses its credit so idle time cannot be banked.
+ */
+static void dispatch(qos_sched_t *s) {
+    while (s->busy < s->slots && s->waiting > 0) {
+        qos_class_t *c = &s->cls[s->cur];
+
+        if (!c->head) {
+            c->deficit = 0;
+            s->cur = (s->cur + 1) % QOS_MAX_CLASSES;
+            s->fresh = 1;
+            continue;
+        }
+        if (s->fresh) {
+            c->deficit += (size_t)c->weight * QOS_QUANTUM_BYTES;
+            s->fresh = 0;
+        }
+        if (c->head->bytes <= c->deficit) {
+            qos_waiter_t *w = c->head;
+            c->head = w->next;
+            if (!c->head) c->tail = NULL;
+            c->deficit -= w->bytes;
+            s->waiting--;
+            s->busy++;
+            w->granted = 1;
+            pthread_cond_signal(&w->cv);
+            continue;
+        }
+        s->cur = (s->cur + 1) % QOS_MAX_CLASSES;
+        s->fresh = 1;
+    }
+}
+
+static uint64_t qos_acquire(qos_sched_t *s, unsigned cls, size_t bytes) {
+    qos_waiter_t w;
+    w.bytes = bytes;
+    w.granted = 0;
+    w.next = NULL;
+    pthread_cond_init(&w.cv, NULL);
+
+    pthread_mutex_lock(&s->mu);
+    qos_class_t *c = &s->cls[cls];
+    if (c->tail) c->tail->next = &w;
+    else c->head = &w;
+    c->tail = &w;
+    s->waiting++;
+
+    dispatch(s);
+    while (!w.granted) pthread_cond_wait(&w.cv, &s->mu);
+    pthread_mutex_unlock(&s->mu);
+
+    pthread_cond_destroy(&w.cv);
+    return mono_ns();
+}
+
+static void qos_release(qos_sched_t *s, unsigned cls, size_t bytes) {
+    pthread_mutex_lock(&s->mu);
+    s->cls[cls].bytes += bytes;
+    s->busy--;
+    dispatch(s);
+    pthread_mutex_unlock(&s->mu);
+}
+
+int qos_send(qos_sched_t *s, unsigned cls, size_t bytes, uint64_t t_recv_ns, qos_send_fn fn, void *arg) {
+    if (cls >= QOS_MAX_CLASSES) cls = QOS_MAX_CLASSES - 1;
+
+    // one grant covers the class's whole quantum (weight x QOS_QUANTUM_BYTES), sent in
+    // chunks while the slot is held: a connection asks again only after its turn, so a
+    // class with a single sender still gets its weight's share per DRR round
+    size_t quantum = (size_t)s->cls[cls].weight * QOS_QUANTUM_BYTES;
+    uint64_t t_grant = 0;
+    int rc = 0;
+    for (size_t off = 0; off < bytes && rc == 0; ) {
+        size_t grant = bytes - off < quantum ? bytes - off : quantum;
+        uint64_t g = qos_acquire(s, cls, grant);
+        if (t_grant == 0) t_grant = g;
+        for (size_t sent = 0; sent < grant && rc == 0; sent += QOS_CHUNK_BYTES) {
+            size_t len = grant - sent < QOS_CHUNK_BYTES ? grant - sent : QOS_CHUNK_BYTES;
+            rc = fn(arg, off + sent, len);
+        }
+        qos_release(s, cls, grant);
+        off += grant;
+    }
+    if (rc != 0) return rc;
+
+    uint64_t now = mono_ns();
+    pthread_mutex_lock(&s->mu);
+    qos_class_t *c = &s->cls[cls];
+    if (c->first_ns == 0) c->first_ns = t_grant;
+    c->last_ns = now;
+    c->msgs++;
+    lat_hist_add(&c->wait, t_grant - t_recv_ns);
+    lat_hist_add(&c->total, now - t_recv_ns);
+    pthread_mutex_unlock(&s->mu);
+    return 0;
+}
+
+void qos_print(FILE *fp, const char *tag, qos_sched_t *s) {
+    pthread_mutex_lock(&s->mu);
+    for (int i = 0; i < QOS_MAX_CLASSES; i++) {
+        const qos_class_t *c = &s->cls[i];
+        if (c->msgs == 0) continue;
+
+        double secs = (c->last_ns > c->first_ns) ? (double)(c->last_ns - c->first_ns) / 1e9 : 0.0;
+        double gbps = secs > 0 ? (double)c->bytes * 8.0 / (secs * 1e9) : 0.0;
+        fprintf(fp, "%s qos class=%d weight=%u msgs=%llu bytes=%llu throughput=%.3f Gbps\n",
+                tag, i, c->weight, c->msgs, c->bytes, gbps);
+
+        char label[128];
+        snprintf(label, sizeof(label), "%s qos class=%d wait", tag, i);
+        lat_hist_print(fp, label, &c->wait);
+        snprintf(label, sizeof(label), "%s qos class=%d total", tag, i);
+        lat_hist_print(fp, label, &c->total);
+    }
+    pthread_mutex_unlock(&s->mu);
+}
@@ -0,0 +1,80 @@
+/*
+ * MT25024 – weighted-fair (deficit round robin) send scheduler for the PA02 servers.
+ * Without it every connection thread sends as soon as it has a response, so a
+ * client pulling 10 MB responses competes on equal terms with 8 KB clients.
+ * With --qos a response is sent in grants of up to weight x QOS_QUANTUM_BYTES (its
+ * class's quantum), each holding one of the scheduler's send slots while it goes out
+ * in QOS_CHUNK_BYTES pieces. Waiting grants are served in DRR order across priority
+ * classes, so backlogged classes share send bandwidth by weight in bytes even with
+ * one connection each, and a small response waits for at most one grant per slot,
+ * not for a whole 10 MB response. Weights only matter while the slots are contended:
+ * with more slots than backlogged senders every grant goes out at once.
+ */
+#ifndef MT25024_SCHED_H
+#define MT25024_SCHED_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "MT25024_Proto.h"
+#include "MT25024_Stats.h"
+
+#define QOS_QUANTUM_BYTES (64 * 1024)
+#define QOS_CHUNK_BYTES   (64 * 1024)
+
+typedef struct qos_waiter qos_waiter_t;
+
+typedef struct {
+    unsigned weight;
+    size_t deficit;              // bytes this class may still send in the current round
+    qos_waiter_t *head, *tail;   // FIFO of chunks waiting for a slot
+
+    // per-class report (cumulative since server start)
+    unsigned long long msgs;
+    unsigned long long bytes;
+    uint64_t first_ns, last_ns;  // first grant / last completed send
+    lat_hist_t wait;             // trigger received -> first chunk granted
+    lat_hist_t total;            // trigger received -> response sent
+} qos_class_t;
+
+typedef struct {
+    pthread_mutex_t mu;
+    unsigned slots;              // chunks allowed to be sending at once
+    unsigned busy;
+    unsigned waiting;
+    unsigned cur;                // DRR position
+    int fresh;                   // cur has not received its quantum for this visit yet
+    qos_class_t cls[QOS_MAX_CLASSES];
+} qos_sched_t;
+
+/* weights: "w0,w1,..." (missing classes get weight 1), NULL = all 1; returns -1 on bad input */
+int qos_init(qos_sched_t *s, const char *weights, unsigned slots);
+
+/*
+ * class and response size of one trigger: untagged -> class 0, msg_size bytes.
+ * Returns -1 when a tagged trigger asks for an unknown class or more than msg_size.
+ */
+static inline int qos_parse_trigger(const void *trig, size_t msg_size, unsigned *cls, size_t *bytes) {
+    *cls = 0;
+    *bytes = msg_size;
+    if (!qos_trigger_decode((const unsigned char *)trig, cls, bytes)) return 0;
+    if (*bytes == 0) *bytes = msg_size;
+    return (*cls < QOS_MAX_CLASSES && *bytes <= msg_size) ? 0 : -1;
+}
+
+/* sends bytes [off, off + len) of the current response; 0 on success */
+typedef int (*qos_send_fn)(void *arg, size_t off, size_t len);
+
+/*
+ * send one response of 'bytes' bytes for class cls through fn, chunk by chunk,
+ * each chunk holding a scheduler slot; records the class's wait / total latency
+ * from t_recv_ns (trigger received). Returns the first non-zero fn result.
+ */
+int qos_send(qos_sched_t *s, unsigned cls, size_t bytes, uint64_t t_recv_ns, qos_send_fn fn, void *arg);
+
+/* one line per class that has traffic: weight, msgs, bytes, Gbps, then wait and total latency */
+void qos_print(FILE *fp, const char *tag, qos_sched_t *s);
+
+#endif
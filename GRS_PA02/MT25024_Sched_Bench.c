@@ -0,0 +1,113 @@
+/*
+ * MT25024 – check of the --qos scheduler's byte shares, without sockets.
+ *
+ * Usage: ./sched_bench [seconds] [weights] [senders_per_class] [slots]
+ *        e.g. ./sched_bench 1 8,1 1 1
+ *
+ * Every class given a weight gets senders_per_class threads that push 1 MB responses
+ * through qos_send() back to back, so all classes stay backlogged. The "send" of a
+ * chunk copies it into the thread's own buffer and then sleeps for the time the chunk
+ * takes on a LINK_GBPS link, like a send blocking on a full socket buffer, so the
+ * other senders get the CPU and queue for a slot. At the end it prints each class's
+ * bytes and share next to weight / sum of weights, and exits 1 when a share is off
+ * by more than QOS_CHECK_TOL of the expected share (only meaningful while the
+ * slots are contended, i.e. slots < classes x senders).
+ */
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "MT25024_Sched.h"
+
+#define RESP_BYTES    (1024 * 1024)
+#define QOS_CHECK_TOL 0.15
+#define LINK_GBPS     10.0
+
+static qos_sched_t g_sched;
+static int g_stop = 0;
+
+typedef struct {
+    unsigned cls;
+    char *src, *dst;
+} sender_t;
+
+static int copy_chunk(void *arg, size_t off, size_t len) {
+    sender_t *s = (sender_t*)arg;
+    memcpy(s->dst + off, s->src + off, len);
+    struct timespec ts = { 0, (long)((double)len * 8.0 / LINK_GBPS) };
+    nanosleep(&ts, NULL);
+    return 0;
+}
+
+static void *sender(void *arg) {
+    sender_t *s = (sender_t*)arg;
+    while (!__atomic_load_n(&g_stop, __ATOMIC_ACQUIRE))
+        qos_send(&g_sched, s->cls, RESP_BYTES, mono_ns(), copy_chunk, s);
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    double secs = argc > 1 ? atof(argv[1]) : 1.0;
+    const char *weights = argc > 2 ? argv[2] : "8,1";
+    int per = argc > 3 ? atoi(argv[3]) : 1;
+    unsigned slots = argc > 4 ? (unsigned)atoi(argv[4]) : 1;
+    if (secs <= 0 || per <= 0 || slots == 0 || qos_init(&g_sched, weights, slots) != 0) {
+        fprintf(stderr, "Usage: %s [seconds] [weights] [senders_per_class] [slots]\n", argv[0]);
+        return 1;
+    }
+
+    // classes in use: as many as weights were given
+    int ncls = 1;
+    for (const char *p = weights; *p; p++) if (*p == ',') ncls++;
+    if (ncls > QOS_MAX_CLASSES) ncls = QOS_MAX_CLASSES;
+
+    int n = ncls * per;
+    pthread_t *tids = (pthread_t*)calloc((size_t)n, sizeof(pthread_t));
+    sender_t *snd = (sender_t*)calloc((size_t)n, sizeof(sender_t));
+    if (!tids || !snd) { perror("calloc"); return 1; }
+    for (int i = 0; i < n; i++) {
+        snd[i].cls = (unsigned)(i % ncls);
+        snd[i].src = (char*)malloc(RESP_BYTES);
+        snd[i].dst = (char*)malloc(RESP_BYTES);
+        if (!snd[i].src || !snd[i].dst) { perror("malloc"); return 1; }
+        memset(snd[i].src, 'A' + (int)snd[i].cls, RESP_BYTES);
+        memset(snd[i].dst, 0, RESP_BYTES);
+    }
+
+    for (int i = 0; i < n; i++) {
+        if (pthread_create(&tids[i], NULL, sender, &snd[i]) != 0) { perror("pthread_create"); return 1; }
+    }
+    struct timespec ts = { .tv_sec = (time_t)secs, .tv_nsec = (long)((secs - (double)(time_t)secs) * 1e9) };
+    nanosleep(&ts, NULL);
+    __atomic_store_n(&g_stop, 1, __ATOMIC_RELEASE);
+    for (int i = 0; i < n; i++) pthread_join(tids[i], NULL);
+
+    unsigned long long total = 0;
+    unsigned wsum = 0;
+    for (int c = 0; c < ncls; c++) {
+        total += g_sched.cls[c].bytes;
+        wsum += g_sched.cls[c].weight;
+    }
+    int bad = 0;
+    printf("sched_bench: %.2f s, weights=%s, %d sender(s) per class, %u slot(s)\n", secs, weights, per, slots);
+    for (int c = 0; c < ncls; c++) {
+        double share = total ? (double)g_sched.cls[c].bytes / (double)total : 0.0;
+        double want = (double)g_sched.cls[c].weight / (double)wsum;
+        double dev = (share - want) / want;
+        bool off = dev > QOS_CHECK_TOL || dev < -QOS_CHECK_TOL;
+        bad |= off;
+        printf("  class=%d weight=%u bytes=%llu share=%.3f expected=%.3f%s\n", c, g_sched.cls[c].weight,
+               g_sched.cls[c].bytes, share, want, off ? " OFF" : "");
+    }
+    printf("sched_bench: %s\n", bad ? "FAIL (shares do not follow the weights)" : "ok");
+
+    for (int i = 0; i < n; i++) {
+        free(snd[i].src);
+        free(snd[i].dst);
+    }
+    free(snd);
+    free(tids);
+    return bad;
+}
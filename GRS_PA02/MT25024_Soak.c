@@ -0,0 +1,219 @@
+#include "MT25024_Soak.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "MT25024_Proto.h"
+
+#define SOAK_METRICS 4
+#define SOAK_BLOCKS  256            // block minima kept for the floors (even)
+
+typedef struct {
+    double t;                       // seconds since soak_start
+    double v[SOAK_METRICS];         // rss_kb, fds, threads, pin_kb
+} soak_sample_t;
+
+static const struct {
+    const char *name;
+    double tol;                     // smallest rise of the floor that counts as growth
+} g_metric[SOAK_METRICS] = {
+    { "rss_kb",  1024 },            // allocator arenas move by more than a page
+    { "fds",     1 },
+    { "threads", 1 },
+    { "pin_kb",  4 },
+};
+
+static struct {
+    bool started;
+    int stop;                       // set by soak_stop, read with __atomic
+    pthread_t tid;
+    unsigned interval_ms;
+    char tag[64];
+    FILE *csv;
+    uint64_t t0;
+    // running state only (the raw samples go to the CSV), so a long soak does not
+    // grow the sampler: first/last/max, least-squares sums, and the minimum of each
+    // block of 'per' samples; when all blocks are used, pairs merge and 'per' doubles
+    size_t n;
+    soak_sample_t first, last;
+    double vmax[SOAK_METRICS];
+    double st, stt, sv[SOAK_METRICS], stv[SOAK_METRICS];
+    double blk[SOAK_BLOCKS][SOAK_METRICS];
+    size_t nblk, per, in_blk;       // blocks in use, samples per block, samples in the last one
+} g_soak;
+
+/* VmRSS, VmPin (kB) and Threads from /proc/self/status */
+static int read_status(double *rss_kb, double *pin_kb, double *threads) {
+    FILE *f = fopen("/proc/self/status", "r");
+    if (!f) return -1;
+    char line[256];
+    *rss_kb = *pin_kb = *threads = 0;
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, "VmRSS:", 6) == 0) *rss_kb = strtod(line + 6, NULL);
+        else if (strncmp(line, "VmPin:", 6) == 0) *pin_kb = strtod(line + 6, NULL);
+        else if (strncmp(line, "Threads:", 8) == 0) *threads = strtod(line + 8, NULL);
+    }
+    fclose(f);
+    return 0;
+}
+
+static double count_fds(void) {
+    DIR *d = opendir("/proc/self/fd");
+    if (!d) return 0;
+    double n = 0;
+    struct dirent *e;
+    while ((e = readdir(d)) != NULL) {
+        if (e->d_name[0] != '.') n++;
+    }
+    closedir(d);
+    return n - 1;   // the directory stream's own fd
+}
+
+static void take_sample(void) {
+    soak_sample_t x;
+    x.t = (double)(mono_ns() - g_soak.t0) / 1e9;
+    if (read_status(&x.v[0], &x.v[3], &x.v[2]) != 0) return;
+    x.v[1] = count_fds();
+
+    if (g_soak.n++ == 0) {
+        g_soak.first = x;
+        memcpy(g_soak.vmax, x.v, sizeof(g_soak.vmax));
+        g_soak.per = 1;
+    }
+    g_soak.last = x;
+    g_soak.st += x.t;
+    g_soak.stt += x.t * x.t;
+    for (int m = 0; m < SOAK_METRICS; m++) {
+        g_soak.sv[m] += x.v[m];
+        g_soak.stv[m] += x.t * x.v[m];
+        if (x.v[m] > g_soak.vmax[m]) g_soak.vmax[m] = x.v[m];
+    }
+
+    if (g_soak.in_blk == 0) {
+        if (g_soak.nblk == SOAK_BLOCKS) {
+            for (size_t b = 0; b < SOAK_BLOCKS / 2; b++)
+                for (int m = 0; m < SOAK_METRICS; m++) {
+                    double a = g_soak.blk[2 * b][m], c = g_soak.blk[2 * b + 1][m];
+                    g_soak.blk[b][m] = a < c ? a : c;
+                }
+            g_soak.nblk = SOAK_BLOCKS / 2;
+            g_soak.per *= 2;
+        }
+        memcpy(g_soak.blk[g_soak.nblk++], x.v, sizeof(x.v));
+    } else {
+        double *b = g_soak.blk[g_soak.nblk - 1];
+        for (int m = 0; m < SOAK_METRICS; m++) if (x.v[m] < b[m]) b[m] = x.v[m];
+    }
+    if (++g_soak.in_blk == g_soak.per) g_soak.in_blk = 0;
+
+    if (g_soak.csv) {
+        fprintf(g_soak.csv, "%.3f,%.0f,%.0f,%.0f,%.0f\n", x.t, x.v[0], x.v[1], x.v[2], x.v[3]);
+        fflush(g_soak.csv);   // readable while the run is still going
+    }
+}
+
+static void report(void) {
+    size_t n = g_soak.n;
+    if (n < 2 * SOAK_SEGMENTS) {
+        fprintf(stderr, "%s soak samples=%zu (too few for a trend)\n", g_soak.tag, n);
+        return;
+    }
+    const soak_sample_t *s0 = &g_soak.first, *s1 = &g_soak.last;
+    fprintf(stderr, "%s soak samples=%zu span=%.1f s interval=%u ms\n",
+            g_soak.tag, n, s1->t - s0->t, g_soak.interval_ms);
+
+    size_t nb = g_soak.nblk;
+    for (int m = 0; m < SOAK_METRICS; m++) {
+        // segment floors from the block minima (equal parts up to one block)
+        double floor[SOAK_SEGMENTS];
+        for (int g = 0; g < SOAK_SEGMENTS; g++) {
+            size_t lo = nb * (size_t)g / SOAK_SEGMENTS, hi = nb * (size_t)(g + 1) / SOAK_SEGMENTS;
+            floor[g] = g_soak.blk[lo][m];
+            for (size_t i = lo; i < hi; i++) if (g_soak.blk[i][m] < floor[g]) floor[g] = g_soak.blk[i][m];
+        }
+
+        // least-squares slope over all samples
+        double den = (double)n * g_soak.stt - g_soak.st * g_soak.st;
+        double slope = den > 0 ? ((double)n * g_soak.stv[m] - g_soak.st * g_soak.sv[m]) / den : 0.0;
+
+        bool growing = floor[SOAK_SEGMENTS - 1] - floor[0] >= g_metric[m].tol;
+        for (int g = 1; g < SOAK_SEGMENTS; g++) if (floor[g] <= floor[g - 1]) growing = false;
+
+        char floors[128];
+        int off = 0;
+        for (int g = 0; g < SOAK_SEGMENTS && off < (int)sizeof(floors); g++)
+            off += snprintf(floors + off, sizeof(floors) - (size_t)off, "%s%.0f", g ? "," : "", floor[g]);
+
+        fprintf(stderr, "%s soak %-7s first=%.0f last=%.0f max=%.0f floors=%s slope=%+.1f/h%s\n",
+                g_soak.tag, g_metric[m].name, s0->v[m], s1->v[m], g_soak.vmax[m], floors, slope * 3600.0,
+                growing ? " GROWING" : "");
+    }
+}
+
+static void *soak_main(void *arg) {
+    (void)arg;
+    uint64_t next = mono_ns(), next_report = next + (uint64_t)SOAK_REPORT_SEC * 1000000000ULL;
+    while (!__atomic_load_n(&g_soak.stop, __ATOMIC_ACQUIRE)) {
+        uint64_t now = mono_ns();
+        if (now >= next) {
+            take_sample();
+            next += (uint64_t)g_soak.interval_ms * 1000000ULL;
+            if (next < now) next = now;   // fell behind (suspended): do not burst
+        }
+        if (now >= next_report) {
+            report();
+            next_report += (uint64_t)SOAK_REPORT_SEC * 1000000000ULL;
+        }
+        // short naps so soak_stop() does not wait a whole interval
+        uint64_t nap = next > now ? next - now : 0;
+        if (nap > 100000000ULL) nap = 100000000ULL;
+        struct timespec ts = { .tv_sec = 0, .tv_nsec = (long)nap };
+        nanosleep(&ts, NULL);
+    }
+    return NULL;
+}
+
+int soak_start(const char *tag, const char *prog, unsigned interval_ms) {
+    if (g_soak.started) return 0;
+    snprintf(g_soak.tag, sizeof(g_soak.tag), "%s", tag);
+    g_soak.interval_ms = interval_ms;
+    g_soak.t0 = mono_ns();
+
+    char path[256];
+    snprintf(path, sizeof(path), "%s.%ld.soak.csv", prog, (long)getpid());
+    g_soak.csv = fopen(path, "w");
+    if (!g_soak.csv) {
+        fprintf(stderr, "soak: %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    fprintf(g_soak.csv, "t_s,rss_kb,fds,threads,pin_kb\n");
+
+    // the sampler's own thread and the CSV fd are in every sample, so they do not show as growth
+    if (pthread_create(&g_soak.tid, NULL, soak_main, NULL) != 0) {
+        perror("soak: pthread_create");
+        fclose(g_soak.csv);
+        g_soak.csv = NULL;
+        return -1;
+    }
+    g_soak.started = true;
+    fprintf(stderr, "%s soak: sampling every %u ms into %s\n", tag, interval_ms, path);
+    return 0;
+}
+
+void soak_stop(void) {
+    if (!g_soak.started) return;
+    __atomic_store_n(&g_soak.stop, 1, __ATOMIC_RELEASE);
+    pthread_join(g_soak.tid, NULL);
+    take_sample();
+    report();
+    fclose(g_soak.csv);
+    memset(&g_soak, 0, sizeof(g_soak));
+}
@@ -0,0 +1,32 @@
+/*
+ * MT25024 – soak sampling (--soak=MS on the servers and clients).
+ *
+ * A background thread reads /proc/self every MS milliseconds and appends one line to
+ * <prog>.<pid>.soak.csv in the working directory:
+ *   t_s,rss_kb,fds,threads,pin_kb
+ *   rss_kb   VmRSS                        fds      entries in /proc/self/fd
+ *   threads  Threads                      pin_kb   VmPin: pages pinned by MSG_ZEROCOPY sends
+ *                                                  (not accounted with CAP_IPC_LOCK, e.g. root)
+ * Every SOAK_REPORT_SEC, and once more from soak_stop(), it prints one trend line per
+ * metric. The samples are cut into SOAK_SEGMENTS equal parts and the minimum of each
+ * part is taken, so the connection churn itself drops out and only the floor is left.
+ * Only running minima and sums are kept in memory (the raw samples are in the CSV),
+ * so the sampler does not grow however long the soak runs.
+ * A metric is flagged GROWING when every floor is above the one before and the last is
+ * at least the metric's tolerance above the first.
+ */
+#ifndef MT25024_SOAK_H
+#define MT25024_SOAK_H
+
+#define SOAK_SEGMENTS   4
+#define SOAK_REPORT_SEC 600
+#define SOAK_MIN_MS     10
+#define SOAK_MAX_MS     3600000
+
+/* start the sampler (one per process); tag prefixes the report lines. Returns 0 or -1. */
+int soak_start(const char *tag, const char *prog, unsigned interval_ms);
+
+/* stop the sampler and print the final trend lines; a no-op if it was never started */
+void soak_stop(void);
+
+#endif
@@ -0,0 +1,146 @@
+#include "MT25024_Stats.h"
+
+#include <string.h>
+
+void log2_hist_add(log2_hist_t *h, unsigned long long v) {
+    int b = 0;
+    while (b < LOG2_HIST_BUCKETS - 1 && (v >> (b + 1)) != 0) b++;
+    h->bucket[b]++;
+    h->count++;
+    h->sum += v;
+    if (v > h->max) h->max = v;
+}
+
+void log2_hist_print(FILE *fp, const char *label, const log2_hist_t *h) {
+    double avg = h->count ? (double)h->sum / (double)h->count : 0.0;
+    fprintf(fp, "%s count=%llu avg=%.2f max=%llu hist=", label, h->count, avg, h->max);
+
+    int printed = 0;
+    for (int i = 0; i < LOG2_HIST_BUCKETS; i++) {
+        if (!h->bucket[i]) continue;
+        unsigned long long lo = (i == 0) ? 0 : (1ULL << i);
+        unsigned long long hi = (1ULL << (i + 1)) - 1;
+        fprintf(fp, "%s[%llu-%llu]:%llu", printed++ ? "," : "", lo, hi, h->bucket[i]);
+    }
+    fprintf(fp, "\n");
+}
+
+void batch_stats_print(FILE *fp, const char *tag, const batch_stats_t *b) {
+    unsigned long long calls = b->recv_calls + b->send_calls;
+    double per_msg = b->msgs ? (double)calls / (double)b->msgs : 0.0;
+
+    fprintf(fp, "%s batch: msgs=%llu recv_calls=%llu send_calls=%llu syscalls_per_msg=%.3f\n",
+            tag, b->msgs, b->recv_calls, b->send_calls, per_msg);
+
+    char label[128];
+    snprintf(label, sizeof(label), "%s batch_size:", tag);
+    log2_hist_print(fp, label, &b->batch);
+}
+
+static int lat_bucket(unsigned long long v) {
+    if (v < LAT_HIST_SUB) return (int)v;
+    int msb = 63 - __builtin_clzll(v);
+    int sub = (int)((v >> (msb - 4)) & (LAT_HIST_SUB - 1));
+    return (msb - 3) * LAT_HIST_SUB + sub;
+}
+
+/* smallest value that maps to bucket b */
+static unsigned long long lat_bucket_lo(int b) {
+    if (b < LAT_HIST_SUB) return (unsigned long long)b;
+    int msb = b / LAT_HIST_SUB + 3;
+    int sub = b % LAT_HIST_SUB;
+    return (1ULL << msb) | ((unsigned long long)sub << (msb - 4));
+}
+
+void lat_hist_add(lat_hist_t *h, unsigned long long ns) {
+    h->bucket[lat_bucket(ns)]++;
+    if (h->count == 0 || ns < h->min_ns) h->min_ns = ns;
+    if (ns > h->max_ns) h->max_ns = ns;
+    h->count++;
+    h->sum_ns += ns;
+}
+
+void lat_hist_merge(lat_hist_t *dst, const lat_hist_t *src) {
+    if (src->count == 0) return;
+    for (int i = 0; i < LAT_HIST_BUCKETS; i++) dst->bucket[i] += src->bucket[i];
+    if (dst->count == 0 || src->min_ns < dst->min_ns) dst->min_ns = src->min_ns;
+    if (src->max_ns > dst->max_ns) dst->max_ns = src->max_ns;
+    dst->count += src->count;
+    dst->sum_ns += src->sum_ns;
+}
+
+unsigned long long lat_hist_percentile(const lat_hist_t *h, double pct) {
+    if (h->count == 0) return 0;
+    unsigned long long rank = (unsigned long long)((pct / 100.0) * (double)h->count);
+    if (rank >= h->count) rank = h->count - 1;
+
+    unsigned long long seen = 0;
+    for (int i = 0; i < LAT_HIST_BUCKETS; i++) {
+        seen += h->bucket[i];
+        if (seen > rank) {
+            unsigned long long v = lat_bucket_lo(i);
+            return v > h->max_ns ? h->max_ns : v;
+        }
+    }
+    return h->max_ns;
+}
+
+void lat_hist_print(FILE *fp, const char *label, const lat_hist_t *h) {
+    double avg = h->count ? (double)h->sum_ns / (double)h->count : 0.0;
+    fprintf(fp, "%s count=%llu avg=%.2f p50=%.2f p90=%.2f p99=%.2f p999=%.2f max=%.2f us hist_us=",
+            label, h->count, avg / 1e3,
+            lat_hist_percentile(h, 50.0) / 1e3, lat_hist_percentile(h, 90.0) / 1e3,
+            lat_hist_percentile(h, 99.0) / 1e3, lat_hist_percentile(h, 99.9) / 1e3,
+            h->max_ns / 1e3);
+
+    // fold into power-of-two microsecond buckets for a compact text histogram
+    log2_hist_t us;
+    memset(&us, 0, sizeof(us));
+    for (int i = 0; i < LAT_HIST_BUCKETS; i++) {
+        if (!h->bucket[i]) continue;
+        unsigned long long v = lat_bucket_lo(i) / 1000ULL;
+        int b = 0;
+        while (b < LOG2_HIST_BUCKETS - 1 && (v >> (b + 1)) != 0) b++;
+        us.bucket[b] += h->bucket[i];
+    }
+
+    int printed = 0;
+    for (int i = 0; i < LOG2_HIST_BUCKETS; i++) {
+        if (!us.bucket[i]) continue;
+        unsigned long long lo = (i == 0) ? 0 : (1ULL << i);
+        fprintf(fp, "%s[%llu-%llu]:%llu", printed++ ? "," : "", lo, (1ULL << (i + 1)) - 1, us.bucket[i]);
+    }
+    fprintf(fp, "\n");
+}
+
+/* clamp to 0: all stamps come from one CLOCK_MONOTONIC, but be safe against reordering */
+static unsigned long long span_ns(uint64_t from, uint64_t to) {
+    return (to > from) ? (unsigned long long)(to - from) : 0ULL;
+}
+
+void ts_phases_add(ts_phases_t *p, const ts_header_t *h, const ts_trailer_t *t, uint64_t client_done_ns) {
+    lat_hist_add(&p->req,    span_ns(h->client_send_ns, h->server_recv_ns));
+    lat_hist_add(&p->server, span_ns(h->server_recv_ns, h->send_start_ns));
+    lat_hist_add(&p->send,   span_ns(h->send_start_ns, t->send_complete_ns));
+    lat_hist_add(&p->resp,   span_ns(t->send_complete_ns, client_done_ns));
+    lat_hist_add(&p->total,  span_ns(h->client_send_ns, client_done_ns));
+}
+
+void ts_phases_merge(ts_phases_t *dst, const ts_phases_t *src) {
+    lat_hist_merge(&dst->req, &src->req);
+    lat_hist_merge(&dst->server, &src->server);
+    lat_hist_merge(&dst->send, &src->send);
+    lat_hist_merge(&dst->resp, &src->resp);
+    lat_hist_merge(&dst->total, &src->total);
+}
+
+void ts_phases_print(FILE *fp, const char *tag, const ts_phases_t *p) {
+    static const char *names[] = { "req_transit", "server_prep", "server_send", "resp_tail", "total" };
+    const lat_hist_t *h[] = { &p->req, &p->server, &p->send, &p->resp, &p->total };
+
+    for (int i = 0; i < 5; i++) {
+        char label[128];
+        snprintf(label, sizeof(label), "%s phase=%s", tag, names[i]);
+        lat_hist_print(fp, label, h[i]);
+    }
+}
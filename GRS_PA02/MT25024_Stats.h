@@ -0,0 +1,71 @@
+/*
+ * MT25024 – shared statistics helpers for the PA02 servers and clients.
+ * Kept separate from the Part A sources so the six programs can report the
+ * same distributions in the same format.
+ */
+#ifndef MT25024_STATS_H
+#define MT25024_STATS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "MT25024_Proto.h"
+
+/* power-of-two histogram: bucket i counts values in [2^i, 2^(i+1)), 0 goes to bucket 0 */
+#define LOG2_HIST_BUCKETS 24
+
+typedef struct {
+    unsigned long long bucket[LOG2_HIST_BUCKETS];
+    unsigned long long count;
+    unsigned long long sum;
+    unsigned long long max;
+} log2_hist_t;
+
+void log2_hist_add(log2_hist_t *h, unsigned long long v);
+void log2_hist_print(FILE *fp, const char *label, const log2_hist_t *h);
+
+/* server-side request batching counters (one per connection) */
+typedef struct {
+    unsigned long long msgs;        // responses sent
+    unsigned long long recv_calls;  // recv() syscalls used to read triggers
+    unsigned long long send_calls;  // send()/sendmsg() syscalls used for responses
+    log2_hist_t batch;              // responses per batch
+} batch_stats_t;
+
+void batch_stats_print(FILE *fp, const char *tag, const batch_stats_t *b);
+
+/*
+ * latency histogram in nanoseconds: log-linear buckets (16 sub-buckets per power
+ * of two, ~6% resolution), enough for percentiles from ns up to minutes
+ */
+#define LAT_HIST_SUB     16
+#define LAT_HIST_BUCKETS (64 * LAT_HIST_SUB)
+
+typedef struct {
+    unsigned long long bucket[LAT_HIST_BUCKETS];
+    unsigned long long count;
+    unsigned long long sum_ns;
+    unsigned long long min_ns;
+    unsigned long long max_ns;
+} lat_hist_t;
+
+void lat_hist_add(lat_hist_t *h, unsigned long long ns);
+void lat_hist_merge(lat_hist_t *dst, const lat_hist_t *src);
+unsigned long long lat_hist_percentile(const lat_hist_t *h, double pct);
+/* one line: count, avg, p50/p90/p99/p99.9, max (all in us) + power-of-two us histogram */
+void lat_hist_print(FILE *fp, const char *label, const lat_hist_t *h);
+
+/* client-side one-way latency decomposition (--timestamps mode) */
+typedef struct {
+    lat_hist_t req;     // client send       -> server recv      (request transit)
+    lat_hist_t server;  // server recv       -> send start       (A1 pack copy, A3 slot wait)
+    lat_hist_t send;    // send start        -> send complete    (send syscalls)
+    lat_hist_t resp;    // send complete     -> client recv done (response tail)
+    lat_hist_t total;   // client send       -> client recv done
+} ts_phases_t;
+
+void ts_phases_add(ts_phases_t *p, const ts_header_t *h, const ts_trailer_t *t, uint64_t client_done_ns);
+void ts_phases_merge(ts_phases_t *dst, const ts_phases_t *src);
+void ts_phases_print(FILE *fp, const char *tag, const ts_phases_t *p);
+
+#endif
@@ -0,0 +1,159 @@
+#include "MT25024_Stream.h"
+
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0x4000
+#endif
+
+void stream_req_encode(void *trig, size_t chunk, unsigned credits) {
+    if (credits > 0xffffu) credits = 0xffffu;
+    wire_put_be64(trig, ((uint64_t)STREAM_REQ_MAGIC << 48) | ((uint64_t)credits << 32) |
+                        (uint64_t)(chunk & 0xffffffffu));
+}
+
+int stream_req_decode(const void *trig, size_t *chunk, unsigned *credits) {
+    uint64_t v = wire_get_be64(trig);
+    if ((v >> 48) != STREAM_REQ_MAGIC) return 0;
+    *credits = (unsigned)((v >> 32) & 0xffffu);
+    *chunk = (size_t)(v & 0xffffffffu);
+    return 1;
+}
+
+/* ---------- server side ---------- */
+
+/* blocks for one credit message; returns the credits it carries, or -1 */
+static long recv_credit(int fd) {
+    unsigned char msg[8];
+    size_t got = 0;
+    while (got < sizeof(msg)) {
+        ssize_t r = recv(fd, msg + got, sizeof(msg) - got, 0);
+        if (r == 0) return -1;
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        got += (size_t)r;
+    }
+    uint64_t v = wire_get_be64(msg);
+    if ((v >> 48) != STREAM_CREDIT_MAGIC) return -1;
+    return (long)(v & 0xffffffffu);
+}
+
+int stream_send(int fd, size_t bytes, size_t chunk, unsigned credits,
+                stream_send_fn fn, void *arg, stream_srv_stats_t *st) {
+    for (size_t off = 0; off < bytes; off += chunk) {
+        if (credits == 0) {
+            uint64_t t0 = mono_ns();
+            while (credits == 0) {
+                long c = recv_credit(fd);
+                if (c < 0) return -1;
+                credits = (unsigned)c;
+            }
+            st->credit_stalls++;
+            lat_hist_add(&st->stall, mono_ns() - t0);
+        }
+
+        size_t len = bytes - off < chunk ? bytes - off : chunk;
+        if (fn(arg, off, len) != 0) return -1;
+        credits--;
+        st->chunks++;
+    }
+    st->responses++;
+    return 0;
+}
+
+void stream_srv_print(FILE *fp, const char *tag, const stream_srv_stats_t *st) {
+    fprintf(fp, "%s stream responses=%llu chunks=%llu credit_stalls=%llu\n",
+            tag, st->responses, st->chunks, st->credit_stalls);
+    if (st->credit_stalls) {
+        char label[128];
+        snprintf(label, sizeof(label), "%s stream credit_stall", tag);
+        lat_hist_print(fp, label, &st->stall);
+    }
+}
+
+/* ---------- client side ---------- */
+
+static int send_credit(int fd, unsigned n) {
+    unsigned char msg[8];
+    wire_put_be64(msg, ((uint64_t)STREAM_CREDIT_MAGIC << 48) | (uint64_t)n);
+    size_t sent = 0;
+    while (sent < sizeof(msg)) {
+        ssize_t w = send(fd, msg + sent, sizeof(msg) - sent, MSG_NOSIGNAL);
+        if (w < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) continue;
+            return -1;
+        }
+        sent += (size_t)w;
+    }
+    return 0;
+}
+
+int stream_recv(int fd, size_t bytes, size_t chunk, unsigned credits, char *buf, size_t buflen,
+                uint64_t t_send_ns, uint64_t deadline_ns, stream_stats_t *st) {
+    size_t nchunks = (bytes + chunk - 1) / chunk;
+    size_t granted = credits;
+    size_t got = 0, in_chunk = 0;
+    uint64_t last_done = 0, prev_gap = 0;
+    int have_gap = 0;
+
+    while (got < bytes) {
+        if (mono_ns() >= deadline_ns) return -2;
+
+        size_t want = chunk - in_chunk;
+        if (want > bytes - got) want = bytes - got;
+        if (want > buflen) want = buflen;
+
+        ssize_t r = recv(fd, buf, want, 0);
+        if (r == 0) return 0;
+        if (r < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) continue; // bounded by deadline
+            return -1;
+        }
+
+        uint64_t now = mono_ns();
+        if (got == 0) lat_hist_add(&st->ttfb, now - t_send_ns);
+        got += (size_t)r;
+        in_chunk += (size_t)r;
+        if (in_chunk < chunk && got < bytes) continue;
+
+        // one chunk complete: gap / jitter against the previous one, then hand back its credit
+        if (last_done) {
+            uint64_t gap = now - last_done;
+            lat_hist_add(&st->gap, gap);
+            if (have_gap) lat_hist_add(&st->jitter, gap > prev_gap ? gap - prev_gap : prev_gap - gap);
+            prev_gap = gap;
+            have_gap = 1;
+        }
+        last_done = now;
+        in_chunk = 0;
+
+        if (granted < nchunks) {
+            if (send_credit(fd, 1) != 0) return -1;
+            granted++;
+        }
+    }
+
+    lat_hist_add(&st->ttlb, last_done - t_send_ns);
+    return 1;
+}
+
+void stream_stats_merge(stream_stats_t *dst, const stream_stats_t *src) {
+    lat_hist_merge(&dst->ttfb, &src->ttfb);
+    lat_hist_merge(&dst->gap, &src->gap);
+    lat_hist_merge(&dst->jitter, &src->jitter);
+    lat_hist_merge(&dst->ttlb, &src->ttlb);
+}
+
+void stream_stats_print(FILE *fp, const char *tag, const stream_stats_t *st) {
+    static const char *names[] = { "ttfb", "chunk_gap", "chunk_jitter", "ttlb" };
+    const lat_hist_t *h[] = { &st->ttfb, &st->gap, &st->jitter, &st->ttlb };
+    char label[128];
+    for (int i = 0; i < 4; i++) {
+        snprintf(label, sizeof(label), "%s stream %s", tag, names[i]);
+        lat_hist_print(fp, label, h[i]);
+    }
+}
@@ -0,0 +1,75 @@
+/*
+ * MT25024 – streaming delivery of large responses with credit-based flow control.
+ *
+ * A streamed request is a tagged 8-byte trigger carrying the chunk size and an
+ * initial credit window. The server (started with --stream) sends the response
+ * in chunks, one credit per chunk, and blocks for credit messages from the client
+ * when the window is used up, so a slow reader bounds the data in flight to
+ * credits x chunk. The client returns one credit per chunk it has consumed, but
+ * never more than the response still needs, so no credit outlives its response.
+ *
+ *   request  = STREAM_REQ_MAGIC (16) | credits (16) | chunk bytes (32), big-endian
+ *   credit   = STREAM_CREDIT_MAGIC (16) | 0 (16) | credits (32), big-endian
+ *   response = msgSize bytes, unframed (both ends know msgSize and the chunk size)
+ */
+#ifndef MT25024_STREAM_H
+#define MT25024_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "MT25024_Stats.h"
+
+#define STREAM_REQ_MAGIC    0x5354u   /* "ST" */
+#define STREAM_CREDIT_MAGIC 0x4352u   /* "CR" */
+#define STREAM_DEFAULT_CREDITS 4
+
+/* 1 and fills chunk/credits for a stream request, 0 for any other trigger */
+int stream_req_decode(const void *trig, size_t *chunk, unsigned *credits);
+void stream_req_encode(void *trig, size_t chunk, unsigned credits);
+
+/* ---------- server side ---------- */
+
+/* sends bytes [off, off + len) of the current response; 0 on success */
+typedef int (*stream_send_fn)(void *arg, size_t off, size_t len);
+
+typedef struct {
+    unsigned long long responses;
+    unsigned long long chunks;
+    unsigned long long credit_stalls;   // times the window was empty and the server waited
+    lat_hist_t stall;                   // how long each of those waits took
+} stream_srv_stats_t;
+
+/*
+ * send one 'bytes' response through fn in 'chunk' pieces, spending one credit per
+ * piece and reading credit messages from fd whenever none are left.
+ * Returns 0, or -1 on a send/recv error, a closed peer or a malformed credit.
+ */
+int stream_send(int fd, size_t bytes, size_t chunk, unsigned credits,
+                stream_send_fn fn, void *arg, stream_srv_stats_t *st);
+
+void stream_srv_print(FILE *fp, const char *tag, const stream_srv_stats_t *st);
+
+/* ---------- client side ---------- */
+
+typedef struct {
+    lat_hist_t ttfb;    // request sent      -> first response byte
+    lat_hist_t gap;     // chunk i-1 complete -> chunk i complete
+    lat_hist_t jitter;  // |gap_i - gap_i-1|
+    lat_hist_t ttlb;    // request sent      -> last response byte
+} stream_stats_t;
+
+/*
+ * receive one streamed response of 'bytes' bytes and hand back a credit for every
+ * chunk consumed. Data lands in buf (any size; it is overwritten as chunks arrive).
+ * t_send_ns is when the request went out; gives up at deadline_ns (CLOCK_MONOTONIC).
+ * Returns 1 complete, 0 peer closed, -2 deadline reached, -1 error.
+ */
+int stream_recv(int fd, size_t bytes, size_t chunk, unsigned credits, char *buf, size_t buflen,
+                uint64_t t_send_ns, uint64_t deadline_ns, stream_stats_t *st);
+
+void stream_stats_merge(stream_stats_t *dst, const stream_stats_t *src);
+void stream_stats_print(FILE *fp, const char *tag, const stream_stats_t *st);
+
+#endif
@@ -0,0 +1,141 @@
+#include "MT25024_TcpInfo.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <linux/tcp.h>     // struct tcp_info with delivery_rate / busy / limited times
+#include <netinet/in.h>    // IPPROTO_TCP
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void mm_add(mm_stat_t *s, double v) {
+    if (s->n == 0 || v < s->min) s->min = v;
+    if (s->n == 0 || v > s->max) s->max = v;
+    s->sum += v;
+    s->n++;
+}
+
+static void mm_merge(mm_stat_t *d, const mm_stat_t *s) {
+    if (s->n == 0) return;
+    if (d->n == 0 || s->min < d->min) d->min = s->min;
+    if (d->n == 0 || s->max > d->max) d->max = s->max;
+    d->sum += s->sum;
+    d->n += s->n;
+}
+
+void tcpinfo_init(tcpinfo_stats_t *t, unsigned interval_ms) {
+    memset(t, 0, sizeof(*t));
+    t->interval_ns = (uint64_t)interval_ms * 1000000ULL;
+}
+
+void tcpinfo_sample(tcpinfo_stats_t *t, int fd) {
+    if (t->interval_ns == 0) return;
+
+    struct tcp_info ti;
+    socklen_t len = sizeof(ti);
+    memset(&ti, 0, sizeof(ti));
+    if (getsockopt(fd, IPPROTO_TCP, TCP_INFO, &ti, &len) != 0) return;
+
+    uint64_t now = now_ns();
+    t->samples++;
+
+    mm_add(&t->rtt_us, (double)ti.tcpi_rtt);
+    mm_add(&t->cwnd, (double)ti.tcpi_snd_cwnd);
+    mm_add(&t->inflight_bytes, (double)ti.tcpi_unacked * (double)ti.tcpi_snd_mss);
+
+    // older kernels return a shorter struct; only use fields that were filled in
+    int has_notsent  = len >= offsetof(struct tcp_info, tcpi_notsent_bytes) + sizeof(ti.tcpi_notsent_bytes);
+    int has_delivery = len >= offsetof(struct tcp_info, tcpi_delivery_rate) + sizeof(ti.tcpi_delivery_rate);
+    int has_chrono   = len >= offsetof(struct tcp_info, tcpi_sndbuf_limited) + sizeof(ti.tcpi_sndbuf_limited);
+
+    if (has_notsent) mm_add(&t->notsent_bytes, (double)ti.tcpi_notsent_bytes);
+    if (has_delivery) mm_add(&t->delivery_mbps, (double)ti.tcpi_delivery_rate * 8.0 / 1e6);
+
+    if (t->have_prev) {
+        double dt_us = (double)(now - t->prev_ns) / 1e3;
+        mm_add(&t->retrans, (double)(ti.tcpi_total_retrans - t->prev_retrans));
+        if (has_chrono && dt_us > 0) {
+            mm_add(&t->busy_pct,       100.0 * (double)(ti.tcpi_busy_time - t->prev_busy) / dt_us);
+            mm_add(&t->rwnd_lim_pct,   100.0 * (double)(ti.tcpi_rwnd_limited - t->prev_rwnd) / dt_us);
+            mm_add(&t->sndbuf_lim_pct, 100.0 * (double)(ti.tcpi_sndbuf_limited - t->prev_sndbuf) / dt_us);
+        }
+    }
+
+    t->have_prev = 1;
+    t->prev_ns = now;
+    t->prev_retrans = ti.tcpi_total_retrans;
+    if (has_chrono) {
+        t->prev_busy = ti.tcpi_busy_time;
+        t->prev_rwnd = ti.tcpi_rwnd_limited;
+        t->prev_sndbuf = ti.tcpi_sndbuf_limited;
+    }
+    t->next_ns = now + t->interval_ns;
+}
+
+void tcpinfo_maybe_sample(tcpinfo_stats_t *t, int fd) {
+    if (t->interval_ns == 0) return;
+    if (now_ns() < t->next_ns) return;
+    tcpinfo_sample(t, fd);
+}
+
+void tcpinfo_merge(tcpinfo_stats_t *dst, const tcpinfo_stats_t *src) {
+    if (dst->interval_ns == 0) dst->interval_ns = src->interval_ns;
+    dst->samples += src->samples;
+    mm_merge(&dst->rtt_us, &src->rtt_us);
+    mm_merge(&dst->cwnd, &src->cwnd);
+    mm_merge(&dst->delivery_mbps, &src->delivery_mbps);
+    mm_merge(&dst->inflight_bytes, &src->inflight_bytes);
+    mm_merge(&dst->notsent_bytes, &src->notsent_bytes);
+    mm_merge(&dst->retrans, &src->retrans);
+    mm_merge(&dst->busy_pct, &src->busy_pct);
+    mm_merge(&dst->rwnd_lim_pct, &src->rwnd_lim_pct);
+    mm_merge(&dst->sndbuf_lim_pct, &src->sndbuf_lim_pct);
+}
+
+static size_t fmt_mm(char *buf, size_t len, const char *name, const mm_stat_t *s) {
+    double avg = s->n ? s->sum / (double)s->n : 0.0;
+    int n = snprintf(buf, len, " tcp_%s_min=%.2f tcp_%s_avg=%.2f tcp_%s_max=%.2f",
+                     name, s->n ? s->min : 0.0, name, avg, name, s->n ? s->max : 0.0);
+    return (n < 0) ? 0 : ((size_t)n >= len ? len - 1 : (size_t)n);
+}
+
+char *tcpinfo_format(char *buf, size_t len, const tcpinfo_stats_t *t) {
+    size_t off = 0;
+    buf[0] = '\0';
+    int n = snprintf(buf, len, " tcp_samples=%llu", t->samples);
+    if (n > 0) off = ((size_t)n >= len) ? len - 1 : (size_t)n;
+
+    off += fmt_mm(buf + off, len - off, "rtt_us", &t->rtt_us);
+    off += fmt_mm(buf + off, len - off, "cwnd", &t->cwnd);
+    off += fmt_mm(buf + off, len - off, "retrans", &t->retrans);
+    off += fmt_mm(buf + off, len - off, "delivery_mbps", &t->delivery_mbps);
+    off += fmt_mm(buf + off, len - off, "busy_pct", &t->busy_pct);
+    off += fmt_mm(buf + off, len - off, "rwnd_limited_pct", &t->rwnd_lim_pct);
+    off += fmt_mm(buf + off, len - off, "sndbuf_limited_pct", &t->sndbuf_lim_pct);
+    off += fmt_mm(buf + off, len - off, "inflight_bytes", &t->inflight_bytes);
+    fmt_mm(buf + off, len - off, "notsent_bytes", &t->notsent_bytes);
+    return buf;
+}
+
+int tcpinfo_parse_opt(const char *arg) {
+    if (strcmp(arg, "--tcpinfo") == 0) return TCPINFO_DEFAULT_MS;
+    if (strncmp(arg, "--tcpinfo=", 10) == 0) {
+        char *end;
+        errno = 0;
+        long ms = strtol(arg + 10, &end, 10);
+        if (end == arg + 10 || *end != '\0' || errno || ms < 0 || ms > INT_MAX) {
+            fprintf(stderr, "--tcpinfo: bad interval '%s' (ms >= 0, 0 = off)\n", arg + 10);
+            return -2;
+        }
+        return (int)ms;
+    }
+    return -1;
+}
@@ -0,0 +1,70 @@
+/*
+ * MT25024 – periodic getsockopt(TCP_INFO) sampling per connection.
+ * Lets a throughput drop or an RTT spike be attributed to TCP (cwnd, retransmits,
+ * rwnd / sndbuf limits) rather than to the application.
+ *
+ * Lives in its own translation unit because <linux/tcp.h> (needed for the newer
+ * tcp_info fields) clashes with the <netinet/tcp.h> the Part A sources include.
+ */
+#ifndef MT25024_TCPINFO_H
+#define MT25024_TCPINFO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TCPINFO_DEFAULT_MS 100
+
+/* min / avg / max accumulator */
+typedef struct {
+    double min;
+    double max;
+    double sum;
+    unsigned long long n;
+} mm_stat_t;
+
+typedef struct {
+    uint64_t interval_ns;   // 0 = sampling disabled
+    uint64_t next_ns;
+    unsigned long long samples;
+
+    // gauges (value at sample time)
+    mm_stat_t rtt_us;
+    mm_stat_t cwnd;           // segments
+    mm_stat_t delivery_mbps;  // tcpi_delivery_rate, Mbit/s
+    mm_stat_t inflight_bytes; // tcpi_unacked * tcpi_snd_mss
+    mm_stat_t notsent_bytes;
+
+    // cumulative kernel counters, reported as per-interval deltas
+    mm_stat_t retrans;        // segments retransmitted in the interval
+    mm_stat_t busy_pct;       // % of the interval busy sending
+    mm_stat_t rwnd_lim_pct;   // % of the interval limited by receive window
+    mm_stat_t sndbuf_lim_pct; // % of the interval limited by send buffer
+
+    // previous cumulative values
+    int have_prev;
+    uint64_t prev_ns;
+    uint32_t prev_retrans;
+    uint64_t prev_busy, prev_rwnd, prev_sndbuf;
+} tcpinfo_stats_t;
+
+/* interval_ms == 0 disables sampling (all calls become no-ops) */
+void tcpinfo_init(tcpinfo_stats_t *t, unsigned interval_ms);
+
+/* cheap: reads the clock and samples only when the interval has elapsed */
+void tcpinfo_maybe_sample(tcpinfo_stats_t *t, int fd);
+
+/* unconditional sample (e.g. once more right before close) */
+void tcpinfo_sample(tcpinfo_stats_t *t, int fd);
+
+void tcpinfo_merge(tcpinfo_stats_t *dst, const tcpinfo_stats_t *src);
+
+/* appends " tcp_<name>_{min,avg,max}=..." key=value pairs; returns buf */
+char *tcpinfo_format(char *buf, size_t len, const tcpinfo_stats_t *t);
+
+/*
+ * parse "--tcpinfo" / "--tcpinfo=MS"; returns the interval in ms (0 = off), -1 if arg
+ * does not match, or -2 (after a message) for a negative or non-numeric MS
+ */
+int tcpinfo_parse_opt(const char *arg);
+
+#endif
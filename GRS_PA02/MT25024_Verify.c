@@ -0,0 +1,204 @@
+#include "MT25024_Verify.h"
+
+#include <pthread.h>
+#include <string.h>
+
+#include "MT25024_Proto.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#define CRC32C_HAVE_SSE42 1
+#endif
+
+#define CRC32C_POLY 0x82f63b78u   /* reflected Castagnoli polynomial */
+#define CRC_LANE    4096          /* bytes per lane in the interleaved SSE4.2 loop */
+
+static uint32_t g_slice[8][256];   // slicing-by-8 tables
+static uint32_t g_shift[4][256];   // register -> register after CRC_LANE zero bytes, per input byte
+static uint32_t (*g_update)(uint32_t, const unsigned char*, size_t);
+static const char *g_impl;
+static pthread_once_t g_once = PTHREAD_ONCE_INIT;
+
+/* raw register update (no pre/post inversion) */
+static uint32_t update_slice8(uint32_t r, const unsigned char *p, size_t len) {
+    while (len && ((uintptr_t)p & 7)) {
+        r = g_slice[0][(r ^ *p++) & 0xff] ^ (r >> 8);
+        len--;
+    }
+    while (len >= 8) {
+        uint32_t lo, hi;
+        memcpy(&lo, p, 4);
+        memcpy(&hi, p + 4, 4);
+        lo ^= r;   // little-endian hosts only, as is everything else in PA02
+        r = g_slice[7][lo & 0xff] ^ g_slice[6][(lo >> 8) & 0xff] ^
+            g_slice[5][(lo >> 16) & 0xff] ^ g_slice[4][lo >> 24] ^
+            g_slice[3][hi & 0xff] ^ g_slice[2][(hi >> 8) & 0xff] ^
+            g_slice[1][(hi >> 16) & 0xff] ^ g_slice[0][hi >> 24];
+        p += 8;
+        len -= 8;
+    }
+    while (len--) r = g_slice[0][(r ^ *p++) & 0xff] ^ (r >> 8);
+    return r;
+}
+
+static uint32_t shift_lane(uint32_t r) {
+    return g_shift[0][r & 0xff] ^ g_shift[1][(r >> 8) & 0xff] ^
+           g_shift[2][(r >> 16) & 0xff] ^ g_shift[3][r >> 24];
+}
+
+#ifdef CRC32C_HAVE_SSE42
+/*
+ * crc32 has a 3-cycle latency but 1-cycle throughput, so three independent lanes
+ * of CRC_LANE bytes run at once. The register update is linear, so the lanes are
+ * joined with  crc(A|B) = shift(crc(A), |B|) ^ crc_from_zero(B).
+ */
+__attribute__((target("sse4.2")))
+static uint32_t update_sse42(uint32_t r, const unsigned char *p, size_t len) {
+    while (len && ((uintptr_t)p & 7)) {
+        r = _mm_crc32_u8(r, *p++);
+        len--;
+    }
+    while (len >= 3 * CRC_LANE) {
+        uint64_t a = r, b = 0, c = 0;
+        for (size_t i = 0; i < CRC_LANE; i += 8) {
+            uint64_t va, vb, vc;
+            memcpy(&va, p + i, 8);
+            memcpy(&vb, p + CRC_LANE + i, 8);
+            memcpy(&vc, p + 2 * CRC_LANE + i, 8);
+            a = _mm_crc32_u64(a, va);
+            b = _mm_crc32_u64(b, vb);
+            c = _mm_crc32_u64(c, vc);
+        }
+        r = shift_lane((uint32_t)a) ^ (uint32_t)b;
+        r = shift_lane(r) ^ (uint32_t)c;
+        p += 3 * CRC_LANE;
+        len -= 3 * CRC_LANE;
+    }
+    uint64_t r64 = r;
+    while (len >= 8) {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        r64 = _mm_crc32_u64(r64, v);
+        p += 8;
+        len -= 8;
+    }
+    r = (uint32_t)r64;
+    while (len--) r = _mm_crc32_u8(r, *p++);
+    return r;
+}
+#endif
+
+static void crc32c_init(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) c = (c & 1) ? (c >> 1) ^ CRC32C_POLY : c >> 1;
+        g_slice[0][i] = c;
+    }
+    for (uint32_t i = 0; i < 256; i++)
+        for (int t = 1; t < 8; t++)
+            g_slice[t][i] = g_slice[0][g_slice[t - 1][i] & 0xff] ^ (g_slice[t - 1][i] >> 8);
+
+    // shift is linear: run each of the 32 register bits through CRC_LANE zero bytes once,
+    // then every table entry is the XOR of the bits it contains
+    uint32_t bit[32];
+    for (int b = 0; b < 32; b++) {
+        uint32_t r = 1u << b;
+        for (size_t n = 0; n < CRC_LANE; n++) r = g_slice[0][r & 0xff] ^ (r >> 8);
+        bit[b] = r;
+    }
+    for (int k = 0; k < 4; k++) {
+        for (uint32_t v = 0; v < 256; v++) {
+            uint32_t s = 0;
+            for (int b = 0; b < 8; b++)
+                if (v & (1u << b)) s ^= bit[8 * k + b];
+            g_shift[k][v] = s;
+        }
+    }
+
+    g_update = update_slice8;
+    g_impl = "slice8";
+#ifdef CRC32C_HAVE_SSE42
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2")) {
+        g_update = update_sse42;
+        g_impl = "sse4.2";
+    }
+#endif
+}
+
+uint32_t crc32c(uint32_t crc, const void *buf, size_t len) {
+    pthread_once(&g_once, crc32c_init);
+    return ~g_update(~crc, (const unsigned char*)buf, len);
+}
+
+const char *crc32c_impl(void) {
+    pthread_once(&g_once, crc32c_init);
+    return g_impl;
+}
+
+void verify_put_seq(char *const field[8], const size_t flen[8], uint64_t seq) {
+    unsigned char b[VERIFY_SEQ_LEN];
+    wire_put_be64(b, seq);
+    size_t k = 0;
+    for (int i = 0; i < 8 && k < sizeof(b); i++)
+        for (size_t j = 0; j < flen[i] && k < sizeof(b); j++) field[i][j] = (char)b[k++];
+}
+
+static uint64_t get_seq(char *const field[8], const size_t flen[8]) {
+    unsigned char b[VERIFY_SEQ_LEN];
+    size_t k = 0;
+    for (int i = 0; i < 8 && k < sizeof(b); i++)
+        for (size_t j = 0; j < flen[i] && k < sizeof(b); j++) b[k++] = (unsigned char)field[i][j];
+    return wire_get_be64(b);
+}
+
+uint32_t verify_crc_fields(char *const field[8], const size_t flen[8]) {
+    uint32_t crc = 0;
+    for (int i = 0; i < 8; i++) crc = crc32c(crc, field[i], flen[i]);
+    return crc;
+}
+
+void verify_trailer_encode(unsigned char trailer[VERIFY_TRAILER_LEN], uint32_t crc) {
+    wire_put_be64(trailer, ((uint64_t)VERIFY_MAGIC << 32) | crc);
+}
+
+int verify_check(char *const field[8], const size_t flen[8], const unsigned char trailer[VERIFY_TRAILER_LEN],
+                 uint64_t *expect_seq, verify_stats_t *st) {
+    uint64_t t0 = mono_ns();
+    uint64_t tr = wire_get_be64(trailer);
+    uint64_t seq = get_seq(field, flen);
+    int bad = 0;
+
+    if ((tr >> 32) != VERIFY_MAGIC || (uint32_t)tr != verify_crc_fields(field, flen)) {
+        st->crc_errors++;
+        bad = 1;
+    }
+    if (seq != *expect_seq) {
+        st->seq_errors++;
+        bad = 1;
+    }
+    *expect_seq = seq + 1;   // resync after a gap so one loss is not counted forever
+
+    st->msgs++;
+    for (int i = 0; i < 8; i++) st->bytes += flen[i];
+    st->verify_ns += mono_ns() - t0;
+    return bad ? -1 : 0;
+}
+
+void verify_stats_merge(verify_stats_t *dst, const verify_stats_t *src) {
+    dst->msgs += src->msgs;
+    dst->bytes += src->bytes;
+    dst->seq_errors += src->seq_errors;
+    dst->crc_errors += src->crc_errors;
+    dst->verify_ns += src->verify_ns;
+    dst->loop_ns += src->loop_ns;
+}
+
+void verify_stats_print(FILE *fp, const char *tag, const verify_stats_t *st) {
+    double secs = (double)st->verify_ns / 1e9;
+    double rate = secs > 0 ? (double)st->bytes / secs / 1e9 : 0.0;
+    double pct = st->loop_ns ? 100.0 * (double)st->verify_ns / (double)st->loop_ns : 0.0;
+    fprintf(fp, "%s verify crc=%s msgs=%llu seq_errors=%llu crc_errors=%llu "
+                "crc_rate=%.2f GB/s overhead=%.2f%%\n",
+            tag, crc32c_impl(), st->msgs, st->seq_errors, st->crc_errors, rate, pct);
+}
@@ -0,0 +1,61 @@
+/*
+ * MT25024 – verified-payload mode (--verify) and CRC32C.
+ *
+ * The server stamps every response with a per-connection sequence number and a
+ * CRC32C of the payload, and the client checks both. The sequence number is
+ * written into the first VERIFY_SEQ_LEN payload bytes themselves (into the A3 slot
+ * that is about to be sent), so a buffer reused while the kernel still references
+ * it shows up as a CRC or sequence error instead of silently passing.
+ *
+ *   response = payload (msgSize bytes, starting with seq as big-endian u64) | trailer
+ *   trailer  = VERIFY_MAGIC (u32) | CRC32C of the payload (u32), big-endian
+ *
+ * crc32c() picks the SSE4.2 crc32 instruction at run time when the CPU has it
+ * (three interleaved lanes to hide its latency), else a slicing-by-8 table.
+ */
+#ifndef MT25024_VERIFY_H
+#define MT25024_VERIFY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define VERIFY_MAGIC       0x56524659u   /* "VRFY" */
+#define VERIFY_SEQ_LEN     8
+#define VERIFY_TRAILER_LEN 8
+
+/* CRC32C (Castagnoli, iSCSI): crc32c(0, "123456789", 9) == 0xe3069283; chainable */
+uint32_t crc32c(uint32_t crc, const void *buf, size_t len);
+
+/* "sse4.2" or "slice8" */
+const char *crc32c_impl(void);
+
+/* write seq into the first VERIFY_SEQ_LEN bytes of the 8 fields (they may be shorter than 8 bytes) */
+void verify_put_seq(char *const field[8], const size_t flen[8], uint64_t seq);
+
+/* CRC32C over the 8 fields in order */
+uint32_t verify_crc_fields(char *const field[8], const size_t flen[8]);
+
+void verify_trailer_encode(unsigned char trailer[VERIFY_TRAILER_LEN], uint32_t crc);
+
+typedef struct {
+    unsigned long long msgs;
+    unsigned long long bytes;
+    unsigned long long seq_errors;
+    unsigned long long crc_errors;   // includes a missing / malformed trailer
+    unsigned long long verify_ns;    // time spent stamping (server) or checking (client)
+    unsigned long long loop_ns;      // time of the whole send / receive loop, for the overhead %
+} verify_stats_t;
+
+/*
+ * client side: check one response whose payload is in the 8 fields (A1: one field
+ * holding everything, the rest empty) and whose trailer follows it; counts into st
+ * and advances *expect_seq. Returns 0 if the response is intact.
+ */
+int verify_check(char *const field[8], const size_t flen[8], const unsigned char trailer[VERIFY_TRAILER_LEN],
+                 uint64_t *expect_seq, verify_stats_t *st);
+
+void verify_stats_merge(verify_stats_t *dst, const verify_stats_t *src);
+void verify_stats_print(FILE *fp, const char *tag, const verify_stats_t *st);
+
+#endif
@@ -0,0 +1,315 @@
+#!/usr/bin/env python3
+"""
+MT25024 benchmark result store + regression check (PA01 and PA02)
+
+The Part C / Part D scripts overwrite their CSV on every run, so this tool keeps
+an append-only copy of every measurement, keyed by git revision, host and the
+run parameters, and compares two revisions afterwards.
+
+Store format (long form, one metric per line, never rewritten):
+    timestamp,rev,host,suite,params,metric,value
+
+Usage:
+    MT25024_Result_Store.py record  --csv GRS_PA02/MT25024_Part_C_CSV.csv [--output PATH ...]
+    MT25024_Result_Store.py list
+    MT25024_Result_Store.py compare --base <rev> --head <rev> [--suite S] [--host H | --pool-hosts]
+
+'compare' runs Welch's t-test per (suite, host, params, metric), so base and head are
+only compared on the same machine (--pool-hosts mixes hosts), and flags a regression
+when the change goes in the bad direction, p < alpha and the relative change is
+at least --min-change. With a single sample on either side no test is possible;
+those rows are only flagged when the change exceeds --single-threshold.
+Exit status is 1 when any regression is flagged, so scripts can gate on it.
+
+'record' marks the revision "-dirty" only for tracked changes outside the recorded
+CSV and any --output paths, since the scripts rewrite their tracked CSV first.
+"""
+
+import argparse
+import csv
+import math
+import socket
+import subprocess
+import sys
+import time
+from collections import defaultdict
+from pathlib import Path
+
+DEFAULT_STORE = Path(__file__).resolve().parent / "MT25024_Results_Store.csv"
+STORE_HEADER = ["timestamp", "rev", "host", "suite", "params", "metric", "value"]
+
+# =========================
+# Suite definitions
+# =========================
+# params:  columns that identify one configuration
+# metrics: column -> +1 if higher is better, -1 if lower is better
+SUITES = {
+    "pa02-partc": {
+        "params": ["part", "variant", "msg_size", "threads", "duration_sec"],
+        "metrics": {
+            "agg_throughput_gbps": +1,
+            "avg_rtt_us": -1,
+            "max_rtt_us": -1,
+            "server_cycles_per_byte": -1,   # derived below
+            "server_peak_rss_kb": -1,       # VmHWM of the server process
+            "server_tcp_rtt_us_avg": -1,    # only with TCPINFO_MS > 0
+            "server_tcp_retrans_max": -1,
+        },
+    },
+    "pa01-partc": {
+        "params": ["Program+Function"],
+        "metrics": {
+            "Time_real(s)": -1,
+            "Mem(KB)": -1,
+        },
+    },
+    "pa01-partd": {
+        "params": ["Program", "Workload", "Count"],
+        "metrics": {
+            "Time_real(s)": -1,
+            "Mem(KB)": -1,
+        },
+    },
+}
+
+
+def detect_suite(fieldnames):
+    cols = set(fieldnames or [])
+    for name, spec in SUITES.items():
+        if set(spec["params"]) <= cols:
+            return name
+    raise ValueError(f"cannot detect suite from CSV columns: {sorted(cols)}")
+
+
+def derive(suite, row):
+    """Add derived metrics that are not CSV columns."""
+    if suite == "pa02-partc":
+        try:
+            rx = float(row["total_rx_bytes"])
+            cyc = float(row["server_cycles"])
+            row["server_cycles_per_byte"] = f"{cyc / rx:.6f}" if rx > 0 else ""
+        except (KeyError, ValueError):
+            row["server_cycles_per_byte"] = ""
+    return row
+
+
+def git_rev(cwd, outputs=()):
+    """Short HEAD, plus "-dirty" when tracked files other than the run's outputs changed.
+
+    The Part C/D scripts rewrite their tracked CSV before recording it, so the
+    outputs are left out of the dirty check (":(exclude)" pathspecs).
+    """
+    try:
+        rev = subprocess.run(["git", "rev-parse", "--short", "HEAD"], cwd=cwd,
+                             capture_output=True, text=True, check=True).stdout.strip()
+        spec = [":/"] + [f":(exclude){Path(p).resolve()}" for p in outputs]
+        dirty = subprocess.run(["git", "status", "--porcelain", "--untracked-files=no", "--"] + spec,
+                               cwd=cwd, capture_output=True, text=True).stdout.strip()
+        return rev + ("-dirty" if dirty else "")
+    except (OSError, subprocess.CalledProcessError):
+        return "unknown"
+
+
+# =========================
+# Statistics (no scipy needed)
+# =========================
+def _betacf(a, b, x):
+    """Continued fraction for the incomplete beta function (Numerical Recipes)."""
+    MAXIT, EPS, FPMIN = 200, 3e-14, 1e-300
+    qab, qap, qam = a + b, a + 1.0, a - 1.0
+    c, d = 1.0, 1.0 - qab * x / qap
+    d = 1.0 / (d if abs(d) > FPMIN else FPMIN)
+    h = d
+    for m in range(1, MAXIT + 1):
+        m2 = 2 * m
+        aa = m * (b - m) * x / ((qam + m2) * (a + m2))
+        d = 1.0 + aa * d
+        d = 1.0 / (d if abs(d) > FPMIN else FPMIN)
+        c = 1.0 + aa / c
+        c = c if abs(c) > FPMIN else FPMIN
+        h *= d * c
+        aa = -(a + m) * (qab + m) * x / ((a + m2) * (qap + m2))
+        d = 1.0 + aa * d
+        d = 1.0 / (d if abs(d) > FPMIN else FPMIN)
+        c = 1.0 + aa / c
+        c = c if abs(c) > FPMIN else FPMIN
+        delta = d * c
+        h *= delta
+        if abs(delta - 1.0) < EPS:
+            break
+    return h
+
+
+def _betai(a, b, x):
+    if x <= 0.0:
+        return 0.0
+    if x >= 1.0:
+        return 1.0
+    lbt = math.lgamma(a + b) - math.lgamma(a) - math.lgamma(b) + a * math.log(x) + b * math.log(1.0 - x)
+    bt = math.exp(lbt)
+    if x < (a + 1.0) / (a + b + 2.0):
+        return bt * _betacf(a, b, x) / a
+    return 1.0 - bt * _betacf(b, a, 1.0 - x) / b
+
+
+def welch_p(xs, ys):
+    """Two-sided p-value of Welch's t-test; None if it cannot be computed."""
+    n1, n2 = len(xs), len(ys)
+    if n1 < 2 or n2 < 2:
+        return None
+    m1, m2 = sum(xs) / n1, sum(ys) / n2
+    v1 = sum((x - m1) ** 2 for x in xs) / (n1 - 1)
+    v2 = sum((y - m2) ** 2 for y in ys) / (n2 - 1)
+    se2 = v1 / n1 + v2 / n2
+    if se2 == 0.0:
+        return 0.0 if m1 != m2 else 1.0
+    t = (m2 - m1) / math.sqrt(se2)
+    df = se2 ** 2 / ((v1 / n1) ** 2 / (n1 - 1) + (v2 / n2) ** 2 / (n2 - 1))
+    return _betai(df / 2.0, 0.5, df / (df + t * t))
+
+
+# =========================
+# Store I/O
+# =========================
+def load_store(path):
+    rows = []
+    if not path.exists():
+        return rows
+    with path.open(newline="") as f:
+        for r in csv.DictReader(f):
+            try:
+                r["value"] = float(r["value"])
+            except ValueError:
+                continue
+            rows.append(r)
+    return rows
+
+
+def cmd_record(args):
+    src = Path(args.csv)
+    if not src.exists():
+        sys.exit(f"CSV not found: {src.resolve()}")
+
+    rev = args.rev or git_rev(src.resolve().parent, [src] + args.output)
+    host = args.host or socket.gethostname()
+    ts = time.strftime("%Y-%m-%dT%H:%M:%S")
+
+    with src.open(newline="") as f:
+        r = csv.DictReader(f)
+        suite = args.suite or detect_suite(r.fieldnames)
+        spec = SUITES[suite]
+        out = []
+        for row in r:
+            row = derive(suite, row)
+            params = ";".join(f"{p}={row[p].strip()}" for p in spec["params"])
+            for metric in spec["metrics"]:
+                v = (row.get(metric) or "").strip()
+                if v == "":
+                    continue
+                out.append([ts, rev, host, suite, params, metric, v])
+
+    store = Path(args.store)
+    new = not store.exists()
+    with store.open("a", newline="") as f:
+        w = csv.writer(f)
+        if new:
+            w.writerow(STORE_HEADER)
+        w.writerows(out)
+
+    print(f"Recorded {len(out)} values ({suite}, rev={rev}, host={host}) into {store}")
+
+
+def cmd_list(args):
+    counts = defaultdict(int)
+    first = {}
+    for r in load_store(Path(args.store)):
+        key = (r["rev"], r["host"], r["suite"])
+        counts[key] += 1
+        first.setdefault(key, r["timestamp"])
+    print(f"{'rev':<18} {'host':<20} {'suite':<12} {'values':>7}  first_seen")
+    for key in sorted(counts, key=lambda k: first[k]):
+        print(f"{key[0]:<18} {key[1]:<20} {key[2]:<12} {counts[key]:>7}  {first[key]}")
+
+
+def cmd_compare(args):
+    data = defaultdict(lambda: {"base": [], "head": []})
+    for r in load_store(Path(args.store)):
+        if args.suite and r["suite"] != args.suite:
+            continue
+        if args.host and r["host"] != args.host:
+            continue
+        side = "base" if r["rev"] == args.base else "head" if r["rev"] == args.head else None
+        if side:
+            host = "*" if args.pool_hosts else r["host"]
+            data[(r["suite"], host, r["params"], r["metric"])][side].append(r["value"])
+
+    regressions = 0
+    compared = 0
+    print(f"{'suite':<11} {'metric':<22} {'base':>12} {'head':>12} {'change':>8} {'p':>7}  {'verdict':<12} {'host':<20} params")
+    for (suite, host, params, metric), s in sorted(data.items()):
+        b, h = s["base"], s["head"]
+        if not b or not h:
+            continue
+        compared += 1
+        mb, mh = sum(b) / len(b), sum(h) / len(h)
+        rel = (mh - mb) / mb if mb != 0 else 0.0
+        worse = rel * SUITES[suite]["metrics"].get(metric, 0) < 0
+        p = welch_p(b, h)
+
+        if p is None:
+            bad = worse and abs(rel) >= args.single_threshold
+            verdict = "REGRESSION?" if bad else "n<2"
+        else:
+            bad = worse and p < args.alpha and abs(rel) >= args.min_change
+            verdict = "REGRESSION" if bad else ("improved" if (not worse and p < args.alpha and abs(rel) >= args.min_change) else "ok")
+        regressions += bad
+
+        ptxt = "-" if p is None else f"{p:.4f}"
+        print(f"{suite:<11} {metric[:22]:<22} {mb:>12.3f} {mh:>12.3f} {rel * 100:>7.1f}% {ptxt:>7}  {verdict:<12} {host:<20} {params}")
+
+    if compared == 0:
+        hint = "" if args.pool_hosts else " on the same host (--pool-hosts compares across hosts)"
+        sys.exit(f"No overlapping configurations between {args.base} and {args.head}{hint}")
+
+    print(f"\n{compared} comparisons, {regressions} regression(s) flagged "
+          f"(alpha={args.alpha}, min change={args.min_change * 100:.0f}%)")
+    return 1 if regressions else 0
+
+
+def main():
+    ap = argparse.ArgumentParser(description="MT25024 benchmark result store")
+    ap.add_argument("--store", default=str(DEFAULT_STORE), help="append-only store CSV")
+    sub = ap.add_subparsers(dest="cmd", required=True)
+
+    rec = sub.add_parser("record", help="append a Part C/D CSV to the store")
+    rec.add_argument("--csv", required=True)
+    rec.add_argument("--suite", choices=sorted(SUITES))
+    rec.add_argument("--rev", help="override git revision")
+    rec.add_argument("--output", action="append", default=[], metavar="PATH",
+                     help="another file the run writes; ignored by the -dirty check (repeatable)")
+    rec.add_argument("--host", help="override host name")
+
+    sub.add_parser("list", help="show stored revisions")
+
+    cmp_ = sub.add_parser("compare", help="flag regressions between two revisions")
+    cmp_.add_argument("--base", required=True)
+    cmp_.add_argument("--head", required=True)
+    cmp_.add_argument("--suite", choices=sorted(SUITES))
+    hosts = cmp_.add_mutually_exclusive_group()
+    hosts.add_argument("--host", help="only this host")
+    hosts.add_argument("--pool-hosts", action="store_true", help="pool samples from all hosts")
+    cmp_.add_argument("--alpha", type=float, default=0.05)
+    cmp_.add_argument("--min-change", type=float, default=0.02)
+    cmp_.add_argument("--single-threshold", type=float, default=0.10)
+
+    args = ap.parse_args()
+    if args.cmd == "record":
+        cmd_record(args)
+    elif args.cmd == "list":
+        cmd_list(args)
+    else:
+        sys.exit(cmd_compare(args))
+
+
+if __name__ == "__main__":
+    main()